@@ -0,0 +1,126 @@
+#include <iostream>
+#include <memory>
+#include <cmath>
+
+#include <Windows.h>
+
+#include "aot_runtime.hpp"
+#include "scalar_operations.hpp"
+#include "exception_handler.hpp"
+
+using namespace aot;
+using namespace vm;
+
+unsigned int aot::row = 0;
+unsigned int aot::col = 0;
+
+static dim_eval_func_t evaluate_access_vector_ptr = [](const std::vector<std::shared_ptr<ASTExprNode>>&) {
+	return std::vector<unsigned int>();
+	};
+
+// native variables cannot hold null
+static DynamicValue native_store(const DynamicValue& value, Type type) {
+	if (is_void(value.type)) {
+		ExceptionHandler::throw_mismatched_type_err(TypeDefinition(type), TypeDefinition(value.type), evaluate_access_vector_ptr);
+	}
+	return ScalarOperations::store(value, type);
+}
+
+flx_float aot::remainder(flx_float lval, flx_float rval) {
+	return RuntimeOperations::do_operation(lval, rval, "%");
+}
+
+flx_int aot::floor_divide(flx_int lval, flx_int rval) {
+	return RuntimeOperations::do_operation(lval, rval, "/%");
+}
+
+flx_float aot::floor_divide(flx_float lval, flx_float rval) {
+	return RuntimeOperations::do_operation(lval, rval, "/%");
+}
+
+flx_int aot::power(flx_int lval, flx_int rval) {
+	return RuntimeOperations::do_operation(lval, rval, "**");
+}
+
+flx_float aot::power(flx_float lval, flx_float rval) {
+	return RuntimeOperations::do_operation(lval, rval, "**");
+}
+
+flx_int aot::compare(flx_float lval, flx_float rval) {
+	return lval < rval ? -1 : lval == rval ? 0 : 1;
+}
+
+DynamicValue aot::operation(const std::string& op, const DynamicValue& lval, const DynamicValue& rval) {
+	return ScalarOperations::operation(op, lval, rval);
+}
+
+DynamicValue aot::untyped_division(const std::string& op, const DynamicValue& lval, const DynamicValue& rval) {
+	return ScalarOperations::untyped_division(op, lval, rval);
+}
+
+DynamicValue aot::unary(const std::string& op, const DynamicValue& value) {
+	return ScalarOperations::unary(op, value);
+}
+
+DynamicValue aot::cast(const DynamicValue& value, Type type) {
+	return ScalarOperations::cast(value, type);
+}
+
+bool aot::is_false(const DynamicValue& value) {
+	return is_bool(value.type) && !value.b;
+}
+
+flx_bool aot::condition(const DynamicValue& value) {
+	return ScalarOperations::condition(value);
+}
+
+flx_bool aot::to_bool(const DynamicValue& value) {
+	return native_store(value, Type::T_BOOL).b;
+}
+
+flx_int aot::to_int(const DynamicValue& value) {
+	return native_store(value, Type::T_INT).i;
+}
+
+flx_float aot::to_float(const DynamicValue& value) {
+	return native_store(value, Type::T_FLOAT).f;
+}
+
+void aot::print(const DynamicValue& value) {
+	std::cout << ScalarOperations::to_string(value);
+}
+
+void aot::print(const char* text) {
+	std::cout << text;
+}
+
+void aot::print_line() {
+	std::cout << std::endl;
+}
+
+void aot::exit(flx_int code) {
+	throw ProgramExit{ code };
+}
+
+void aot::exit(const DynamicValue& code) {
+	if (!is_int(code.type)) {
+		throw std::runtime_error("expected int value");
+	}
+	throw ProgramExit{ code.i };
+}
+
+int aot::run(const std::string& name, void(*program)()) {
+	SetConsoleOutputCP(CP_UTF8);
+
+	try {
+		program();
+	}
+	catch (const ProgramExit& ex) {
+		return int(ex.code);
+	}
+	catch (const std::exception& ex) {
+		std::cerr << "(AOT) " << name << '[' << row << ':' << col << "]: " << ex.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
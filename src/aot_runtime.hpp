@@ -0,0 +1,84 @@
+#ifndef AOT_RUNTIME_HPP
+#define AOT_RUNTIME_HPP
+
+#include <string>
+#include <stdexcept>
+
+#include "register_bytecode.hpp"
+#include "types.hpp"
+
+// support library of the programs written by the transpiler, they are built together with the interpreter sources
+namespace aot {
+
+	// values of untyped variables, their type is only known at run time
+	typedef vm::RegisterValue DynamicValue;
+
+	// thrown by exit to unwind the translated program
+	class ProgramExit {
+	public:
+		flx_int code;
+	};
+
+	// source position reported by runtime errors, set before every operation that can fail
+	extern unsigned int row;
+	extern unsigned int col;
+
+	inline void at(unsigned int r, unsigned int c) {
+		row = r;
+		col = c;
+	}
+
+	inline flx_int divide(flx_int lval, flx_int rval) {
+		if (rval == 0) {
+			throw std::runtime_error("division by zero encountered");
+		}
+		return lval / rval;
+	}
+
+	inline flx_float divide(flx_float lval, flx_float rval) {
+		if (int(rval) == 0) {
+			throw std::runtime_error("division by zero encountered");
+		}
+		return lval / rval;
+	}
+
+	inline flx_int remainder(flx_int lval, flx_int rval) {
+		if (rval == 0) {
+			throw std::runtime_error("remainder by zero is undefined");
+		}
+		return lval % rval;
+	}
+
+	flx_float remainder(flx_float lval, flx_float rval);
+	flx_int floor_divide(flx_int lval, flx_int rval);
+	flx_float floor_divide(flx_float lval, flx_float rval);
+	flx_int power(flx_int lval, flx_int rval);
+	flx_float power(flx_float lval, flx_float rval);
+	flx_int compare(flx_float lval, flx_float rval);
+
+	DynamicValue operation(const std::string& op, const DynamicValue& lval, const DynamicValue& rval);
+	DynamicValue untyped_division(const std::string& op, const DynamicValue& lval, const DynamicValue& rval);
+	DynamicValue unary(const std::string& op, const DynamicValue& value);
+	DynamicValue cast(const DynamicValue& value, Type type);
+
+	bool is_false(const DynamicValue& value);
+	flx_bool condition(const DynamicValue& value);
+
+	// checked stores of untyped values into typed variables
+	flx_bool to_bool(const DynamicValue& value);
+	flx_int to_int(const DynamicValue& value);
+	flx_float to_float(const DynamicValue& value);
+
+	void print(const DynamicValue& value);
+	void print(const char* text);
+	void print_line();
+
+	[[noreturn]] void exit(flx_int code);
+	[[noreturn]] void exit(const DynamicValue& code);
+
+	// runs the translated main program, returns its exit code
+	int run(const std::string& name, void(*program)());
+
+}
+
+#endif // !AOT_RUNTIME_HPP
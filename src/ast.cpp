@@ -16,6 +16,21 @@ Identifier::Identifier(const std::string& identifier)
 Identifier::Identifier()
 	: identifier(""), access_vector(std::vector<std::shared_ptr<ASTExprNode>>()) {}
 
+void LexicalAddress::resolve(long long depth, long long slot) {
+	if (visited && (this->depth != depth || this->slot != slot)) {
+		this->depth = -1;
+		this->slot = -1;
+		return;
+	}
+	visited = true;
+	this->depth = depth;
+	this->slot = slot;
+}
+
+bool LexicalAddress::is_resolved() const {
+	return depth >= 0 && slot >= 0;
+}
+
 ASTProgramNode::ASTProgramNode(const std::string& name, const std::string& name_space, const std::vector<std::shared_ptr<ASTNode>>& statements)
 	: ASTNode(row, col), name(name), name_space(name_space), statements(statements), libs(std::vector<std::shared_ptr<ASTProgramNode>>()) {}
 
@@ -120,7 +135,7 @@ ASTThisNode::ASTThisNode(unsigned int row, unsigned int col)
 	: ASTExprNode(row, col) {}
 
 ASTBinaryExprNode::ASTBinaryExprNode(const std::string& op, std::shared_ptr<ASTExprNode> left, std::shared_ptr<ASTExprNode> right, unsigned int row, unsigned int col)
-	: ASTExprNode(row, col), op(op), left(left), right(right) {}
+	: ASTExprNode(row, col), op(op), left(left), right(right), operand_type(Type::T_UNDEFINED) {}
 
 ASTUnaryExprNode::ASTUnaryExprNode(const std::string& unary_op, std::shared_ptr<ASTExprNode> expr, unsigned int row, unsigned int col)
 	: ASTExprNode(row, col), unary_op(unary_op), expr(expr) {}
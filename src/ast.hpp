@@ -17,6 +17,8 @@ namespace parser {
 	public:
 		std::string identifier;
 		std::vector<std::shared_ptr<ASTExprNode>> access_vector;
+		// slot of the field in the last struct layout read through this identifier
+		mutable FieldCache field_cache;
 
 		Identifier(const std::string& identifier, const std::vector<std::shared_ptr<ASTExprNode>>& access_vector);
 
@@ -25,6 +27,18 @@ namespace parser {
 		Identifier();
 	};
 
+	// variable position resolved by the semantic analysis: scopes up from the innermost one, and declaration slot inside it
+	class LexicalAddress {
+	public:
+		long long depth = -1;
+		long long slot = -1;
+		bool visited = false;
+
+		// keeps the address only while every analysis of the node agrees on it
+		void resolve(long long depth, long long slot);
+		bool is_resolved() const;
+	};
+
 	class ASTNode : public std::enable_shared_from_this<ASTNode>, public CodePosition {
 	public:
 		ASTNode(unsigned int row, unsigned int col)
@@ -127,6 +141,7 @@ namespace parser {
 		std::vector<Identifier> identifier_vector;
 		std::string op;
 		std::shared_ptr<ASTExprNode> expr;
+		LexicalAddress address;
 
 		ASTAssignmentNode(const std::vector<Identifier>& identifier_vector, const std::string& name_space,
 			const std::string& op, std::shared_ptr<ASTExprNode> expr, unsigned int row, unsigned int col);
@@ -386,6 +401,8 @@ namespace parser {
 		std::string op;
 		std::shared_ptr<ASTExprNode> left;
 		std::shared_ptr<ASTExprNode> right;
+		// numeric type both operands are proven to have, T_ANY when not proven in every analysis
+		Type operand_type;
 
 		ASTBinaryExprNode(const std::string& op, std::shared_ptr<ASTExprNode> left, std::shared_ptr<ASTExprNode> right, unsigned int row, unsigned int col);
 
@@ -409,6 +426,7 @@ namespace parser {
 		std::string identifier;
 		std::string name_space;
 		std::vector<Identifier> identifier_vector;
+		LexicalAddress address;
 
 		explicit ASTIdentifierNode(const std::vector<Identifier>& identifier_vector, std::string name_space, unsigned int row, unsigned int col);
 
@@ -445,6 +463,9 @@ namespace parser {
 		std::string name_space;
 		std::vector<Identifier> identifier_vector;
 		std::vector<std::shared_ptr<ASTExprNode>> parameters;
+		CallSiteCache call_cache;
+		// returned as is by the function that makes it, set by the semantic analysis
+		bool is_tail_call = false;
 
 		ASTFunctionCallNode(const std::string& name_space,
 			const std::vector<Identifier>& identifier_vector,
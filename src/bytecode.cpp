@@ -1,93 +1,210 @@
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
 
 #include "bytecode.hpp"
 
 using namespace vm;
 
-BytecodeInstruction::BytecodeInstruction()
-	: opcode(OpCode::OP_RES), operand(nullptr) {}
-
-BytecodeInstruction::BytecodeInstruction(OpCode opcode, uint8_t* operand)
-	: opcode(opcode), operand(operand) {}
-
-BytecodeInstruction::BytecodeInstruction(OpCode opcode, uint8_t operand)
-	: opcode(opcode), operand(to_byteopnd(operand)) {}
-
-BytecodeInstruction::BytecodeInstruction(OpCode opcode, size_t operand)
-	: opcode(opcode), operand(to_byteopnd(operand)) {}
-
-BytecodeInstruction::BytecodeInstruction(OpCode opcode, flx_bool operand)
-	: opcode(opcode), operand(to_byteopnd(operand)) {}
-
-BytecodeInstruction::BytecodeInstruction(OpCode opcode, flx_int operand)
-	: opcode(opcode), operand(to_byteopnd(operand)) {}
-
-BytecodeInstruction::BytecodeInstruction(OpCode opcode, flx_float operand)
-	: opcode(opcode), operand(to_byteopnd(operand)) {}
+DecodedInstruction::DecodedInstruction()
+	: opcode(OpCode::OP_RES), f(0) {}
 
-BytecodeInstruction::BytecodeInstruction(OpCode opcode, flx_char operand)
-	: opcode(opcode), operand(to_byteopnd(operand)) {}
-
-BytecodeInstruction::BytecodeInstruction(OpCode opcode, const flx_string& operand)
-	: opcode(opcode), operand(to_byteopnd(operand)) {}
-
-uint8_t BytecodeInstruction::get_uint8_operand() const {
-	return *operand;
-}
-
-size_t BytecodeInstruction::get_size_operand() const {
-	return *reinterpret_cast<size_t*>(operand);
+bool TypeDescriptor::operator==(const TypeDescriptor& other) const {
+	return type == other.type && array_type == other.array_type
+		&& type_name == other.type_name && type_name_space == other.type_name_space
+		&& identifier == other.identifier;
 }
 
-flx_bool BytecodeInstruction::get_bool_operand() const {
-	return *reinterpret_cast<flx_bool*>(operand);
-}
-
-flx_int BytecodeInstruction::get_int_operand() const {
-	return *reinterpret_cast<flx_int*>(operand);
+uint32_t ConstantPool::add_string(const flx_string& value) {
+	auto it = string_indexes.find(value);
+	if (it != string_indexes.end()) {
+		return it->second;
+	}
+	uint32_t index = uint32_t(strings.size());
+	strings.push_back(value);
+	string_indexes.emplace(value, index);
+	return index;
 }
 
-flx_float BytecodeInstruction::get_float_operand() const {
-	return *reinterpret_cast<flx_float*>(operand);
+uint32_t ConstantPool::add_int(flx_int value) {
+	auto it = int_indexes.find(value);
+	if (it != int_indexes.end()) {
+		return it->second;
+	}
+	uint32_t index = uint32_t(ints.size());
+	ints.push_back(value);
+	int_indexes.emplace(value, index);
+	return index;
 }
 
-flx_char BytecodeInstruction::get_char_operand() const {
-	return *reinterpret_cast<flx_char*>(operand);
+uint32_t ConstantPool::add_float(flx_float value) {
+	auto it = float_indexes.find(value);
+	if (it != float_indexes.end()) {
+		return it->second;
+	}
+	uint32_t index = uint32_t(floats.size());
+	floats.push_back(value);
+	float_indexes.emplace(value, index);
+	return index;
 }
 
-flx_string BytecodeInstruction::get_string_operand() const {
-	uint64_t size;
-	std::memcpy(&size, operand, sizeof(uint64_t));
-
-	std::string result(reinterpret_cast<char*>(operand + sizeof(uint64_t)), size);
-	return result;
+uint32_t ConstantPool::add_type_descriptor(const TypeDescriptor& value) {
+	// few distinct descriptors per program, a linear search is enough
+	auto it = std::find(type_descriptors.begin(), type_descriptors.end(), value);
+	if (it != type_descriptors.end()) {
+		return uint32_t(std::distance(type_descriptors.begin(), it));
+	}
+	type_descriptors.push_back(value);
+	return uint32_t(type_descriptors.size() - 1);
 }
 
-template <typename T>
-uint8_t* BytecodeInstruction::to_byteopnd(T value) {
-	static_assert(std::is_arithmetic<T>::value, "Only arithmetic types are supported");
-
-	uint8_t* buffer = new uint8_t[sizeof(T)];
+BytecodeInstruction::BytecodeInstruction()
+	: opcode(OpCode::OP_RES), operand(0) {}
 
-	std::memcpy(buffer, &value, sizeof(T));
+BytecodeInstruction::BytecodeInstruction(OpCode opcode, uint32_t operand)
+	: opcode(opcode), operand(operand) {}
 
-	return buffer;
+OperandType BytecodeInstruction::get_operand_type(OpCode opcode) {
+	switch (opcode)
+	{
+	case OP_SET_TYPE:
+	case OP_SET_ARRAY_TYPE:
+	case OP_TYPE_PARSE:
+	case OP_IS_TYPE:
+		return OperandType::OT_UINT8;
+	case OP_INIT_ARRAY:
+	case OP_SET_ELEMENT:
+	case OP_CALL_PARAM_COUNT:
+	case OP_JUMP:
+	case OP_JUMP_IF_FALSE:
+	case OP_JUMP_IF_FALSE_OR_NEXT:
+	case OP_JUMP_IF_TRUE:
+	case OP_JUMP_IF_TRUE_OR_NEXT:
+		return OperandType::OT_SIZE;
+	case OP_PUSH_BOOL:
+	case OP_SET_IS_REST:
+		return OperandType::OT_BOOL;
+	case OP_PUSH_INT:
+		return OperandType::OT_INT;
+	case OP_PUSH_FLOAT:
+		return OperandType::OT_FLOAT;
+	case OP_PUSH_CHAR:
+		return OperandType::OT_CHAR;
+	case OP_PUSH_NAMESPACE:
+	case OP_INCLUDE_NAMESPACE:
+	case OP_EXCLUDE_NAMESPACE:
+	case OP_PUSH_STRING:
+	case OP_PUSH_FUNCTION:
+	case OP_INIT_STRUCT:
+	case OP_SET_FIELD:
+	case OP_STRUCT_START:
+	case OP_STRUCT_SET_VAR:
+	case OP_SET_TYPE_NAME:
+	case OP_SET_TYPE_NAME_SPACE:
+	case OP_LOAD_VAR:
+	case OP_STORE_VAR:
+	case OP_LOAD_SUB_ID:
+	case OP_ASSIGN_SUB_ID:
+	case OP_FUN_START:
+	case OP_FUN_SET_PARAM:
+	case OP_CALL:
+	case OP_TAIL_CALL:
+	case OP_INC_VAR:
+	case OP_DEC_VAR:
+		return OperandType::OT_STRING;
+	case OP_SET_TYPE_DESCRIPTOR:
+	case OP_STORE_TYPED_VAR:
+		return OperandType::OT_TYPE_DESCRIPTOR;
+	default:
+		return OperandType::OT_NONE;
+	}
 }
 
-uint8_t* BytecodeInstruction::to_byteopnd(const std::string& str) {
-	uint64_t size = static_cast<uint64_t>(str.size());
-	size_t total_size = sizeof(size) + str.size();
-
-	uint8_t* buffer = new uint8_t[total_size];
-
-	std::memcpy(buffer, &size, sizeof(size));
-	std::memcpy(buffer + sizeof(size), str.data(), str.size());
-
-	return buffer;
+int BytecodeInstruction::get_stack_effect(OpCode opcode) {
+	switch (opcode)
+	{
+	case OP_PUSH_NAMESPACE_STACK:
+	case OP_PUSH_UNDEFINED:
+	case OP_PUSH_VOID:
+	case OP_PUSH_BOOL:
+	case OP_PUSH_INT:
+	case OP_PUSH_FLOAT:
+	case OP_PUSH_CHAR:
+	case OP_PUSH_STRING:
+	case OP_PUSH_FUNCTION:
+	case OP_PUSH_ARRAY:
+	case OP_PUSH_STRUCT:
+	case OP_LOAD_VAR:
+	case OP_NEXT_ELEMENT:
+	case OP_CALL:
+	case OP_TAIL_CALL:
+		return 1;
+	case OP_POP_CONSTANT:
+	case OP_SET_ELEMENT:
+	case OP_SET_FIELD:
+	case OP_SET_DEFAULT_VALUE:
+	case OP_STORE_VAR:
+	case OP_STORE_TYPED_VAR:
+	case OP_LOAD_SUB_IX:
+	case OP_STORE_COMP:
+	case OP_THROW:
+	case OP_JUMP_IF_FALSE:
+	case OP_JUMP_IF_FALSE_OR_NEXT:
+	case OP_JUMP_IF_TRUE:
+	case OP_JUMP_IF_TRUE_OR_NEXT:
+	case OP_IN:
+	case OP_OR:
+	case OP_AND:
+	case OP_BIT_OR:
+	case OP_BIT_XOR:
+	case OP_BIT_AND:
+	case OP_EQL:
+	case OP_DIF:
+	case OP_LT:
+	case OP_LTE:
+	case OP_GT:
+	case OP_GTE:
+	case OP_SPACE_SHIP:
+	case OP_LEFT_SHIFT:
+	case OP_RIGHT_SHIFT:
+	case OP_ADD:
+	case OP_SUB:
+	case OP_MUL:
+	case OP_DIV:
+	case OP_REMAINDER:
+	case OP_FLOOR_DIV:
+	case OP_EXP:
+	case OP_EQL_INT:
+	case OP_DIF_INT:
+	case OP_LT_INT:
+	case OP_LTE_INT:
+	case OP_GT_INT:
+	case OP_GTE_INT:
+	case OP_ADD_INT:
+	case OP_SUB_INT:
+	case OP_MUL_INT:
+	case OP_EQL_FLOAT:
+	case OP_DIF_FLOAT:
+	case OP_LT_FLOAT:
+	case OP_LTE_FLOAT:
+	case OP_GT_FLOAT:
+	case OP_GTE_FLOAT:
+	case OP_ADD_FLOAT:
+	case OP_SUB_FLOAT:
+	case OP_MUL_FLOAT:
+		return -1;
+	case OP_ASSIGN_VAR:
+	case OP_ASSIGN_SUB_ID:
+	case OP_TERNARY:
+		return -2;
+	case OP_ASSIGN_SUB_IX:
+		return -3;
+	default:
+		return 0;
+	}
 }
 
-void BytecodeInstruction::write_bytecode_table(const std::vector<BytecodeInstruction>& instructions, const std::string& filename) {
+void BytecodeInstruction::write_bytecode_table(const std::vector<BytecodeInstruction>& instructions, const ConstantPool& constant_pool, const std::string& filename) {
 	std::ofstream file(filename);
 
 	if (!file.is_open()) {
@@ -102,52 +219,33 @@ void BytecodeInstruction::write_bytecode_table(const std::vector<BytecodeInstruc
 		
 		file << std::setw(22 - OP_NAMES.at(instruction.opcode).size()) << std::setfill(' ') << "\t" << std::dec;
 
-		switch (instruction.opcode)
+		switch (get_operand_type(instruction.opcode))
 		{
-		case OP_SET_TYPE:
-		case OP_TYPE_PARSE:
-		case OP_IS_TYPE:
-			file << int(instruction.get_uint8_operand());
-			break;
-		case OP_SET_ELEMENT:
-		case OP_JUMP:
-		case OP_JUMP_IF_FALSE:
-		case OP_JUMP_IF_FALSE_OR_NEXT:
-		case OP_JUMP_IF_TRUE:
-		case OP_JUMP_IF_TRUE_OR_NEXT:
-			file << instruction.get_size_operand();
+		case OperandType::OT_UINT8:
+		case OperandType::OT_SIZE:
+		case OperandType::OT_BOOL:
+			file << instruction.operand;
 			break;
-		case OP_PUSH_BOOL:
-		case OP_INIT_ARRAY:
-			file << instruction.get_bool_operand();
+		case OperandType::OT_CHAR:
+			file << flx_char(instruction.operand);
 			break;
-		case OP_PUSH_INT:
-			file << instruction.get_int_operand();
+		case OperandType::OT_INT:
+			file << constant_pool.ints[instruction.operand];
 			break;
-		case OP_PUSH_FLOAT:
-			file << instruction.get_float_operand();
+		case OperandType::OT_FLOAT:
+			file << constant_pool.floats[instruction.operand];
 			break;
-		case OP_PUSH_CHAR:
-			file << instruction.get_char_operand();
+		case OperandType::OT_STRING:
+			file << constant_pool.strings[instruction.operand];
 			break;
-		case OP_PUSH_STRING:
-		case OP_PUSH_FUNCTION:
-		case OP_INIT_STRUCT:
-		case OP_SET_FIELD:
-		case OP_SET_TYPE_NAME:
-		case OP_SET_TYPE_NAME_SPACE:
-		case OP_STRUCT_START:
-		case OP_LOAD_VAR:
-		case OP_STORE_VAR:
-		case OP_FUN_START:
-		case OP_CALL:
-		case OP_LOAD_SUB_ID:
-			file << instruction.get_string_operand();
+		case OperandType::OT_TYPE_DESCRIPTOR: {
+			const auto& descriptor = constant_pool.type_descriptors[instruction.operand];
+			file << constant_pool.strings[descriptor.identifier] << " "
+				<< int(descriptor.type) << " " << int(descriptor.array_type) << " "
+				<< constant_pool.strings[descriptor.type_name_space] << "::" << constant_pool.strings[descriptor.type_name];
 			break;
+		}
 		default:
-			if (instruction.operand) {
-				file << "[UNHANDLED]\t" << instruction.operand;
-			}
 			break;
 		}
 
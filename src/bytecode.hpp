@@ -3,40 +3,95 @@
 
 #include <iostream>
 #include <cstdint>
+#include <map>
+#include <unordered_map>
 
 #include "vm_constants.hpp"
 #include "types.hpp"
 
 namespace vm {
 
+	enum class OperandType {
+		OT_NONE, OT_UINT8, OT_SIZE, OT_BOOL, OT_INT, OT_FLOAT, OT_CHAR, OT_STRING, OT_TYPE_DESCRIPTOR
+	};
+
+	// instruction with its operand decoded once before execution, strings are indexes in the vm string table
+	class DecodedInstruction {
+	public:
+		OpCode opcode;
+		union {
+			uint8_t u8;
+			size_t size;
+			flx_bool b;
+			flx_int i;
+			flx_float f;
+			flx_char c;
+			uint32_t index;
+		};
+
+		DecodedInstruction();
+	};
+
+	// type set of a declaration, names are indexes in the string pool
+	class TypeDescriptor {
+	public:
+		Type type;
+		Type array_type;
+		uint32_t type_name;
+		uint32_t type_name_space;
+		// variable declared by OP_STORE_TYPED_VAR
+		uint32_t identifier;
+
+		bool operator==(const TypeDescriptor& other) const;
+	};
+
+	// try block of the compiled program, a throw at an instruction in [start, end) continues at target
+	// with the value stack of the frame cut to stack_depth values, entries of inner blocks come first
+	class ExceptionTableEntry {
+	public:
+		// target of the entries covering function bodies nested in a try block, their throws go to the caller
+		static const uint32_t no_handler = UINT32_MAX;
+
+		uint32_t start;
+		uint32_t end;
+		uint32_t target;
+		uint32_t stack_depth;
+	};
+
+	// per program pool of interned operands, instructions reference its entries by index
+	class ConstantPool {
+	public:
+		std::vector<flx_string> strings;
+		std::vector<flx_int> ints;
+		std::vector<flx_float> floats;
+		std::vector<TypeDescriptor> type_descriptors;
+
+		uint32_t add_string(const flx_string& value);
+		uint32_t add_int(flx_int value);
+		uint32_t add_float(flx_float value);
+		uint32_t add_type_descriptor(const TypeDescriptor& value);
+
+	private:
+		std::unordered_map<flx_string, uint32_t> string_indexes;
+		std::unordered_map<flx_int, uint32_t> int_indexes;
+		std::map<flx_float, uint32_t> float_indexes;
+
+	};
+
 	class BytecodeInstruction {
 	public:
 		OpCode opcode;
-		uint8_t* operand;
+		// immediate value for small operands, constant pool index for ints, floats and strings
+		uint32_t operand;
 
 		BytecodeInstruction();
-		BytecodeInstruction(OpCode opcode, uint8_t* operand);
-		BytecodeInstruction(OpCode opcode, uint8_t operand);
-		BytecodeInstruction(OpCode opcode, size_t operand);
-		BytecodeInstruction(OpCode opcode, flx_bool operand);
-		BytecodeInstruction(OpCode opcode, flx_int operand);
-		BytecodeInstruction(OpCode opcode, flx_float operand);
-		BytecodeInstruction(OpCode opcode, flx_char operand);
-		BytecodeInstruction(OpCode opcode, const flx_string& operand);
-
-		uint8_t get_uint8_operand() const;
-		size_t get_size_operand() const;
-		flx_bool get_bool_operand() const;
-		flx_int get_int_operand() const;
-		flx_float get_float_operand() const;
-		flx_char get_char_operand() const;
-		flx_string get_string_operand() const;
-
-		template <typename T>
-		static uint8_t* to_byteopnd(T value);
-		static uint8_t* to_byteopnd(const std::string& str);
-
-		static void write_bytecode_table(const std::vector<BytecodeInstruction>& instructions, const std::string& filename);
+		BytecodeInstruction(OpCode opcode, uint32_t operand);
+
+		static OperandType get_operand_type(OpCode opcode);
+		// values the instruction leaves on the operand stack minus the values it takes
+		static int get_stack_effect(OpCode opcode);
+
+		static void write_bytecode_table(const std::vector<BytecodeInstruction>& instructions, const ConstantPool& constant_pool, const std::string& filename);
 	};
 
 }
@@ -0,0 +1,236 @@
+#include <fstream>
+
+#include "bytecode_cache.hpp"
+
+using namespace vm;
+
+static const char cache_magic[4] = { 'F', 'L', 'X', 'C' };
+
+template <typename T>
+static void write_value(std::ofstream& file, T value) {
+	file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void write_string(std::ofstream& file, const std::string& value) {
+	write_value(file, uint64_t(value.size()));
+	file.write(value.data(), value.size());
+}
+
+template <typename T>
+static bool read_value(std::ifstream& file, T& value) {
+	return bool(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+static bool read_string(std::ifstream& file, std::string& value, uint64_t max_size) {
+	uint64_t size;
+	if (!read_value(file, size) || size > max_size) {
+		return false;
+	}
+	value.resize(size);
+	return bool(file.read(value.data(), size));
+}
+
+// operands that index the constant pool must point into it, the vm reads them unchecked
+static bool is_valid_instruction(const BytecodeInstruction& instruction, const ConstantPool& constant_pool) {
+	if (instruction.opcode >= OP_SIZE) {
+		return false;
+	}
+
+	switch (BytecodeInstruction::get_operand_type(instruction.opcode)) {
+	case OperandType::OT_INT:
+		return instruction.operand < constant_pool.ints.size();
+	case OperandType::OT_FLOAT:
+		return instruction.operand < constant_pool.floats.size();
+	case OperandType::OT_STRING:
+		return instruction.operand < constant_pool.strings.size();
+	case OperandType::OT_TYPE_DESCRIPTOR:
+		return instruction.operand < constant_pool.type_descriptors.size();
+	default:
+		return true;
+	}
+}
+
+uint64_t BytecodeCache::hash_source(const std::string& source) {
+	// FNV-1a, stable across runs and builds
+	uint64_t hash = 14695981039346656037ull;
+	for (unsigned char c : source) {
+		hash ^= c;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool BytecodeCache::load(const std::string& filename) {
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	// no count can exceed the file size, guards against corrupted counts
+	file.seekg(0, std::ios::end);
+	const uint64_t file_size = uint64_t(file.tellg());
+	file.seekg(0, std::ios::beg);
+
+	char magic[4];
+	uint32_t file_version;
+	uint32_t float_size;
+	if (!file.read(magic, sizeof(magic))
+		|| std::string(magic, sizeof(magic)) != std::string(cache_magic, sizeof(cache_magic))
+		|| !read_value(file, file_version) || file_version != version
+		|| !read_value(file, float_size) || float_size != sizeof(flx_float)) {
+		return false;
+	}
+
+	uint64_t size;
+
+	if (!read_value(file, size) || size > file_size) {
+		return false;
+	}
+	modules.resize(size);
+	for (auto& module : modules) {
+		if (!read_string(file, module.path, file_size) || !read_value(file, module.hash)) {
+			return false;
+		}
+	}
+
+	if (!read_value(file, size) || size > file_size) {
+		return false;
+	}
+	for (uint64_t i = 0; i < size; ++i) {
+		std::string value;
+		if (!read_string(file, value, file_size)) {
+			return false;
+		}
+		constant_pool.add_string(value);
+	}
+
+	if (!read_value(file, size) || size > file_size) {
+		return false;
+	}
+	for (uint64_t i = 0; i < size; ++i) {
+		flx_int value;
+		if (!read_value(file, value)) {
+			return false;
+		}
+		constant_pool.add_int(value);
+	}
+
+	if (!read_value(file, size) || size > file_size) {
+		return false;
+	}
+	for (uint64_t i = 0; i < size; ++i) {
+		flx_float value;
+		if (!read_value(file, value)) {
+			return false;
+		}
+		constant_pool.add_float(value);
+	}
+
+	if (!read_value(file, size) || size > file_size) {
+		return false;
+	}
+	for (uint64_t i = 0; i < size; ++i) {
+		uint8_t type;
+		uint8_t array_type;
+		TypeDescriptor value;
+		if (!read_value(file, type) || !read_value(file, array_type)
+			|| !read_value(file, value.type_name) || !read_value(file, value.type_name_space)
+			|| !read_value(file, value.identifier)) {
+			return false;
+		}
+		if (value.type_name >= constant_pool.strings.size() || value.type_name_space >= constant_pool.strings.size()
+			|| value.identifier >= constant_pool.strings.size()) {
+			return false;
+		}
+		value.type = Type(type);
+		value.array_type = Type(array_type);
+		constant_pool.add_type_descriptor(value);
+	}
+
+	if (!read_value(file, size) || size > file_size) {
+		return false;
+	}
+	instructions.resize(size);
+	for (auto& instruction : instructions) {
+		uint16_t opcode;
+		if (!read_value(file, opcode) || !read_value(file, instruction.operand)) {
+			return false;
+		}
+		instruction.opcode = OpCode(opcode);
+		if (!is_valid_instruction(instruction, constant_pool)) {
+			return false;
+		}
+	}
+
+	if (!read_value(file, size) || size > file_size) {
+		return false;
+	}
+	exception_table.resize(size);
+	for (auto& entry : exception_table) {
+		if (!read_value(file, entry.start) || !read_value(file, entry.end)
+			|| !read_value(file, entry.target) || !read_value(file, entry.stack_depth)) {
+			return false;
+		}
+		if (entry.start > entry.end || entry.end > instructions.size()
+			|| (entry.target > instructions.size() && entry.target != ExceptionTableEntry::no_handler)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void BytecodeCache::save(const std::string& filename) const {
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return;
+	}
+
+	file.write(cache_magic, sizeof(cache_magic));
+	write_value(file, version);
+	write_value(file, uint32_t(sizeof(flx_float)));
+
+	write_value(file, uint64_t(modules.size()));
+	for (const auto& module : modules) {
+		write_string(file, module.path);
+		write_value(file, module.hash);
+	}
+
+	write_value(file, uint64_t(constant_pool.strings.size()));
+	for (const auto& value : constant_pool.strings) {
+		write_string(file, value);
+	}
+
+	write_value(file, uint64_t(constant_pool.ints.size()));
+	for (const auto& value : constant_pool.ints) {
+		write_value(file, value);
+	}
+
+	write_value(file, uint64_t(constant_pool.floats.size()));
+	for (const auto& value : constant_pool.floats) {
+		write_value(file, value);
+	}
+
+	write_value(file, uint64_t(constant_pool.type_descriptors.size()));
+	for (const auto& value : constant_pool.type_descriptors) {
+		write_value(file, uint8_t(value.type));
+		write_value(file, uint8_t(value.array_type));
+		write_value(file, value.type_name);
+		write_value(file, value.type_name_space);
+		write_value(file, value.identifier);
+	}
+
+	write_value(file, uint64_t(instructions.size()));
+	for (const auto& instruction : instructions) {
+		write_value(file, uint16_t(instruction.opcode));
+		write_value(file, instruction.operand);
+	}
+
+	write_value(file, uint64_t(exception_table.size()));
+	for (const auto& entry : exception_table) {
+		write_value(file, entry.start);
+		write_value(file, entry.end);
+		write_value(file, entry.target);
+		write_value(file, entry.stack_depth);
+	}
+}
@@ -0,0 +1,36 @@
+#ifndef BYTECODE_CACHE_HPP
+#define BYTECODE_CACHE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "bytecode.hpp"
+
+namespace vm {
+
+	struct CachedModule {
+		std::string path;
+		uint64_t hash;
+	};
+
+	// compiled program stored on disk, valid while every module source hash matches
+	class BytecodeCache {
+	public:
+		static const uint32_t version = 5;
+
+		std::vector<CachedModule> modules;
+		std::vector<BytecodeInstruction> instructions;
+		ConstantPool constant_pool;
+		std::vector<ExceptionTableEntry> exception_table;
+
+		static uint64_t hash_source(const std::string& source);
+
+		// returns false when the file is missing, corrupted or from another format version
+		bool load(const std::string& filename);
+		void save(const std::string& filename) const;
+	};
+
+}
+
+#endif // !BYTECODE_CACHE_HPP
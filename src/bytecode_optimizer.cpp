@@ -0,0 +1,287 @@
+#include <algorithm>
+
+#include "bytecode_optimizer.hpp"
+
+using namespace vm;
+
+BytecodeOptimizer::BytecodeOptimizer(std::vector<BytecodeInstruction>& instructions, ConstantPool& constant_pool,
+	std::vector<ExceptionTableEntry>& exception_table)
+	: instructions(instructions), constant_pool(constant_pool), exception_table(exception_table) {}
+
+void BytecodeOptimizer::optimize() {
+	find_leaders();
+
+	// new position of every original instruction, used to retarget jumps
+	std::vector<size_t> positions(instructions.size() + 1);
+	optimized.clear();
+	optimized.reserve(instructions.size());
+
+	size_t pos = 0;
+	while (pos < instructions.size()) {
+		positions[pos] = optimized.size();
+
+		size_t size = fuse_inc_var(pos);
+		if (!size) {
+			size = fuse_typed_store(pos);
+		}
+		if (!size) {
+			size = fuse_type_set(pos);
+		}
+		if (!size) {
+			if (!is_dead_jump(pos)) {
+				optimized.push_back(instructions[pos]);
+			}
+			size = 1;
+		}
+
+		for (size_t i = 1; i < size; ++i) {
+			positions[pos + i] = positions[pos];
+		}
+		pos += size;
+	}
+	positions[instructions.size()] = optimized.size();
+
+	for (auto& instruction : optimized) {
+		if (is_jump(instruction.opcode) && instruction.operand < positions.size()) {
+			instruction.operand = uint32_t(positions[instruction.operand]);
+		}
+	}
+
+	for (auto& entry : exception_table) {
+		entry.start = uint32_t(positions[entry.start]);
+		entry.end = uint32_t(positions[entry.end]);
+		if (entry.target != ExceptionTableEntry::no_handler) {
+			entry.target = uint32_t(positions[entry.target]);
+		}
+	}
+
+	instructions = std::move(optimized);
+	optimized = std::vector<BytecodeInstruction>();
+}
+
+bool BytecodeOptimizer::is_jump(OpCode opcode) {
+	switch (opcode) {
+	case OP_JUMP:
+	case OP_JUMP_IF_FALSE:
+	case OP_JUMP_IF_FALSE_OR_NEXT:
+	case OP_JUMP_IF_TRUE:
+	case OP_JUMP_IF_TRUE_OR_NEXT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool BytecodeOptimizer::is_type_set(OpCode opcode) {
+	switch (opcode) {
+	case OP_SET_TYPE:
+	case OP_SET_ARRAY_TYPE:
+	case OP_SET_TYPE_NAME:
+	case OP_SET_TYPE_NAME_SPACE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool BytecodeOptimizer::is_single_value(OpCode opcode) {
+	switch (opcode) {
+	case OP_PUSH_UNDEFINED:
+	case OP_PUSH_VOID:
+	case OP_PUSH_BOOL:
+	case OP_PUSH_INT:
+	case OP_PUSH_FLOAT:
+	case OP_PUSH_CHAR:
+	case OP_PUSH_STRING:
+	case OP_PUSH_FUNCTION:
+	case OP_LOAD_VAR:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void BytecodeOptimizer::find_leaders() {
+	leaders.assign(instructions.size() + 1, false);
+	leaders[0] = true;
+
+	for (size_t i = 0; i < instructions.size(); ++i) {
+		const auto& instruction = instructions[i];
+
+		if (is_jump(instruction.opcode)) {
+			if (instruction.operand < leaders.size()) {
+				leaders[instruction.operand] = true;
+			}
+			leaders[i + 1] = true;
+		}
+		else if (instruction.opcode == OP_FUN_END) {
+			// the function pointer is computed at runtime from the layout after OP_FUN_END
+			for (size_t j = i + 1; j <= i + 3 && j < leaders.size(); ++j) {
+				leaders[j] = true;
+			}
+		}
+	}
+
+	for (const auto& entry : exception_table) {
+		leaders[entry.start] = true;
+		leaders[entry.end] = true;
+		if (entry.target != ExceptionTableEntry::no_handler) {
+			leaders[entry.target] = true;
+		}
+	}
+}
+
+bool BytecodeOptimizer::can_fuse(size_t start, size_t size) const {
+	if (start + size > instructions.size()) {
+		return false;
+	}
+	for (size_t i = start + 1; i < start + size; ++i) {
+		if (leaders[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t BytecodeOptimizer::type_set_size(size_t start) const {
+	size_t size = 0;
+	while (start + size < instructions.size() && is_type_set(instructions[start + size].opcode)) {
+		++size;
+	}
+	return size;
+}
+
+uint32_t BytecodeOptimizer::build_type_descriptor(size_t start, size_t size, uint32_t identifier) {
+	// every consumer of the type set cleans it, so unset fields match the cleaned state
+	const auto empty_string = constant_pool.add_string("");
+	TypeDescriptor descriptor{ Type::T_UNDEFINED, Type::T_UNDEFINED, empty_string, empty_string, identifier };
+
+	for (size_t i = start; i < start + size; ++i) {
+		const auto& instruction = instructions[i];
+		switch (instruction.opcode) {
+		case OP_SET_TYPE:
+			descriptor.type = Type(instruction.operand);
+			break;
+		case OP_SET_ARRAY_TYPE:
+			descriptor.array_type = Type(instruction.operand);
+			break;
+		case OP_SET_TYPE_NAME:
+			descriptor.type_name = instruction.operand;
+			break;
+		case OP_SET_TYPE_NAME_SPACE:
+			descriptor.type_name_space = instruction.operand;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return constant_pool.add_type_descriptor(descriptor);
+}
+
+size_t BytecodeOptimizer::fuse_inc_var(size_t start) {
+	// x = x + 1, x = 1 + x and x = x - 1
+	if (!can_fuse(start, 5)) {
+		return 0;
+	}
+
+	const auto& first = instructions[start];
+	const auto& second = instructions[start + 1];
+	const auto& operation = instructions[start + 2];
+	const auto& load = instructions[start + 3];
+	const auto& assign = instructions[start + 4];
+
+	if (load.opcode != OP_LOAD_VAR || assign.opcode != OP_ASSIGN_VAR) {
+		return 0;
+	}
+
+	const BytecodeInstruction* var = nullptr;
+	const BytecodeInstruction* step = nullptr;
+	if (first.opcode == OP_LOAD_VAR && second.opcode == OP_PUSH_INT) {
+		var = &first;
+		step = &second;
+	}
+	else if (first.opcode == OP_PUSH_INT && second.opcode == OP_LOAD_VAR
+		&& (operation.opcode == OP_ADD || operation.opcode == OP_ADD_INT)) {
+		var = &second;
+		step = &first;
+	}
+	else {
+		return 0;
+	}
+
+	if (var->operand != load.operand || constant_pool.ints[step->operand] != 1) {
+		return 0;
+	}
+
+	if (operation.opcode == OP_ADD || operation.opcode == OP_ADD_INT) {
+		optimized.emplace_back(OP_INC_VAR, var->operand);
+	}
+	else if (operation.opcode == OP_SUB || operation.opcode == OP_SUB_INT) {
+		optimized.emplace_back(OP_DEC_VAR, var->operand);
+	}
+	else {
+		return 0;
+	}
+
+	return 5;
+}
+
+size_t BytecodeOptimizer::fuse_typed_store(size_t start) {
+	// type set, single value, store or single value, type set, store as emitted for enums
+	size_t value_pos;
+	size_t type_start;
+	size_t type_size;
+
+	if (is_single_value(instructions[start].opcode)) {
+		value_pos = start;
+		type_start = start + 1;
+		type_size = type_set_size(type_start);
+	}
+	else {
+		type_start = start;
+		type_size = type_set_size(type_start);
+		value_pos = start + type_size;
+	}
+
+	const size_t store_pos = std::max(value_pos, type_start + type_size - 1) + 1;
+	const size_t size = store_pos - start + 1;
+
+	if (!type_size || !can_fuse(start, size)
+		|| !is_single_value(instructions[value_pos].opcode)
+		|| instructions[store_pos].opcode != OP_STORE_VAR) {
+		return 0;
+	}
+
+	optimized.push_back(instructions[value_pos]);
+	optimized.emplace_back(OP_STORE_TYPED_VAR, build_type_descriptor(type_start, type_size, instructions[store_pos].operand));
+
+	return size;
+}
+
+size_t BytecodeOptimizer::fuse_type_set(size_t start) {
+	size_t size = type_set_size(start);
+	while (size > 1 && !can_fuse(start, size)) {
+		--size;
+	}
+	if (size < 2) {
+		return 0;
+	}
+
+	optimized.emplace_back(OP_SET_TYPE_DESCRIPTOR, build_type_descriptor(start, size, constant_pool.add_string("")));
+
+	return size;
+}
+
+bool BytecodeOptimizer::is_dead_jump(size_t pos) const {
+	if (instructions[pos].opcode != OP_JUMP || instructions[pos].operand != pos + 1) {
+		return false;
+	}
+	// the instructions right after OP_FUN_END are part of the function layout
+	for (size_t i = 1; i <= 2 && i <= pos; ++i) {
+		if (instructions[pos - i].opcode == OP_FUN_END) {
+			return false;
+		}
+	}
+	return true;
+}
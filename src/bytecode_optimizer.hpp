@@ -0,0 +1,45 @@
+#ifndef BYTECODE_OPTIMIZER_HPP
+#define BYTECODE_OPTIMIZER_HPP
+
+#include <vector>
+
+#include "bytecode.hpp"
+
+namespace vm {
+
+	// peephole pass over the compiled program, fuses common sequences into superinstructions and drops dead jumps
+	class BytecodeOptimizer {
+	private:
+		std::vector<BytecodeInstruction>& instructions;
+		ConstantPool& constant_pool;
+		std::vector<ExceptionTableEntry>& exception_table;
+		// instructions that can be reached from a jump, a function pointer or a try block boundary, no fused sequence may span them
+		std::vector<bool> leaders;
+		std::vector<BytecodeInstruction> optimized;
+
+	private:
+		static bool is_jump(OpCode opcode);
+		static bool is_type_set(OpCode opcode);
+		static bool is_single_value(OpCode opcode);
+
+		void find_leaders();
+		bool can_fuse(size_t start, size_t size) const;
+		size_t type_set_size(size_t start) const;
+		uint32_t build_type_descriptor(size_t start, size_t size, uint32_t identifier);
+
+		size_t fuse_inc_var(size_t start);
+		size_t fuse_typed_store(size_t start);
+		size_t fuse_type_set(size_t start);
+		bool is_dead_jump(size_t pos) const;
+
+	public:
+		BytecodeOptimizer(std::vector<BytecodeInstruction>& instructions, ConstantPool& constant_pool,
+			std::vector<ExceptionTableEntry>& exception_table);
+		~BytecodeOptimizer() = default;
+
+		void optimize();
+	};
+
+}
+
+#endif // !BYTECODE_OPTIMIZER_HPP
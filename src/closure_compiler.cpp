@@ -0,0 +1,926 @@
+#include <iostream>
+
+#include "closure_compiler.hpp"
+#include "scalar_subset.hpp"
+#include "scalar_operations.hpp"
+
+using namespace visitor;
+using namespace parser;
+using namespace vm;
+
+static void set_position(ClosureContext& ctx, const CodePosition& pos) {
+	ctx.row = pos.row;
+	ctx.col = pos.col;
+}
+
+// values outside the fast paths go through the shared scalar operations
+static RegisterValue generic_operation(ClosureContext& ctx, const CodePosition& pos, const std::string& op,
+	const RegisterValue& lval, const RegisterValue& rval) {
+	set_position(ctx, pos);
+	return ScalarOperations::operation(op, lval, rval);
+}
+
+static RegisterValue store(ClosureContext& ctx, const CodePosition& pos, const RegisterValue& value, Type type) {
+	if (is_any(type) || value.type == type) {
+		return value;
+	}
+	set_position(ctx, pos);
+	return ScalarOperations::store(value, type);
+}
+
+template <typename Operation>
+static ClosureExpression arithmetic_closure(const std::string& op, ClosureExpression left, ClosureExpression right,
+	CodePosition pos, Operation operation) {
+	return [=](ClosureContext& ctx) {
+		const auto lval = left(ctx);
+		const auto rval = right(ctx);
+		if (lval.type == rval.type) {
+			if (is_int(lval.type)) {
+				return RegisterValue(flx_int(operation(lval.i, rval.i)));
+			}
+			if (is_float(lval.type)) {
+				return RegisterValue(flx_float(operation(lval.f, rval.f)));
+			}
+		}
+		return generic_operation(ctx, pos, op, lval, rval);
+		};
+}
+
+template <typename Operation>
+static ClosureExpression relational_closure(const std::string& op, ClosureExpression left, ClosureExpression right,
+	CodePosition pos, Operation operation) {
+	return [=](ClosureContext& ctx) {
+		const auto lval = left(ctx);
+		const auto rval = right(ctx);
+		if (lval.type == rval.type) {
+			if (is_int(lval.type)) {
+				return RegisterValue(flx_bool(operation(lval.i, rval.i)));
+			}
+			if (is_float(lval.type)) {
+				return RegisterValue(flx_bool(operation(lval.f, rval.f)));
+			}
+		}
+		return generic_operation(ctx, pos, op, lval, rval);
+		};
+}
+
+static ClosureExpression division_closure(const std::string& op, ClosureExpression left, ClosureExpression right, CodePosition pos) {
+	const bool is_div = op == "/";
+	return [=](ClosureContext& ctx) {
+		const auto lval = left(ctx);
+		const auto rval = right(ctx);
+		// zero divisors take the generic path, which raises the error
+		if (lval.type == rval.type) {
+			if (is_int(lval.type) && rval.i != 0) {
+				return RegisterValue(flx_int(is_div ? lval.i / rval.i : lval.i % rval.i));
+			}
+			if (is_float(lval.type) && is_div && int(rval.f) != 0) {
+				return RegisterValue(flx_float(lval.f / rval.f));
+			}
+		}
+		return generic_operation(ctx, pos, op, lval, rval);
+		};
+}
+
+static ClosureExpression untyped_division_closure(const std::string& op, ClosureExpression left, ClosureExpression right, CodePosition pos) {
+	const bool is_div = op == "/";
+	return [=](ClosureContext& ctx) {
+		const auto lval = left(ctx);
+		const auto rval = right(ctx);
+		if (is_div && is_int(lval.type) && is_int(rval.type) && rval.i != 0) {
+			return RegisterValue(flx_float(flx_float(lval.i) / flx_float(rval.i)));
+		}
+		if (is_div && lval.type == rval.type && is_float(lval.type) && int(rval.f) != 0) {
+			return RegisterValue(flx_float(lval.f / rval.f));
+		}
+		set_position(ctx, pos);
+		return ScalarOperations::untyped_division(op, lval, rval);
+		};
+}
+
+flx_int ClosureProgram::run() const {
+	ClosureContext ctx;
+	ctx.stack.assign(main_frame_size, RegisterValue());
+
+	try {
+		main(ctx);
+	}
+	catch (const ClosureExit& exit) {
+		return exit.code;
+	}
+	catch (const std::exception& ex) {
+		throw std::runtime_error("(CLS) " + name + '[' + std::to_string(ctx.row) + ':' + std::to_string(ctx.col) + "]: " + ex.what());
+	}
+	return 0;
+}
+
+ClosureCompiler::ClosureCompiler(std::shared_ptr<ASTProgramNode> main_program, std::map<std::string, std::shared_ptr<ASTProgramNode>> programs)
+	: Visitor(programs, main_program, default_namespace) {}
+
+bool ClosureCompiler::start() {
+	program.name = current_program.top()->name;
+
+	try {
+		ScalarSubset(main_program, programs).check();
+	}
+	catch (const ScalarUnsupportedError& ex) {
+		unsupported_reason = "(CCMP) " + std::string(ex.what()) + " is not supported by the closure engine";
+		return false;
+	}
+
+	declare_functions();
+
+	scopes.emplace_back();
+	visit(current_program.top());
+	program.main_frame_size = frame_size;
+
+	// the top level scope of the main program lives at the bottom of the stack
+	globals = scopes.front();
+	for (size_t i = 0; i < function_nodes.size(); ++i) {
+		compile_function(i);
+	}
+	return true;
+}
+
+void ClosureCompiler::declare_functions() {
+	for (const auto& statement : current_program.top()->statements) {
+		auto fun = std::dynamic_pointer_cast<ASTFunctionDefinitionNode>(statement);
+		if (!fun) {
+			continue;
+		}
+		auto function = std::make_unique<ClosureFunction>();
+		function->identifier = fun->identifier;
+		function->type = fun->type;
+		function->param_count = fun->parameters.size();
+
+		function_indexes[fun->identifier] = program.functions.size();
+		program.functions.push_back(std::move(function));
+		function_nodes.push_back(fun);
+	}
+}
+
+void ClosureCompiler::compile_function(size_t index) {
+	const auto& fun = function_nodes[index];
+	set_curr_pos(fun->row, fun->col);
+
+	current_function = index;
+	scopes.clear();
+	scopes.emplace_back();
+	locals_top = 0;
+	next_slot = 0;
+	frame_size = 0;
+
+	// arguments arrive in the first slots, typed ones are checked and normalized once on entry
+	std::vector<ClosureStatement> statements;
+	for (const auto param : fun->parameters) {
+		auto var = dynamic_cast<VariableDefinition*>(param);
+		auto slot = declare_local();
+		if (!is_any(var->type)) {
+			const auto type = var->type;
+			const CodePosition pos(fun->row, fun->col);
+			statements.push_back([slot, type, pos](ClosureContext& ctx) {
+				auto& value = ctx.stack[ctx.base + slot];
+				value = store(ctx, pos, value, type);
+				return CS_NEXT;
+				});
+		}
+		scopes.back()[var->identifier] = ClosureVariable{ slot, var->type, false };
+	}
+
+	statements.push_back(compile_statement(fun->block));
+
+	auto& function = *program.functions[index];
+	function.body = compile_block(statements);
+	function.frame_size = frame_size;
+	scopes.clear();
+}
+
+ClosureStatement ClosureCompiler::compile_statement(std::shared_ptr<ASTNode> statement) {
+	ClosureStatement result;
+
+	if (auto expr = std::dynamic_pointer_cast<ASTExprNode>(statement)) {
+		auto value = compile_expression(expr);
+		result = [value](ClosureContext& ctx) {
+			value(ctx);
+			return CS_NEXT;
+			};
+	}
+	else {
+		current_statement = nullptr;
+		statement->accept(this);
+		result = std::move(current_statement);
+	}
+
+	// argument slots only live for the statement that created them
+	next_slot = locals_top;
+	return result;
+}
+
+ClosureStatement ClosureCompiler::compile_block(const std::vector<ClosureStatement>& statements) {
+	std::vector<ClosureStatement> body;
+	for (const auto& statement : statements) {
+		if (statement) {
+			body.push_back(statement);
+		}
+	}
+
+	if (body.empty()) {
+		return [](ClosureContext&) { return CS_NEXT; };
+	}
+	if (body.size() == 1) {
+		return body.front();
+	}
+	return [body](ClosureContext& ctx) {
+		for (const auto& statement : body) {
+			const auto signal = statement(ctx);
+			if (signal != CS_NEXT) {
+				return signal;
+			}
+		}
+		return CS_NEXT;
+		};
+}
+
+ClosureExpression ClosureCompiler::compile_expression(std::shared_ptr<ASTExprNode> expr) {
+	current_untyped = false;
+	expr->accept(this);
+	return std::move(current_expression);
+}
+
+ClosureCondition ClosureCompiler::compile_condition(std::shared_ptr<ASTExprNode> condition) {
+	auto value = compile_expression(condition);
+	const CodePosition pos(condition->row, condition->col);
+	return [value, pos](ClosureContext& ctx) {
+		const auto result = value(ctx);
+		if (is_bool(result.type)) {
+			return result.b;
+		}
+		set_position(ctx, pos);
+		return ScalarOperations::condition(result);
+		};
+}
+
+ClosureExpression ClosureCompiler::compile_store(ClosureExpression expr, Type expr_type, Type variable_type) {
+	if (is_any(variable_type) || expr_type == variable_type) {
+		return expr;
+	}
+	const CodePosition pos(curr_row, curr_col);
+	return [expr, variable_type, pos](ClosureContext& ctx) {
+		return store(ctx, pos, expr(ctx), variable_type);
+		};
+}
+
+ClosureExpression ClosureCompiler::compile_assignment(const std::string& identifier, const std::string& op, std::shared_ptr<ASTExprNode> expr) {
+	bool is_global = false;
+	const auto variable = *find_variable(identifier, is_global);
+
+	ClosureExpression value;
+	if (op == "=") {
+		auto operand = compile_expression(expr);
+		value = compile_store(operand, current_type, variable.type);
+	}
+	else {
+		const auto bop = op.substr(0, op.size() - 1);
+		auto operand = compile_expression(expr);
+		auto type = ScalarSubset::result_type(bop, variable.type, current_type);
+		value = compile_store(binary_operation(bop, variable_read(variable.slot, is_global), operand, variable.untyped),
+			type, variable.type);
+	}
+
+	current_type = variable.type;
+	current_untyped = false;
+
+	// the value is computed first, calls in it may grow the stack
+	const auto slot = variable.slot;
+	if (is_global) {
+		return [value, slot](ClosureContext& ctx) {
+			const auto result = value(ctx);
+			ctx.stack[slot] = result;
+			return result;
+			};
+	}
+	return [value, slot](ClosureContext& ctx) {
+		const auto result = value(ctx);
+		ctx.stack[ctx.base + slot] = result;
+		return result;
+		};
+}
+
+ClosureExpression ClosureCompiler::binary_operation(const std::string& op, ClosureExpression left, ClosureExpression right, bool untyped) {
+	const CodePosition pos(curr_row, curr_col);
+
+	if (op == "+") {
+		return arithmetic_closure(op, left, right, pos, std::plus<>());
+	}
+	if (op == "-") {
+		return arithmetic_closure(op, left, right, pos, std::minus<>());
+	}
+	if (op == "*") {
+		return arithmetic_closure(op, left, right, pos, std::multiplies<>());
+	}
+	if (op == "/" || op == "/%") {
+		if (untyped) {
+			return untyped_division_closure(op, left, right, pos);
+		}
+		if (op == "/") {
+			return division_closure(op, left, right, pos);
+		}
+	}
+	if (op == "%") {
+		return division_closure(op, left, right, pos);
+	}
+	if (op == "==") {
+		return relational_closure(op, left, right, pos, std::equal_to<>());
+	}
+	if (op == "!=") {
+		return relational_closure(op, left, right, pos, std::not_equal_to<>());
+	}
+	if (op == "<") {
+		return relational_closure(op, left, right, pos, std::less<>());
+	}
+	if (op == "<=") {
+		return relational_closure(op, left, right, pos, std::less_equal<>());
+	}
+	if (op == ">") {
+		return relational_closure(op, left, right, pos, std::greater<>());
+	}
+	if (op == ">=") {
+		return relational_closure(op, left, right, pos, std::greater_equal<>());
+	}
+	if (op == "and" || op == "or") {
+		const bool is_and = op == "and";
+		return [left, right, op, pos, is_and](ClosureContext& ctx) {
+			const auto lval = left(ctx);
+			// the right side only runs when the left one is not false, like in the interpreter
+			if (is_and && is_bool(lval.type) && !lval.b) {
+				return lval;
+			}
+			const auto rval = right(ctx);
+			if (is_bool(lval.type) && is_bool(rval.type)) {
+				return RegisterValue(flx_bool(is_and ? lval.b && rval.b : lval.b || rval.b));
+			}
+			return generic_operation(ctx, pos, op, lval, rval);
+			};
+	}
+
+	return [left, right, op, pos](ClosureContext& ctx) {
+		const auto lval = left(ctx);
+		const auto rval = right(ctx);
+		return generic_operation(ctx, pos, op, lval, rval);
+		};
+}
+
+ClosureExpression ClosureCompiler::variable_read(size_t slot, bool is_global) {
+	if (is_global) {
+		return [slot](ClosureContext& ctx) { return ctx.stack[slot]; };
+	}
+	return [slot](ClosureContext& ctx) { return ctx.stack[ctx.base + slot]; };
+}
+
+size_t ClosureCompiler::alloc_slot() {
+	auto slot = next_slot++;
+	if (next_slot > frame_size) {
+		frame_size = next_slot;
+	}
+	return slot;
+}
+
+size_t ClosureCompiler::declare_local() {
+	next_slot = locals_top;
+	auto slot = alloc_slot();
+	locals_top = next_slot;
+	return slot;
+}
+
+const ClosureVariable* ClosureCompiler::find_variable(const std::string& identifier, bool& is_global) const {
+	for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+		auto var = it->find(identifier);
+		if (var != it->end()) {
+			is_global = false;
+			return &var->second;
+		}
+	}
+	if (current_function >= 0) {
+		auto var = globals.find(identifier);
+		if (var != globals.end()) {
+			is_global = true;
+			return &var->second;
+		}
+	}
+	return nullptr;
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTProgramNode> astnode) {
+	std::vector<ClosureStatement> statements;
+	for (const auto& statement : astnode->statements) {
+		statements.push_back(compile_statement(statement));
+	}
+	program.main = compile_block(statements);
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTUsingNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTNamespaceManagerNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTDeclarationNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	ClosureExpression value;
+	if (astnode->expr) {
+		auto operand = compile_expression(astnode->expr);
+		value = compile_store(operand, current_type, astnode->type);
+	}
+
+	auto slot = declare_local();
+	scopes.back()[astnode->identifier] = ClosureVariable{ slot, astnode->type, is_any(astnode->type) };
+
+	if (value) {
+		current_statement = [value, slot](ClosureContext& ctx) {
+			const auto result = value(ctx);
+			ctx.stack[ctx.base + slot] = result;
+			return CS_NEXT;
+			};
+	}
+	else {
+		current_statement = [slot](ClosureContext& ctx) {
+			ctx.stack[ctx.base + slot] = RegisterValue();
+			return CS_NEXT;
+			};
+	}
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTUnpackedDeclarationNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTAssignmentNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto assignment = compile_assignment(astnode->identifier, astnode->op, astnode->expr);
+	current_statement = [assignment](ClosureContext& ctx) {
+		assignment(ctx);
+		return CS_NEXT;
+		};
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTReturnNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	if (!astnode->expr) {
+		current_statement = [](ClosureContext& ctx) {
+			ctx.return_value = RegisterValue();
+			return CS_RETURN;
+			};
+		return;
+	}
+
+	const auto type = program.functions[current_function]->type;
+	auto value = compile_expression(astnode->expr);
+	if (!is_void(type)) {
+		value = compile_store(value, current_type, type);
+	}
+	current_statement = [value](ClosureContext& ctx) {
+		ctx.return_value = value(ctx);
+		return CS_RETURN;
+		};
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTExitNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto value = compile_expression(astnode->exit_code);
+	const CodePosition pos(astnode->row, astnode->col);
+	current_statement = [value, pos](ClosureContext& ctx) -> ClosureSignal {
+		const auto code = value(ctx);
+		if (!is_int(code.type)) {
+			set_position(ctx, pos);
+			throw std::runtime_error("expected int value");
+		}
+		throw ClosureExit{ code.i };
+		};
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTBlockNode> astnode) {
+	auto top = locals_top;
+	scopes.emplace_back();
+
+	std::vector<ClosureStatement> statements;
+	for (const auto& statement : astnode->statements) {
+		statements.push_back(compile_statement(statement));
+	}
+
+	scopes.pop_back();
+	locals_top = top;
+	next_slot = top;
+
+	current_statement = compile_block(statements);
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTContinueNode>) {
+	current_statement = [](ClosureContext&) { return CS_CONTINUE; };
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTBreakNode>) {
+	current_statement = [](ClosureContext&) { return CS_BREAK; };
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTSwitchNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTEnumNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTTryCatchNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTThrowNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTEllipsisNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTElseIfNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTIfNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	std::vector<std::pair<ClosureCondition, ClosureStatement>> branches;
+	auto condition = compile_condition(astnode->condition);
+	branches.emplace_back(condition, compile_statement(astnode->if_block));
+
+	for (const auto& else_if : astnode->else_ifs) {
+		set_curr_pos(else_if->row, else_if->col);
+		auto else_if_condition = compile_condition(else_if->condition);
+		branches.emplace_back(else_if_condition, compile_statement(else_if->block));
+	}
+
+	ClosureStatement else_block;
+	if (astnode->else_block) {
+		else_block = compile_statement(astnode->else_block);
+	}
+
+	if (branches.size() == 1) {
+		auto if_block = branches.front().second;
+		if (else_block) {
+			current_statement = [condition, if_block, else_block](ClosureContext& ctx) {
+				return condition(ctx) ? if_block(ctx) : else_block(ctx);
+				};
+		}
+		else {
+			current_statement = [condition, if_block](ClosureContext& ctx) {
+				return condition(ctx) ? if_block(ctx) : CS_NEXT;
+				};
+		}
+		return;
+	}
+
+	current_statement = [branches, else_block](ClosureContext& ctx) {
+		for (const auto& branch : branches) {
+			if (branch.first(ctx)) {
+				return branch.second(ctx);
+			}
+		}
+		return else_block ? else_block(ctx) : CS_NEXT;
+		};
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTForNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto top = locals_top;
+	scopes.emplace_back();
+
+	ClosureStatement init;
+	if (astnode->dci[0]) {
+		init = compile_statement(astnode->dci[0]);
+	}
+	ClosureCondition condition;
+	if (auto condition_expr = std::dynamic_pointer_cast<ASTExprNode>(astnode->dci[1])) {
+		condition = compile_condition(condition_expr);
+		next_slot = locals_top;
+	}
+	ClosureStatement step;
+	if (astnode->dci[2]) {
+		step = compile_statement(astnode->dci[2]);
+	}
+
+	auto block = compile_statement(astnode->block);
+
+	scopes.pop_back();
+	locals_top = top;
+	next_slot = top;
+
+	current_statement = [init, condition, step, block](ClosureContext& ctx) {
+		if (init) {
+			init(ctx);
+		}
+		while (!condition || condition(ctx)) {
+			const auto signal = block(ctx);
+			if (signal == CS_BREAK) {
+				break;
+			}
+			if (signal == CS_RETURN) {
+				return signal;
+			}
+			if (step) {
+				step(ctx);
+			}
+		}
+		return CS_NEXT;
+		};
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTForEachNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTWhileNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto condition = compile_condition(astnode->condition);
+	next_slot = locals_top;
+
+	auto block = compile_statement(astnode->block);
+
+	current_statement = [condition, block](ClosureContext& ctx) {
+		while (condition(ctx)) {
+			const auto signal = block(ctx);
+			if (signal == CS_BREAK) {
+				break;
+			}
+			if (signal == CS_RETURN) {
+				return signal;
+			}
+		}
+		return CS_NEXT;
+		};
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTDoWhileNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto block = compile_statement(astnode->block);
+
+	auto condition = compile_condition(astnode->condition);
+	next_slot = locals_top;
+
+	current_statement = [condition, block](ClosureContext& ctx) {
+		do {
+			const auto signal = block(ctx);
+			if (signal == CS_BREAK) {
+				break;
+			}
+			if (signal == CS_RETURN) {
+				return signal;
+			}
+		} while (condition(ctx));
+		return CS_NEXT;
+		};
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTFunctionDefinitionNode>) {
+	// top level functions are compiled after the main program
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTStructDefinitionNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTLiteralNode<flx_bool>> astnode) {
+	const RegisterValue value(astnode->val);
+	current_expression = [value](ClosureContext&) { return value; };
+	current_type = Type::T_BOOL;
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTLiteralNode<flx_int>> astnode) {
+	const RegisterValue value(astnode->val);
+	current_expression = [value](ClosureContext&) { return value; };
+	current_type = Type::T_INT;
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTLiteralNode<flx_float>> astnode) {
+	const RegisterValue value(astnode->val);
+	current_expression = [value](ClosureContext&) { return value; };
+	current_type = Type::T_FLOAT;
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTLiteralNode<flx_char>>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTLiteralNode<flx_string>>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTLambdaFunction>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTArrayConstructorNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTStructConstructorNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTBinaryExprNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto left = compile_expression(astnode->left);
+	auto ltype = current_type;
+	auto untyped = current_untyped;
+	auto right = compile_expression(astnode->right);
+	auto rtype = current_type;
+
+	current_expression = binary_operation(astnode->op, left, right, untyped);
+	current_type = ScalarSubset::result_type(astnode->op, ltype, rtype);
+	current_untyped = untyped && ScalarSubset::keeps_untyped(astnode->op);
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	const auto& op = astnode->unary_op;
+
+	if (op == "++" || op == "--") {
+		auto one = std::make_shared<ASTLiteralNode<flx_int>>(1, astnode->row, astnode->col);
+		auto id = std::dynamic_pointer_cast<ASTIdentifierNode>(astnode->expr);
+		if (id && id->name_space.empty() && id->identifier_vector.size() == 1 && id->identifier_vector[0].access_vector.empty()) {
+			current_expression = compile_assignment(id->identifier, std::string{ op[0] } + "=", one);
+		}
+		else {
+			auto operand = compile_expression(astnode->expr);
+			auto type = current_type;
+			auto bop = std::string{ op[0] };
+			current_expression = binary_operation(bop, operand, [](ClosureContext&) { return RegisterValue(flx_int(1)); }, false);
+			current_type = ScalarSubset::result_type(bop, type, Type::T_INT);
+		}
+		return;
+	}
+
+	auto operand = compile_expression(astnode->expr);
+	auto type = current_type;
+	const CodePosition pos(astnode->row, astnode->col);
+
+	if (op == "-") {
+		current_expression = [operand, pos](ClosureContext& ctx) {
+			const auto value = operand(ctx);
+			if (is_int(value.type)) {
+				return RegisterValue(flx_int(-value.i));
+			}
+			if (is_float(value.type)) {
+				return RegisterValue(flx_float(-value.f));
+			}
+			set_position(ctx, pos);
+			return ScalarOperations::unary("-", value);
+			};
+		current_type = type;
+	}
+	else if (op == "not") {
+		current_expression = [operand, pos](ClosureContext& ctx) {
+			const auto value = operand(ctx);
+			if (is_bool(value.type)) {
+				return RegisterValue(flx_bool(!value.b));
+			}
+			set_position(ctx, pos);
+			return ScalarOperations::unary("not", value);
+			};
+		current_type = Type::T_BOOL;
+	}
+	else {
+		current_expression = [operand, pos](ClosureContext& ctx) {
+			const auto value = operand(ctx);
+			if (is_int(value.type)) {
+				return RegisterValue(flx_int(~value.i));
+			}
+			set_position(ctx, pos);
+			return ScalarOperations::unary("~", value);
+			};
+		current_type = Type::T_ANY;
+	}
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	bool is_global = false;
+	auto variable = find_variable(astnode->identifier, is_global);
+
+	current_expression = variable_read(variable->slot, is_global);
+	current_type = variable->type;
+	current_untyped = variable->untyped;
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTTernaryNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto condition = compile_condition(astnode->condition);
+	auto value_if_true = compile_expression(astnode->value_if_true);
+	auto true_type = current_type;
+	auto value_if_false = compile_expression(astnode->value_if_false);
+
+	current_expression = [condition, value_if_true, value_if_false](ClosureContext& ctx) {
+		return condition(ctx) ? value_if_true(ctx) : value_if_false(ctx);
+		};
+	current_type = true_type == current_type ? true_type : Type::T_ANY;
+	current_untyped = false;
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTInNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	const auto& identifier = astnode->identifier;
+	auto it = function_indexes.find(identifier);
+
+	if (it == function_indexes.end()) {
+		// string literals are converted once, other arguments when printed
+		std::vector<std::pair<std::string, ClosureExpression>> arguments;
+		for (const auto& param : astnode->parameters) {
+			if (auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_string>>(param)) {
+				RuntimeValue value(literal->val);
+				arguments.emplace_back(RuntimeOperations::parse_value_to_string(&value), nullptr);
+			}
+			else {
+				arguments.emplace_back("", compile_expression(param));
+			}
+		}
+
+		const bool new_line = identifier == "println";
+		current_expression = [arguments, new_line](ClosureContext& ctx) {
+			for (const auto& argument : arguments) {
+				if (argument.second) {
+					std::cout << ScalarOperations::to_string(argument.second(ctx));
+				}
+				else {
+					std::cout << argument.first;
+				}
+			}
+			if (new_line) {
+				std::cout << std::endl;
+			}
+			return RegisterValue();
+			};
+		current_type = Type::T_ANY;
+		current_untyped = false;
+		return;
+	}
+
+	const auto function = program.functions[it->second].get();
+
+	// arguments take consecutive slots, the callee frame starts at the first one
+	const auto first = next_slot;
+	for (size_t i = 0; i < astnode->parameters.size(); ++i) {
+		alloc_slot();
+	}
+	std::vector<ClosureExpression> arguments;
+	for (const auto& param : astnode->parameters) {
+		arguments.push_back(compile_expression(param));
+	}
+
+	current_expression = [arguments, first, function](ClosureContext& ctx) {
+		for (size_t i = 0; i < arguments.size(); ++i) {
+			const auto value = arguments[i](ctx);
+			ctx.stack[ctx.base + first + i] = value;
+		}
+
+		const auto base = ctx.base;
+		ctx.base += first;
+		if (ctx.stack.size() < ctx.base + function->frame_size) {
+			ctx.stack.resize(ctx.base + function->frame_size);
+		}
+
+		ctx.return_value = RegisterValue();
+		function->body(ctx);
+		ctx.base = base;
+
+		return ctx.return_value;
+		};
+	current_type = function->type;
+	current_untyped = false;
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTTypeCastNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto operand = compile_expression(astnode->expr);
+	const auto type = astnode->type;
+	current_expression = [operand, type](ClosureContext& ctx) {
+		return ScalarOperations::cast(operand(ctx), type);
+		};
+	current_type = type;
+	current_untyped = false;
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTNullNode>) {
+	const auto value = RegisterValue::null();
+	current_expression = [value](ClosureContext&) { return value; };
+	current_type = Type::T_VOID;
+}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTThisNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTTypingNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTValueNode>) {}
+
+void ClosureCompiler::visit(std::shared_ptr<ASTBuiltinCallNode>) {}
+
+long long ClosureCompiler::hash(std::shared_ptr<ASTExprNode>) { return 0; }
+long long ClosureCompiler::hash(std::shared_ptr<ASTValueNode>) { return 0; }
+long long ClosureCompiler::hash(std::shared_ptr<ASTLiteralNode<flx_bool>>) { return 0; }
+long long ClosureCompiler::hash(std::shared_ptr<ASTLiteralNode<flx_int>>) { return 0; }
+long long ClosureCompiler::hash(std::shared_ptr<ASTLiteralNode<flx_float>>) { return 0; }
+long long ClosureCompiler::hash(std::shared_ptr<ASTLiteralNode<flx_char>>) { return 0; }
+long long ClosureCompiler::hash(std::shared_ptr<ASTLiteralNode<flx_string>>) { return 0; }
+long long ClosureCompiler::hash(std::shared_ptr<ASTIdentifierNode>) { return 0; }
+
+void ClosureCompiler::set_curr_pos(unsigned int row, unsigned int col) {
+	curr_row = row;
+	curr_col = col;
+}
+
+std::string ClosureCompiler::msg_header() {
+	return "(CCMP) " + current_program.top()->name + '[' + std::to_string(curr_row) + ':' + std::to_string(curr_col) + "]: ";
+}
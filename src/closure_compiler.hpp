@@ -0,0 +1,186 @@
+#ifndef CLOSURE_COMPILER_HPP
+#define CLOSURE_COMPILER_HPP
+
+#include <memory>
+#include <map>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+#include "register_bytecode.hpp"
+#include "ast.hpp"
+
+using namespace visitor;
+using namespace parser;
+using namespace vm;
+
+namespace visitor {
+
+	// thrown by exit statements and caught when the program finishes
+	class ClosureExit {
+	public:
+		flx_int code;
+	};
+
+	// running state, every call gets a window of the stack starting at its first argument
+	class ClosureContext {
+	public:
+		std::vector<RegisterValue> stack;
+		size_t base = 0;
+		RegisterValue return_value;
+		// position of the failing node, only set on error paths
+		unsigned int row = 0;
+		unsigned int col = 0;
+	};
+
+	// how a statement leaves, blocks stop at the first statement that does not fall through
+	enum ClosureSignal : uint8_t {
+		CS_NEXT,
+		CS_BREAK,
+		CS_CONTINUE,
+		CS_RETURN
+	};
+
+	typedef std::function<RegisterValue(ClosureContext&)> ClosureExpression;
+	typedef std::function<ClosureSignal(ClosureContext&)> ClosureStatement;
+	typedef std::function<bool(ClosureContext&)> ClosureCondition;
+
+	class ClosureFunction {
+	public:
+		std::string identifier;
+		Type type;
+		size_t param_count = 0;
+		size_t frame_size = 0;
+		ClosureStatement body;
+	};
+
+	class ClosureProgram {
+	public:
+		std::string name;
+		ClosureStatement main;
+		size_t main_frame_size = 0;
+		// heap allocated so call closures can keep pointers to their functions
+		std::vector<std::unique_ptr<ClosureFunction>> functions;
+
+		// returns the exit code of the program
+		flx_int run() const;
+	};
+
+	class ClosureVariable {
+	public:
+		size_t slot;
+		Type type;
+		bool untyped;
+	};
+
+	// converts programs inside the scalar subset once into a tree of closures, each closure returns its value
+	// directly and has its variable slots and operations bound when it is built
+	class ClosureCompiler : public Visitor {
+	public:
+		ClosureProgram program;
+		// why the program could not be compiled, empty on success
+		std::string unsupported_reason;
+
+	private:
+		std::vector<std::unordered_map<std::string, ClosureVariable>> scopes;
+		std::unordered_map<std::string, ClosureVariable> globals;
+		std::unordered_map<std::string, size_t> function_indexes;
+		std::vector<std::shared_ptr<ASTFunctionDefinitionNode>> function_nodes;
+		long long current_function = -1;
+
+		size_t locals_top = 0;
+		size_t next_slot = 0;
+		size_t frame_size = 0;
+
+		// result of the last visited node
+		ClosureExpression current_expression;
+		ClosureStatement current_statement;
+		Type current_type = Type::T_ANY;
+		// whether the value still refers to an untyped variable, which changes '/' and '/%'
+		bool current_untyped = false;
+
+	private:
+		void declare_functions();
+		void compile_function(size_t index);
+		ClosureStatement compile_statement(std::shared_ptr<ASTNode> statement);
+		ClosureStatement compile_block(const std::vector<ClosureStatement>& statements);
+		ClosureExpression compile_expression(std::shared_ptr<ASTExprNode> expr);
+		ClosureCondition compile_condition(std::shared_ptr<ASTExprNode> condition);
+		ClosureExpression compile_store(ClosureExpression expr, Type expr_type, Type variable_type);
+		ClosureExpression compile_assignment(const std::string& identifier, const std::string& op, std::shared_ptr<ASTExprNode> expr);
+		ClosureExpression binary_operation(const std::string& op, ClosureExpression left, ClosureExpression right, bool untyped);
+
+		static ClosureExpression variable_read(size_t slot, bool is_global);
+
+		size_t alloc_slot();
+		size_t declare_local();
+
+		const ClosureVariable* find_variable(const std::string& identifier, bool& is_global) const;
+
+		void set_curr_pos(unsigned int row, unsigned int col) override;
+		std::string msg_header() override;
+
+	public:
+		ClosureCompiler(std::shared_ptr<ASTProgramNode> main_program, std::map<std::string, std::shared_ptr<ASTProgramNode>> programs);
+		~ClosureCompiler() = default;
+
+		// returns false when the program uses something outside the supported subset
+		bool start();
+
+		void visit(std::shared_ptr<ASTProgramNode>) override;
+		void visit(std::shared_ptr<ASTUsingNode>) override;
+		void visit(std::shared_ptr<ASTNamespaceManagerNode>) override;
+		void visit(std::shared_ptr<ASTDeclarationNode>) override;
+		void visit(std::shared_ptr<ASTUnpackedDeclarationNode>) override;
+		void visit(std::shared_ptr<ASTAssignmentNode>) override;
+		void visit(std::shared_ptr<ASTReturnNode>) override;
+		void visit(std::shared_ptr<ASTExitNode>) override;
+		void visit(std::shared_ptr<ASTBlockNode>) override;
+		void visit(std::shared_ptr<ASTContinueNode>) override;
+		void visit(std::shared_ptr<ASTBreakNode>) override;
+		void visit(std::shared_ptr<ASTSwitchNode>) override;
+		void visit(std::shared_ptr<ASTEnumNode>) override;
+		void visit(std::shared_ptr<ASTTryCatchNode>) override;
+		void visit(std::shared_ptr<ASTThrowNode>) override;
+		void visit(std::shared_ptr<ASTEllipsisNode>) override;
+		void visit(std::shared_ptr<ASTElseIfNode>) override;
+		void visit(std::shared_ptr<ASTIfNode>) override;
+		void visit(std::shared_ptr<ASTForNode>) override;
+		void visit(std::shared_ptr<ASTForEachNode>) override;
+		void visit(std::shared_ptr<ASTWhileNode>) override;
+		void visit(std::shared_ptr<ASTDoWhileNode>) override;
+		void visit(std::shared_ptr<ASTFunctionDefinitionNode>) override;
+		void visit(std::shared_ptr<ASTStructDefinitionNode>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_bool>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_int>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_float>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_char>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_string>>) override;
+		void visit(std::shared_ptr<ASTLambdaFunction>) override;
+		void visit(std::shared_ptr<ASTArrayConstructorNode>) override;
+		void visit(std::shared_ptr<ASTStructConstructorNode>) override;
+		void visit(std::shared_ptr<ASTBinaryExprNode>) override;
+		void visit(std::shared_ptr<ASTUnaryExprNode>) override;
+		void visit(std::shared_ptr<ASTIdentifierNode>) override;
+		void visit(std::shared_ptr<ASTTernaryNode>) override;
+		void visit(std::shared_ptr<ASTInNode>) override;
+		void visit(std::shared_ptr<ASTFunctionCallNode>) override;
+		void visit(std::shared_ptr<ASTTypeCastNode>) override;
+		void visit(std::shared_ptr<ASTNullNode>) override;
+		void visit(std::shared_ptr<ASTThisNode>) override;
+		void visit(std::shared_ptr<ASTTypingNode>) override;
+		void visit(std::shared_ptr<ASTValueNode>) override;
+		void visit(std::shared_ptr<ASTBuiltinCallNode>) override;
+
+		long long hash(std::shared_ptr<ASTExprNode>) override;
+		long long hash(std::shared_ptr<ASTValueNode>) override;
+		long long hash(std::shared_ptr<ASTIdentifierNode>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_bool>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_int>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_float>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_char>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_string>>) override;
+	};
+}
+
+#endif // !CLOSURE_COMPILER_HPP
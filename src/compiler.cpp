@@ -141,7 +141,23 @@ void Compiler::visit(std::shared_ptr<ASTAssignmentNode> astnode) {
 }
 
 void Compiler::visit(std::shared_ptr<ASTReturnNode> astnode) {
-	if (astnode->expr) {
+	const auto call = std::dynamic_pointer_cast<ASTFunctionCallNode>(astnode->expr);
+
+	if (call && call->is_tail_call) {
+		auto pop = push_namespace(flx_string(call->name_space));
+
+		for (const auto& param : call->parameters) {
+			param->accept(this);
+		}
+
+		add_instruction(OpCode::OP_CALL_PARAM_COUNT, call->parameters.size());
+
+		// user functions continue in the frame of this one, builtins return here
+		add_instruction(OpCode::OP_TAIL_CALL, flx_string(call->identifier));
+
+		pop_namespace(pop);
+	}
+	else if (astnode->expr) {
 		astnode->expr->accept(this);
 	}
 	else {
@@ -191,6 +207,12 @@ void Compiler::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode) {
 		// at this point, vm will jump to OP_FUN_END
 		auto id = add_instruction(OpCode::OP_JUMP, nullptr);
 
+		const auto body_start = pointer;
+		const auto outer_try_depth = try_depth;
+		const auto outer_value_stack_depth = value_stack_depth;
+		try_depth = 0;
+		value_stack_depth = 0;
+
 		for (auto& param : astnode->parameters) {
 			const auto& var = *dynamic_cast<VariableDefinition*>(param);
 			if (var.default_value) {
@@ -206,6 +228,15 @@ void Compiler::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode) {
 		// it will return to prev
 		add_instruction(OpCode::OP_RETURN, nullptr);
 
+		try_depth = outer_try_depth;
+		value_stack_depth = outer_value_stack_depth;
+
+		// the body is laid out inside the enclosing try block, but its throws belong to the caller
+		if (try_depth > 0) {
+			exception_table.push_back(ExceptionTableEntry{ uint32_t(body_start), uint32_t(pointer),
+				ExceptionTableEntry::no_handler, 0 });
+		}
+
 		replace_last_operand(id, pointer);
 	}
 
@@ -246,7 +277,7 @@ void Compiler::visit(std::shared_ptr<ASTSwitchNode> astnode) {
 
 		for (const auto& [key, value] : astnode->parsed_case_blocks) {
 			if (i == value) {
-				add_instruction(OpCode::OP_PUSH_INT, size_t(key));
+				add_instruction(OpCode::OP_PUSH_INT, flx_int(key));
 				ip = add_instruction(OpCode::OP_JUMP_IF_FALSE_OR_NEXT, nullptr);
 			}
 		}
@@ -328,7 +359,10 @@ void Compiler::visit(std::shared_ptr<ASTForEachNode> astnode) {
 		add_instruction(OpCode::OP_STORE_VAR, flx_string(idnode->identifier));
 	}
 
+	// the iterator stays on the stack while the block runs
+	++value_stack_depth;
 	astnode->block->accept(this);
+	--value_stack_depth;
 
 	add_instruction(OpCode::OP_NEXT_ELEMENT, nullptr);
 
@@ -336,24 +370,45 @@ void Compiler::visit(std::shared_ptr<ASTForEachNode> astnode) {
 }
 
 void Compiler::visit(std::shared_ptr<ASTTryCatchNode> astnode) {
-	add_instruction(OpCode::OP_TRY_START, nullptr);
+	set_curr_pos(astnode->row, astnode->col);
 
-	astnode->try_block->accept(this);
+	// nothing runs on entering the block, throws find their handler in the exception table
+	ExceptionTableEntry entry{ uint32_t(pointer), 0, 0, uint32_t(value_stack_depth) };
 
-	add_instruction(OpCode::OP_TRY_END, nullptr);
+	++try_depth;
+	astnode->try_block->accept(this);
+	--try_depth;
 
-	auto ip = add_instruction(OpCode::OP_JUMP_IF_TRUE, nullptr);
+	auto ip = add_instruction(OpCode::OP_JUMP, nullptr);
 
-	astnode->decl->accept(this);
+	entry.end = uint32_t(ip);
+	entry.target = uint32_t(pointer);
+	exception_table.push_back(entry);
 
+	// the vm pushes the error message before jumping here
 	if (const auto idnode = std::dynamic_pointer_cast<ASTUnpackedDeclarationNode>(astnode->decl)) {
-		for (auto decl : idnode->declarations) {
-			add_instruction(OpCode::OP_STORE_VAR, flx_string(decl->identifier));
+		if (idnode->declarations.size() != 1) {
+			throw std::runtime_error(msg_header() + "invalid number of values");
 		}
+		const auto& decl = idnode->declarations[0];
+		type_definition_operations(*decl);
+		add_instruction(OpCode::OP_STORE_VAR, flx_string(decl->identifier));
 	}
 	else if (const auto idnode = std::dynamic_pointer_cast<ASTDeclarationNode>(astnode->decl)) {
+		auto pop = push_namespace(language_namespace);
+		add_instruction(OpCode::OP_INIT_STRUCT, flx_string("Exception"));
+		add_instruction(OpCode::OP_SET_FIELD, flx_string("error"));
+		add_instruction(OpCode::OP_PUSH_INT, flx_int(0));
+		add_instruction(OpCode::OP_SET_FIELD, flx_string("code"));
+		add_instruction(OpCode::OP_PUSH_STRUCT, nullptr);
+		pop_namespace(pop);
+
+		type_definition_operations(*idnode);
 		add_instruction(OpCode::OP_STORE_VAR, flx_string(idnode->identifier));
 	}
+	else {
+		add_instruction(OpCode::OP_POP_CONSTANT, nullptr);
+	}
 
 	astnode->catch_block->accept(this);
 
@@ -525,7 +580,7 @@ void Compiler::visit(std::shared_ptr<ASTBinaryExprNode> astnode) {
 		op = OpCode::OP_EXP;
 	}
 
-	add_instruction(op, nullptr);
+	add_instruction(specialize_operation(op, astnode->operand_type), nullptr);
 }
 
 void Compiler::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
@@ -621,6 +676,37 @@ bool Compiler::has_sub_value(std::vector<Identifier> identifier_vector) {
 	return identifier_vector.size() > 1 || identifier_vector[0].access_vector.size() > 0;
 }
 
+OpCode Compiler::specialize_operation(OpCode op, Type operand_type) {
+	if (!is_int(operand_type) && !is_float(operand_type)) {
+		return op;
+	}
+
+	bool int_operation = is_int(operand_type);
+
+	switch (op) {
+	case OpCode::OP_EQL:
+		return int_operation ? OpCode::OP_EQL_INT : OpCode::OP_EQL_FLOAT;
+	case OpCode::OP_DIF:
+		return int_operation ? OpCode::OP_DIF_INT : OpCode::OP_DIF_FLOAT;
+	case OpCode::OP_LT:
+		return int_operation ? OpCode::OP_LT_INT : OpCode::OP_LT_FLOAT;
+	case OpCode::OP_LTE:
+		return int_operation ? OpCode::OP_LTE_INT : OpCode::OP_LTE_FLOAT;
+	case OpCode::OP_GT:
+		return int_operation ? OpCode::OP_GT_INT : OpCode::OP_GT_FLOAT;
+	case OpCode::OP_GTE:
+		return int_operation ? OpCode::OP_GTE_INT : OpCode::OP_GTE_FLOAT;
+	case OpCode::OP_ADD:
+		return int_operation ? OpCode::OP_ADD_INT : OpCode::OP_ADD_FLOAT;
+	case OpCode::OP_SUB:
+		return int_operation ? OpCode::OP_SUB_INT : OpCode::OP_SUB_FLOAT;
+	case OpCode::OP_MUL:
+		return int_operation ? OpCode::OP_MUL_INT : OpCode::OP_MUL_FLOAT;
+	default:
+		return op;
+	}
+}
+
 void Compiler::type_definition_operations(TypeDefinition type) {
 	if (type.dim.size() > 0) {
 		add_instruction(OpCode::OP_SET_TYPE, uint8_t(Type::T_ARRAY));
@@ -677,14 +763,49 @@ void Compiler::access_sub_value_operations(std::vector<Identifier> identifier_ve
 template <typename T>
 size_t Compiler::add_instruction(OpCode opcode, T operand) {
 	auto ins_pointer = pointer;
-	bytecode_program.push_back(BytecodeInstruction(opcode, operand));
+	bytecode_program.push_back(BytecodeInstruction(opcode, to_operand(operand)));
 	++pointer;
 	return ins_pointer;
 }
 
 template <typename T>
 void Compiler::replace_last_operand(size_t pos, T operand) {
-	bytecode_program[pos].operand = BytecodeInstruction::to_byteopnd(operand);
+	bytecode_program[pos].operand = to_operand(operand);
+}
+
+uint32_t Compiler::to_operand(std::nullptr_t) {
+	return 0;
+}
+
+uint32_t Compiler::to_operand(uint8_t operand) {
+	return operand;
+}
+
+uint32_t Compiler::to_operand(size_t operand) {
+	if (operand > UINT32_MAX) {
+		throw std::runtime_error("operand exceeds the instruction limit");
+	}
+	return uint32_t(operand);
+}
+
+uint32_t Compiler::to_operand(flx_bool operand) {
+	return operand;
+}
+
+uint32_t Compiler::to_operand(flx_int operand) {
+	return constant_pool.add_int(operand);
+}
+
+uint32_t Compiler::to_operand(flx_float operand) {
+	return constant_pool.add_float(operand);
+}
+
+uint32_t Compiler::to_operand(flx_char operand) {
+	return uint8_t(operand);
+}
+
+uint32_t Compiler::to_operand(const flx_string& operand) {
+	return constant_pool.add_string(operand);
 }
 
 void Compiler::build_args(const std::vector<std::string>& args) {
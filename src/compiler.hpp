@@ -21,12 +21,17 @@ namespace visitor {
 	class Compiler : public Visitor, public NamespaceManager {
 	public:
 		std::vector<BytecodeInstruction> bytecode_program;
+		ConstantPool constant_pool;
+		std::vector<ExceptionTableEntry> exception_table;
 		std::map<std::string, std::shared_ptr<ASTExprNode>> builtin_functions;
 
 	private:
 		size_t pointer = 0;
 		std::stack<size_t> deviation_stack;
 		std::vector<std::string> parsed_libs;
+		// try blocks being compiled and values kept on the stack by the enclosing statements of the function
+		size_t try_depth = 0;
+		size_t value_stack_depth = 0;
 
 	private:
 		template <typename T>
@@ -34,7 +39,17 @@ namespace visitor {
 		template <typename T>
 		void replace_last_operand(size_t pos, T operand);
 
+		uint32_t to_operand(std::nullptr_t);
+		uint32_t to_operand(uint8_t operand);
+		uint32_t to_operand(size_t operand);
+		uint32_t to_operand(flx_bool operand);
+		uint32_t to_operand(flx_int operand);
+		uint32_t to_operand(flx_float operand);
+		uint32_t to_operand(flx_char operand);
+		uint32_t to_operand(const flx_string& operand);
+
 		void type_definition_operations(TypeDefinition type);
+		static OpCode specialize_operation(OpCode op, Type operand_type);
 		void access_sub_value_operations(std::vector<Identifier> identifier_vector);
 
 		bool has_sub_value(std::vector<Identifier> identifier_vector);
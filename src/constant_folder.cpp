@@ -0,0 +1,554 @@
+#include "constant_folder.hpp"
+#include "utils.hpp"
+
+using namespace visitor;
+using namespace parser;
+
+static dim_eval_func_t evaluate_access_vector_ptr = [](const std::vector<std::shared_ptr<ASTExprNode>>&) {
+	return std::vector<unsigned int>();
+	};
+
+ConstantFolder::ConstantFolder(std::shared_ptr<ASTProgramNode> main_program, const std::map<std::string, std::shared_ptr<ASTProgramNode>>& programs)
+	: Visitor(programs, main_program, main_program->name) {}
+
+void ConstantFolder::start() {
+	visit(current_program.top());
+}
+
+void ConstantFolder::fold(std::shared_ptr<ASTExprNode>& expr) {
+	if (!expr) {
+		return;
+	}
+
+	expr->accept(this);
+
+	if (folded_expression) {
+		expr = folded_expression;
+		folded_expression = nullptr;
+	}
+}
+
+void ConstantFolder::fold(std::shared_ptr<ASTNode>& node) {
+	if (auto expr = std::dynamic_pointer_cast<ASTExprNode>(node)) {
+		fold(expr);
+		node = expr;
+	}
+	else if (node) {
+		node->accept(this);
+		folded_statement = nullptr;
+		remove_statement = false;
+	}
+}
+
+void ConstantFolder::fold(std::vector<Identifier>& identifier_vector) {
+	for (auto& identifier : identifier_vector) {
+		for (auto& access : identifier.access_vector) {
+			fold(access);
+		}
+	}
+}
+
+void ConstantFolder::fold_statements(std::vector<std::shared_ptr<ASTNode>>& statements, bool keep_positions) {
+	for (size_t i = 0; i < statements.size();) {
+		auto statement = statements[i];
+		statement->accept(this);
+
+		auto replacement = folded_statement;
+		auto remove = remove_statement;
+		auto expression = folded_expression;
+		folded_expression = nullptr;
+		folded_statement = nullptr;
+		remove_statement = false;
+
+		if (remove && !keep_positions) {
+			statements.erase(statements.begin() + i);
+			continue;
+		}
+
+		if (remove) {
+			// switch cases refer to statements by position
+			replacement = std::make_shared<ASTBlockNode>(std::vector<std::shared_ptr<ASTNode>>(), statement->row, statement->col);
+		}
+		if (replacement) {
+			statements[i] = replacement;
+		}
+		else if (expression) {
+			statements[i] = expression;
+		}
+		++i;
+	}
+}
+
+void ConstantFolder::declare_variable(const std::string& identifier, std::shared_ptr<ASTExprNode> constant) {
+	scopes.back()[identifier] = constant;
+}
+
+std::shared_ptr<ASTExprNode> ConstantFolder::find_constant(const std::string& identifier) const {
+	for (auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope) {
+		const auto it = scope->find(identifier);
+		if (it != scope->end()) {
+			return it->second;
+		}
+	}
+	return nullptr;
+}
+
+std::shared_ptr<ASTExprNode> ConstantFolder::constant_literal(ASTDeclarationNode& declaration) const {
+	if (!declaration.is_const || !declaration.dim.empty()) {
+		return nullptr;
+	}
+
+	std::unique_ptr<RuntimeValue> value(literal_value(declaration.expr));
+	if (!value) {
+		return nullptr;
+	}
+
+	RuntimeOperations::normalize_type(&declaration, value.get());
+
+	// reads of untyped int variables divide as floats, so only their literals can't replace them
+	if (is_any(declaration.type) ? is_int(value->type) : value->type != declaration.type) {
+		return nullptr;
+	}
+
+	return make_literal(value.get(), declaration.row, declaration.col);
+}
+
+RuntimeValue* ConstantFolder::literal_value(const std::shared_ptr<ASTExprNode>& expr) {
+	if (const auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_bool>>(expr)) {
+		return new RuntimeValue(literal->val);
+	}
+	if (const auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_int>>(expr)) {
+		return new RuntimeValue(literal->val);
+	}
+	if (const auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_float>>(expr)) {
+		return new RuntimeValue(literal->val);
+	}
+	if (const auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_char>>(expr)) {
+		return new RuntimeValue(literal->val);
+	}
+	if (const auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_string>>(expr)) {
+		return new RuntimeValue(literal->val);
+	}
+	return nullptr;
+}
+
+std::shared_ptr<ASTExprNode> ConstantFolder::make_literal(const RuntimeValue* value, unsigned int row, unsigned int col) {
+	switch (value->type) {
+	case Type::T_BOOL:
+		return std::make_shared<ASTLiteralNode<flx_bool>>(value->get_b(), row, col);
+	case Type::T_INT:
+		return std::make_shared<ASTLiteralNode<flx_int>>(value->get_i(), row, col);
+	case Type::T_FLOAT:
+		return std::make_shared<ASTLiteralNode<flx_float>>(value->get_f(), row, col);
+	case Type::T_CHAR:
+		return std::make_shared<ASTLiteralNode<flx_char>>(value->get_c(), row, col);
+	case Type::T_STRING:
+		return std::make_shared<ASTLiteralNode<flx_string>>(value->get_s(), row, col);
+	default:
+		return nullptr;
+	}
+}
+
+bool ConstantFolder::is_bool_literal(const std::shared_ptr<ASTExprNode>& expr, bool value) {
+	const auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_bool>>(expr);
+	return literal && literal->val == value;
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTProgramNode> astnode) {
+	// every program starts with its own constants
+	auto outer_scopes = std::move(scopes);
+	scopes.assign(1, {});
+
+	fold_statements(astnode->statements, false);
+
+	scopes = std::move(outer_scopes);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTUsingNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	std::string libname = utils::StringUtils::join(astnode->library, ".");
+	const auto program = programs.find(libname);
+
+	if (program == programs.end() || utils::CollectionUtils::contains(parsed_libs, libname)) {
+		return;
+	}
+
+	parsed_libs.push_back(libname);
+	current_program.push(program->second);
+	visit(program->second);
+	current_program.pop();
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTNamespaceManagerNode>) {
+	// variables of other namespaces may hide the constants from here on
+	for (auto& scope : scopes) {
+		for (auto& variable : scope) {
+			variable.second = nullptr;
+		}
+	}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTDeclarationNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->expr);
+	declare_variable(astnode->identifier, constant_literal(*astnode));
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTUnpackedDeclarationNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->expr);
+	for (const auto& declaration : astnode->declarations) {
+		declare_variable(declaration->identifier);
+	}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTAssignmentNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->identifier_vector);
+	fold(astnode->expr);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTReturnNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->expr);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTExitNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->exit_code);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTBlockNode> astnode) {
+	scopes.emplace_back();
+	fold_statements(astnode->statements, false);
+	scopes.pop_back();
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTContinueNode>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTBreakNode>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTSwitchNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	// case values are keys of the case blocks and stay as written
+	fold(astnode->condition);
+	fold_statements(astnode->statements, true);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTEnumNode> astnode) {
+	for (size_t i = 0; i < astnode->identifiers.size(); ++i) {
+		declare_variable(astnode->identifiers[i], std::make_shared<ASTLiteralNode<flx_int>>(flx_int(i), astnode->row, astnode->col));
+	}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTTryCatchNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	visit(astnode->try_block);
+
+	scopes.emplace_back();
+	astnode->decl->accept(this);
+	visit(astnode->catch_block);
+	scopes.pop_back();
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTThrowNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->error);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTEllipsisNode>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTElseIfNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->condition);
+	visit(astnode->block);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTIfNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->condition);
+	visit(astnode->if_block);
+	for (const auto& elif : astnode->else_ifs) {
+		visit(elif);
+	}
+	if (astnode->else_block) {
+		visit(astnode->else_block);
+	}
+
+	// else ifs that never run are dropped, and one that always runs becomes the else block
+	auto& else_ifs = astnode->else_ifs;
+	for (size_t i = 0; i < else_ifs.size();) {
+		if (is_bool_literal(else_ifs[i]->condition, true)) {
+			astnode->else_block = else_ifs[i]->block;
+			else_ifs.erase(else_ifs.begin() + i, else_ifs.end());
+		}
+		else if (is_bool_literal(else_ifs[i]->condition, false)) {
+			else_ifs.erase(else_ifs.begin() + i);
+		}
+		else {
+			++i;
+		}
+	}
+
+	if (is_bool_literal(astnode->condition, false) && !else_ifs.empty()) {
+		astnode->condition = else_ifs.front()->condition;
+		astnode->if_block = else_ifs.front()->block;
+		else_ifs.erase(else_ifs.begin());
+	}
+
+	// the block that runs keeps its own scope
+	if (is_bool_literal(astnode->condition, true)) {
+		folded_statement = astnode->if_block;
+	}
+	else if (is_bool_literal(astnode->condition, false)) {
+		folded_statement = astnode->else_block;
+		remove_statement = !astnode->else_block;
+	}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTForNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	scopes.emplace_back();
+	for (auto& node : astnode->dci) {
+		fold(node);
+	}
+	visit(astnode->block);
+	scopes.pop_back();
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTForEachNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->collection);
+
+	scopes.emplace_back();
+	astnode->itdecl->accept(this);
+	visit(astnode->block);
+	scopes.pop_back();
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTWhileNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->condition);
+	visit(astnode->block);
+
+	remove_statement = is_bool_literal(astnode->condition, false);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTDoWhileNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	// the body always runs once, and its break and continue belong to the loop
+	fold(astnode->condition);
+	visit(astnode->block);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	if (!astnode->block) {
+		return;
+	}
+
+	// functions see the variables of their callers, which may hide the constants around the definition
+	auto outer_scopes = std::move(scopes);
+	scopes.assign(1, {});
+
+	visit(astnode->block);
+
+	scopes = std::move(outer_scopes);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTStructDefinitionNode>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTLiteralNode<flx_bool>>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTLiteralNode<flx_int>>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTLiteralNode<flx_float>>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTLiteralNode<flx_char>>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTLiteralNode<flx_string>>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTLambdaFunction> astnode) {
+	astnode->fun->accept(this);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTArrayConstructorNode> astnode) {
+	for (auto& value : astnode->values) {
+		fold(value);
+	}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTStructConstructorNode> astnode) {
+	for (auto& value : astnode->values) {
+		fold(value.second);
+	}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTBinaryExprNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->left);
+	fold(astnode->right);
+
+	std::unique_ptr<RuntimeValue> left(literal_value(astnode->left));
+	std::unique_ptr<RuntimeValue> right(literal_value(astnode->right));
+	if (!left || !right) {
+		return;
+	}
+
+	// evaluated like the interpreter does, operations that fail are left to fail when they run
+	try {
+		auto res = RuntimeOperations::do_operation(astnode->op, left.get(), right.get(), evaluate_access_vector_ptr, true);
+		// the result is either one of the operands updated in place or a new value
+		std::unique_ptr<RuntimeValue> created(res != left.get() && res != right.get() ? res : nullptr);
+
+		folded_expression = make_literal(res, astnode->row, astnode->col);
+	}
+	catch (const std::exception&) {}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	const auto& op = astnode->unary_op;
+
+	// operands of references and increments are variables, not values
+	if (op == "ref" || op == "unref" || op == "++" || op == "--") {
+		if (const auto id = std::dynamic_pointer_cast<ASTIdentifierNode>(astnode->expr)) {
+			fold(id->identifier_vector);
+		}
+		else {
+			fold(astnode->expr);
+		}
+		return;
+	}
+
+	fold(astnode->expr);
+
+	if (const auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_int>>(astnode->expr)) {
+		if (op == "-") {
+			folded_expression = std::make_shared<ASTLiteralNode<flx_int>>(flx_int(-literal->val), astnode->row, astnode->col);
+		}
+		else if (op == "~") {
+			folded_expression = std::make_shared<ASTLiteralNode<flx_int>>(flx_int(~literal->val), astnode->row, astnode->col);
+		}
+	}
+	else if (const auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_float>>(astnode->expr)) {
+		if (op == "-") {
+			folded_expression = std::make_shared<ASTLiteralNode<flx_float>>(flx_float(-literal->val), astnode->row, astnode->col);
+		}
+	}
+	else if (const auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_bool>>(astnode->expr)) {
+		if (op == "not") {
+			folded_expression = std::make_shared<ASTLiteralNode<flx_bool>>(flx_bool(!literal->val), astnode->row, astnode->col);
+		}
+	}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->identifier_vector);
+
+	if (!astnode->name_space.empty()
+		|| astnode->identifier_vector.size() != 1
+		|| !astnode->identifier_vector[0].access_vector.empty()) {
+		return;
+	}
+
+	if (const auto constant = find_constant(astnode->identifier)) {
+		std::unique_ptr<RuntimeValue> value(literal_value(constant));
+		folded_expression = make_literal(value.get(), astnode->row, astnode->col);
+	}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTTernaryNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->condition);
+	fold(astnode->value_if_true);
+	fold(astnode->value_if_false);
+
+	if (is_bool_literal(astnode->condition, true)) {
+		folded_expression = astnode->value_if_true;
+	}
+	else if (is_bool_literal(astnode->condition, false)) {
+		folded_expression = astnode->value_if_false;
+	}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTInNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->value);
+	fold(astnode->collection);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->identifier_vector);
+	for (auto& param : astnode->parameters) {
+		fold(param);
+	}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTTypeCastNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	fold(astnode->expr);
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTNullNode>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTThisNode>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTTypingNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	// typing a variable also looks at its declared type
+	if (const auto id = std::dynamic_pointer_cast<ASTIdentifierNode>(astnode->expr)) {
+		fold(id->identifier_vector);
+	}
+	else {
+		fold(astnode->expr);
+	}
+}
+
+void ConstantFolder::visit(std::shared_ptr<ASTValueNode>) {}
+
+void ConstantFolder::visit(std::shared_ptr<ASTBuiltinCallNode>) {}
+
+long long ConstantFolder::hash(std::shared_ptr<ASTExprNode>) { return 0; }
+long long ConstantFolder::hash(std::shared_ptr<ASTValueNode>) { return 0; }
+long long ConstantFolder::hash(std::shared_ptr<ASTLiteralNode<flx_bool>>) { return 0; }
+long long ConstantFolder::hash(std::shared_ptr<ASTLiteralNode<flx_int>>) { return 0; }
+long long ConstantFolder::hash(std::shared_ptr<ASTLiteralNode<flx_float>>) { return 0; }
+long long ConstantFolder::hash(std::shared_ptr<ASTLiteralNode<flx_char>>) { return 0; }
+long long ConstantFolder::hash(std::shared_ptr<ASTLiteralNode<flx_string>>) { return 0; }
+long long ConstantFolder::hash(std::shared_ptr<ASTIdentifierNode>) { return 0; }
+
+void ConstantFolder::set_curr_pos(unsigned int row, unsigned int col) {
+	curr_row = row;
+	curr_col = col;
+}
+
+std::string ConstantFolder::msg_header() {
+	return "(CFLD) " + current_program.top()->name + '[' + std::to_string(curr_row) + ':' + std::to_string(curr_col) + "]: ";
+}
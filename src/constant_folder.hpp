@@ -0,0 +1,107 @@
+#ifndef CONSTANT_FOLDER_HPP
+#define CONSTANT_FOLDER_HPP
+
+#include <memory>
+#include <map>
+#include <vector>
+#include <unordered_map>
+
+#include "ast.hpp"
+
+using namespace visitor;
+using namespace parser;
+
+namespace visitor {
+
+	// rewrites a checked program before any engine runs it: operations on literals and reads of scalar constants
+	// become literals, and if and while statements with constant conditions keep only the code that can run
+	class ConstantFolder : public Visitor {
+	private:
+		// constants of each scope of the code being folded, null for the variables that hide one
+		std::vector<std::unordered_map<std::string, std::shared_ptr<ASTExprNode>>> scopes;
+
+		// replacement of the last visited expression or statement
+		std::shared_ptr<ASTExprNode> folded_expression;
+		std::shared_ptr<ASTNode> folded_statement;
+		bool remove_statement = false;
+
+	private:
+		void fold(std::shared_ptr<ASTExprNode>& expr);
+		void fold(std::shared_ptr<ASTNode>& node);
+		void fold(std::vector<Identifier>& identifier_vector);
+		void fold_statements(std::vector<std::shared_ptr<ASTNode>>& statements, bool keep_positions);
+
+		void declare_variable(const std::string& identifier, std::shared_ptr<ASTExprNode> constant = nullptr);
+		std::shared_ptr<ASTExprNode> find_constant(const std::string& identifier) const;
+		std::shared_ptr<ASTExprNode> constant_literal(ASTDeclarationNode& declaration) const;
+
+		static RuntimeValue* literal_value(const std::shared_ptr<ASTExprNode>& expr);
+		static std::shared_ptr<ASTExprNode> make_literal(const RuntimeValue* value, unsigned int row, unsigned int col);
+		static bool is_bool_literal(const std::shared_ptr<ASTExprNode>& expr, bool value);
+
+		void set_curr_pos(unsigned int row, unsigned int col) override;
+		std::string msg_header() override;
+
+	public:
+		ConstantFolder(std::shared_ptr<ASTProgramNode> main_program, const std::map<std::string, std::shared_ptr<ASTProgramNode>>& programs);
+		~ConstantFolder() = default;
+
+		void start();
+
+		void visit(std::shared_ptr<ASTProgramNode>) override;
+		void visit(std::shared_ptr<ASTUsingNode>) override;
+		void visit(std::shared_ptr<ASTNamespaceManagerNode>) override;
+		void visit(std::shared_ptr<ASTDeclarationNode>) override;
+		void visit(std::shared_ptr<ASTUnpackedDeclarationNode>) override;
+		void visit(std::shared_ptr<ASTAssignmentNode>) override;
+		void visit(std::shared_ptr<ASTReturnNode>) override;
+		void visit(std::shared_ptr<ASTExitNode>) override;
+		void visit(std::shared_ptr<ASTBlockNode>) override;
+		void visit(std::shared_ptr<ASTContinueNode>) override;
+		void visit(std::shared_ptr<ASTBreakNode>) override;
+		void visit(std::shared_ptr<ASTSwitchNode>) override;
+		void visit(std::shared_ptr<ASTEnumNode>) override;
+		void visit(std::shared_ptr<ASTTryCatchNode>) override;
+		void visit(std::shared_ptr<ASTThrowNode>) override;
+		void visit(std::shared_ptr<ASTEllipsisNode>) override;
+		void visit(std::shared_ptr<ASTElseIfNode>) override;
+		void visit(std::shared_ptr<ASTIfNode>) override;
+		void visit(std::shared_ptr<ASTForNode>) override;
+		void visit(std::shared_ptr<ASTForEachNode>) override;
+		void visit(std::shared_ptr<ASTWhileNode>) override;
+		void visit(std::shared_ptr<ASTDoWhileNode>) override;
+		void visit(std::shared_ptr<ASTFunctionDefinitionNode>) override;
+		void visit(std::shared_ptr<ASTStructDefinitionNode>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_bool>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_int>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_float>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_char>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_string>>) override;
+		void visit(std::shared_ptr<ASTLambdaFunction>) override;
+		void visit(std::shared_ptr<ASTArrayConstructorNode>) override;
+		void visit(std::shared_ptr<ASTStructConstructorNode>) override;
+		void visit(std::shared_ptr<ASTBinaryExprNode>) override;
+		void visit(std::shared_ptr<ASTUnaryExprNode>) override;
+		void visit(std::shared_ptr<ASTIdentifierNode>) override;
+		void visit(std::shared_ptr<ASTTernaryNode>) override;
+		void visit(std::shared_ptr<ASTInNode>) override;
+		void visit(std::shared_ptr<ASTFunctionCallNode>) override;
+		void visit(std::shared_ptr<ASTTypeCastNode>) override;
+		void visit(std::shared_ptr<ASTNullNode>) override;
+		void visit(std::shared_ptr<ASTThisNode>) override;
+		void visit(std::shared_ptr<ASTTypingNode>) override;
+		void visit(std::shared_ptr<ASTValueNode>) override;
+		void visit(std::shared_ptr<ASTBuiltinCallNode>) override;
+
+		long long hash(std::shared_ptr<ASTExprNode>) override;
+		long long hash(std::shared_ptr<ASTValueNode>) override;
+		long long hash(std::shared_ptr<ASTIdentifierNode>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_bool>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_int>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_float>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_char>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_string>>) override;
+	};
+}
+
+#endif // !CONSTANT_FOLDER_HPP
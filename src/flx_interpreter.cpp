@@ -8,10 +8,17 @@
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "compiler.hpp"
+#include "constant_folder.hpp"
 #include "utils.hpp"
 #include "dependency_resolver.hpp"
 #include "interpreter.hpp"
 #include "vm.hpp"
+#include "bytecode_cache.hpp"
+#include "bytecode_optimizer.hpp"
+#include "register_compiler.hpp"
+#include "register_vm.hpp"
+#include "closure_compiler.hpp"
+#include "transpiler.hpp"
 
 FlexaInterpreter::FlexaInterpreter(const FlexaCliArgs& args)
 	: project_root(utils::PathUtils::normalize_path_sep(args.workspace_path)),
@@ -82,10 +89,13 @@ void FlexaInterpreter::parse_programs(const std::vector<FlexaSource>& source_pro
 int FlexaInterpreter::interpreter() {
 	FlexaSource main_program;
 	std::vector<FlexaSource> source_programs;
+	std::vector<std::string> source_paths;
 	try {
 		main_program = load_program(args.main_file);
 		source_programs = load_programs(args.source_files);
 		source_programs.emplace(source_programs.begin(), main_program);
+		source_paths = args.source_files;
+		source_paths.emplace(source_paths.begin(), args.main_file);
 	}
 	catch (const std::exception& e) {
 		std::cerr << e.what() << std::endl;
@@ -95,9 +105,32 @@ int FlexaInterpreter::interpreter() {
 	std::shared_ptr<visitor::Scope> semantic_global_scope = std::make_shared<visitor::Scope>(nullptr);
 	std::shared_ptr<visitor::Scope> interpreter_global_scope = std::make_shared<visitor::Scope>(nullptr);
 
+	// generated files are written next to the main program
+	const std::string output_path = project_root + std::string{ std::filesystem::path::preferred_separator } + source_programs[0].name;
+	const std::string cache_path = output_path + ".flxc";
+
+	// a valid bytecode cache skips the whole front end
+	if (args.engine == "vm" && args.bytecode_cache && args.transpile_path.empty()) {
+		vm::BytecodeCache cache;
+		if (cache.load(cache_path) && is_cache_valid(cache, source_paths, source_programs)) {
+			try {
+				return run_vm(interpreter_global_scope, cache.instructions, cache.constant_pool, cache.exception_table);
+			}
+			catch (const std::exception& e) {
+				std::cerr << e.what() << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
 	try {
 		std::shared_ptr<ASTProgramNode> main_program = nullptr;
 		std::map<std::string, std::shared_ptr<ASTProgramNode>> programs;
+		std::vector<vm::CachedModule> modules;
+		for (size_t i = 0; i < source_programs.size(); ++i) {
+			modules.push_back(vm::CachedModule{ source_paths[i], vm::BytecodeCache::hash_source(source_programs[i].source) });
+		}
+
 		parse_programs(source_programs, &main_program, &programs);
 		size_t libs_size = 0;
 		do {
@@ -108,6 +141,9 @@ int FlexaInterpreter::interpreter() {
 
 			if (libs_size > 0) {
 				auto cplib_programs = load_programs(libfinder.lib_names);
+				for (size_t i = 0; i < cplib_programs.size(); ++i) {
+					modules.push_back(vm::CachedModule{ libfinder.lib_names[i], vm::BytecodeCache::hash_source(cplib_programs[i].source) });
+				}
 				parse_programs(cplib_programs, &main_program, &programs);
 			}
 		} while (libs_size > 0);
@@ -118,25 +154,66 @@ int FlexaInterpreter::interpreter() {
 		visitor::SemanticAnalyser semantic_analyser(semantic_global_scope, main_program, programs, args.program_args);
 		semantic_analyser.start();
 
+		visitor::ConstantFolder(main_program, programs).start();
+
+		if (!args.transpile_path.empty()) {
+			visitor::Transpiler transpiler(main_program, programs);
+			transpiler.start();
+
+			std::ofstream file(args.transpile_path);
+			if (!file) {
+				throw std::runtime_error("could not write '" + args.transpile_path + "'");
+			}
+			file << transpiler.source;
+			return EXIT_SUCCESS;
+		}
+
 		long long result = 0;
 
-		if (args.engine == "ast") {
-			visitor::Interpreter interpreter(interpreter_global_scope, main_program, programs, args.program_args);
-			interpreter.start();
-			result = interpreter.current_expression_value->get_i();
+		if (args.engine == "regvm") {
+			visitor::RegisterCompiler register_compiler(main_program, programs);
+			if (register_compiler.start()) {
+				vm::RegisterVirtualMachine register_vm(register_compiler.program, args.jit);
+				return register_vm.run();
+			}
+
+			// programs outside the register subset run on the ast engine, which is always reported
+			std::cerr << register_compiler.unsupported_reason << ", running on the ast engine" << std::endl;
+		}
+
+		if (args.engine == "closure") {
+			visitor::ClosureCompiler closure_compiler(main_program, programs);
+			if (closure_compiler.start()) {
+				return closure_compiler.program.run();
+			}
+
+			// programs outside the closure subset run on the ast engine, which is always reported
+			std::cerr << closure_compiler.unsupported_reason << ", running on the ast engine" << std::endl;
+		}
+
+		if (args.engine != "vm") {
+			result = run_interpreter(interpreter_global_scope, main_program, programs);
 		}
 		else {
 			// compile
 			visitor::Compiler compiler(main_program, programs, args.program_args);
 			compiler.start();
 
-			BytecodeInstruction::write_bytecode_table(compiler.bytecode_program, project_root + "\\" + source_programs[0].name + ".bslt");
+			vm::BytecodeOptimizer(compiler.bytecode_program, compiler.constant_pool, compiler.exception_table).optimize();
 
-			// execute
-			VirtualMachine vm(interpreter_global_scope, compiler.bytecode_program);
-			vm.run();
+			BytecodeInstruction::write_bytecode_table(compiler.bytecode_program, compiler.constant_pool, output_path + ".bslt");
+
+			if (args.bytecode_cache) {
+				vm::BytecodeCache cache;
+				cache.modules = modules;
+				cache.instructions = compiler.bytecode_program;
+				cache.constant_pool = compiler.constant_pool;
+				cache.exception_table = compiler.exception_table;
+				cache.save(cache_path);
+			}
 
-			result = vm.value_stack->back()->get_i();
+			// execute
+			result = run_vm(interpreter_global_scope, compiler.bytecode_program, compiler.constant_pool, compiler.exception_table);
 		}
 
 		return result;
@@ -148,3 +225,90 @@ int FlexaInterpreter::interpreter() {
 
 	return EXIT_SUCCESS;
 }
+
+long long FlexaInterpreter::run_interpreter(std::shared_ptr<visitor::Scope> global_scope, std::shared_ptr<ASTProgramNode> main_program,
+	const std::map<std::string, std::shared_ptr<ASTProgramNode>>& programs) {
+	visitor::Interpreter interpreter(global_scope, main_program, programs, args.program_args);
+	interpreter.gc.set_config(build_gc_config());
+	interpreter.start();
+	long long result = interpreter.current_expression_value->get_i();
+
+	if (args.gc_stats) {
+		print_gc_stats(interpreter.gc);
+	}
+
+	return result;
+}
+
+long long FlexaInterpreter::run_vm(std::shared_ptr<visitor::Scope> global_scope, const std::vector<BytecodeInstruction>& instructions,
+	const ConstantPool& constant_pool, const std::vector<ExceptionTableEntry>& exception_table) {
+	VirtualMachine vm(global_scope, instructions, constant_pool, exception_table);
+	vm.gc.set_config(build_gc_config());
+	vm.run();
+
+	long long result = vm.value_stack->back()->get_i();
+
+	if (args.gc_stats) {
+		print_gc_stats(vm.gc);
+	}
+
+	return result;
+}
+
+bool FlexaInterpreter::is_cache_valid(const vm::BytecodeCache& cache, const std::vector<std::string>& source_paths,
+	const std::vector<FlexaSource>& source_programs) {
+	if (cache.modules.size() < source_paths.size()) {
+		return false;
+	}
+
+	for (size_t i = 0; i < cache.modules.size(); ++i) {
+		const auto& module = cache.modules[i];
+		std::string source;
+
+		if (i < source_paths.size()) {
+			if (module.path != source_paths[i]) {
+				return false;
+			}
+			source = source_programs[i].source;
+		}
+		else {
+			// libs found by the dependency resolver when the cache was built
+			try {
+				source = load_program(module.path).source;
+			}
+			catch (...) {
+				return false;
+			}
+		}
+
+		if (vm::BytecodeCache::hash_source(source) != module.hash) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+gc::GCConfig FlexaInterpreter::build_gc_config() const {
+	gc::GCConfig config;
+	config.young_object_budget = args.gc_young_objects;
+	config.young_byte_budget = args.gc_young_bytes;
+	config.heap_growth_factor = args.gc_growth_factor;
+	config.allocator = args.gc_allocator;
+	return config;
+}
+
+void FlexaInterpreter::print_gc_stats(const gc::GarbageCollector& gc) {
+	const auto& stats = gc.get_stats();
+	const auto allocator = gc.get_allocator();
+	std::cerr << std::endl << "gc stats:" << std::endl;
+	std::cerr << "  cycles: " << stats.young_cycles + stats.full_cycles
+		<< " (" << stats.young_cycles << " young, " << stats.full_cycles << " full)" << std::endl;
+	std::cerr << std::fixed << std::setprecision(3);
+	std::cerr << "  total pause: " << stats.total_pause_ms << " ms" << std::endl;
+	std::cerr << "  max pause: " << stats.max_pause_ms << " ms" << std::endl;
+	std::cerr << "  objects freed: " << stats.objects_freed << std::endl;
+	std::cerr << "  peak heap: " << stats.peak_heap_objects << " objects" << std::endl;
+	std::cerr << "  allocator: " << allocator->name() << " (" << allocator->allocations << " allocations, "
+		<< allocator->deallocations << " deallocations)" << std::endl;
+}
@@ -3,6 +3,8 @@
 
 #include "flx_utils.hpp"
 #include "semantic_analysis.hpp"
+#include "gc.hpp"
+#include "bytecode_cache.hpp"
 
 class FlexaInterpreter {
 private:
@@ -24,6 +26,16 @@ private:
 
 	int interpreter();
 
+	long long run_interpreter(std::shared_ptr<visitor::Scope> global_scope, std::shared_ptr<ASTProgramNode> main_program,
+		const std::map<std::string, std::shared_ptr<ASTProgramNode>>& programs);
+	long long run_vm(std::shared_ptr<visitor::Scope> global_scope, const std::vector<vm::BytecodeInstruction>& instructions,
+		const vm::ConstantPool& constant_pool, const std::vector<vm::ExceptionTableEntry>& exception_table);
+	bool is_cache_valid(const vm::BytecodeCache& cache, const std::vector<std::string>& source_paths,
+		const std::vector<FlexaSource>& source_programs);
+
+	gc::GCConfig build_gc_config() const;
+	static void print_gc_stats(const gc::GarbageCollector& gc);
+
 };
 
 #endif // !CPINTERPRETER_HPP
@@ -118,6 +118,8 @@ int FlexaRepl::execute(const FlexaCliArgs& args) {
 			visitor::SemanticAnalyser semantic_analyser(semantic_global_scope, program, programs, args.program_args);
 			semantic_analyser.start();
 
+			visitor::ConstantFolder(program, programs).start();
+
 			visitor::Interpreter interpreter(interpreter_global_scope, program, programs, args.program_args);
 			interpreter.visit(program);
 
@@ -9,6 +9,7 @@
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "semantic_analysis.hpp"
+#include "constant_folder.hpp"
 #include "interpreter.hpp"
 #include "flx_utils.hpp"
 
@@ -41,16 +41,84 @@ std::string get_prog_name(const std::string& progpath) {
 	return get_lib_name(progpath.substr(index, progpath.size()));
 }
 
+std::string get_env(const std::string& name) {
+	char* value = nullptr;
+	size_t size = 0;
+	if (_dupenv_s(&value, &size, name.c_str()) != 0 || !value) {
+		return "";
+	}
+	std::string result = value;
+	free(value);
+	return result;
+}
+
 void throw_if_not_parameter(int argc, size_t i, std::string parameter) {
 	if (i >= argc) {
 		throw std::runtime_error("expected value after " + parameter);
 	}
 }
 
+size_t parse_size_parameter(const std::string& parameter, const std::string& value) {
+	try {
+		size_t pos = 0;
+		auto size = std::stoull(value, &pos);
+		if (pos == value.size() && size > 0) {
+			return size;
+		}
+	}
+	catch (...) {}
+	throw std::runtime_error("invalid " + parameter + " parameter value: '" + value + "'");
+}
+
+double parse_factor_parameter(const std::string& parameter, const std::string& value) {
+	try {
+		size_t pos = 0;
+		auto factor = std::stod(value, &pos);
+		if (pos == value.size() && factor > 1) {
+			return factor;
+		}
+	}
+	catch (...) {}
+	throw std::runtime_error("invalid " + parameter + " parameter value: '" + value + "'");
+}
+
+std::string parse_allocator_parameter(const std::string& parameter, const std::string& value) {
+	if (value != "pool" && value != "malloc") {
+		throw std::runtime_error("invalid " + parameter + " parameter value: '" + value + "'");
+	}
+	return value;
+}
+
+void parse_env_args(FlexaCliArgs& args) {
+	std::string value = get_env("FLX_GC_STATS");
+	if (!value.empty()) {
+		args.gc_stats = value != "0";
+	}
+	value = get_env("FLX_GC_YOUNG_OBJECTS");
+	if (!value.empty()) {
+		args.gc_young_objects = parse_size_parameter("FLX_GC_YOUNG_OBJECTS", value);
+	}
+	value = get_env("FLX_GC_YOUNG_BYTES");
+	if (!value.empty()) {
+		args.gc_young_bytes = parse_size_parameter("FLX_GC_YOUNG_BYTES", value);
+	}
+	value = get_env("FLX_GC_GROWTH");
+	if (!value.empty()) {
+		args.gc_growth_factor = parse_factor_parameter("FLX_GC_GROWTH", value);
+	}
+	value = get_env("FLX_GC_ALLOCATOR");
+	if (!value.empty()) {
+		args.gc_allocator = parse_allocator_parameter("FLX_GC_ALLOCATOR", value);
+	}
+}
+
 FlexaCliArgs parse_args(int argc, const char* argv[]) {
 	FlexaCliArgs args;
 	args.engine = "ast";
 
+	// environment defaults, overridden by command line parameters
+	parse_env_args(args);
+
 	size_t i = 0;
 
 	args.program_args.push_back(argv[i]);
@@ -67,12 +135,57 @@ FlexaCliArgs parse_args(int argc, const char* argv[]) {
 			++i;
 			throw_if_not_parameter(argc, i, arg);
 			std::string p = argv[i];
-			if (p != "ast" && p != "vm") {
+			if (p != "ast" && p != "vm" && p != "regvm" && p != "closure") {
 				throw std::runtime_error("invalid " + arg + " parameter value: '" + p + "'");
 			}
 			args.engine = argv[i];
 			continue;
 		}
+		if (arg == "-t" || arg == "--transpile") {
+			++i;
+			throw_if_not_parameter(argc, i, arg);
+			args.transpile_path = argv[i];
+			continue;
+		}
+		if (arg == "--no-jit") {
+			args.jit = false;
+
+			continue;
+		}
+		if (arg == "--no-cache") {
+			args.bytecode_cache = false;
+
+			continue;
+		}
+		if (arg == "--gc-stats") {
+			args.gc_stats = true;
+
+			continue;
+		}
+		if (arg == "--gc-young-objects") {
+			++i;
+			throw_if_not_parameter(argc, i, arg);
+			args.gc_young_objects = parse_size_parameter(arg, argv[i]);
+			continue;
+		}
+		if (arg == "--gc-young-bytes") {
+			++i;
+			throw_if_not_parameter(argc, i, arg);
+			args.gc_young_bytes = parse_size_parameter(arg, argv[i]);
+			continue;
+		}
+		if (arg == "--gc-growth") {
+			++i;
+			throw_if_not_parameter(argc, i, arg);
+			args.gc_growth_factor = parse_factor_parameter(arg, argv[i]);
+			continue;
+		}
+		if (arg == "--gc-allocator") {
+			++i;
+			throw_if_not_parameter(argc, i, arg);
+			args.gc_allocator = parse_allocator_parameter(arg, argv[i]);
+			continue;
+		}
 		if (arg == "-w" || arg == "--workspace") {
 			++i;
 			throw_if_not_parameter(argc, i, arg);
@@ -21,7 +21,16 @@ extern std::string get_prog_name(const std::string& progpath);
 
 struct FlexaCliArgs {
 	bool debug = false;
+	bool gc_stats = false;
+	size_t gc_young_objects = 10000;
+	size_t gc_young_bytes = 4 * 1024 * 1024;
+	double gc_growth_factor = 2.0;
+	std::string gc_allocator = "pool";
+	bool bytecode_cache = true;
+	bool jit = true;
 	std::string engine;
+	// c++ file written by the transpiler instead of running the program
+	std::string transpile_path;
 	std::string libs_path;
 	std::string workspace_path;
 	std::string main_file;
@@ -29,8 +38,18 @@ struct FlexaCliArgs {
 	std::vector<std::string> program_args;
 };
 
+extern std::string get_env(const std::string& name);
+
 extern void throw_if_not_parameter(int argc, size_t i, std::string parameter);
 
+extern size_t parse_size_parameter(const std::string& parameter, const std::string& value);
+
+extern double parse_factor_parameter(const std::string& parameter, const std::string& value);
+
+extern std::string parse_allocator_parameter(const std::string& parameter, const std::string& value);
+
+extern void parse_env_args(FlexaCliArgs& args);
+
 extern FlexaCliArgs parse_args(int argc, const char* argv[]);
 
 #endif // !BSLUTILS_HPP
@@ -1,11 +1,28 @@
 #include "gc.hpp"
 
+#include <algorithm>
+
 using namespace gc;
 
-GarbageCollector::GarbageCollector() {}
+GarbageCollector* GarbageCollector::active = nullptr;
+
+GarbageCollector::GarbageCollector()
+	: allocator(GCAllocator::get_by_name(config.allocator)) {
+	GCAllocator::set_active(allocator);
+	active = this;
+}
 
 GarbageCollector::~GarbageCollector() {
-	for (GCObject* obj : heap) {
+	if (active == this) {
+		active = nullptr;
+	}
+	clear_remembered_set();
+	for (GCObject* obj : young) {
+		if (obj) {
+			delete obj;
+		}
+	}
+	for (GCObject* obj : old) {
 		if (obj) {
 			delete obj;
 		}
@@ -13,10 +30,34 @@ GarbageCollector::~GarbageCollector() {
 }
 
 GCObject* GarbageCollector::allocate(GCObject* obj) {
-	heap.push_back(obj);
+	young.push_back(obj);
+
+	++allocated_objects;
+	allocated_bytes += obj->get_size();
+	stats.peak_heap_objects = std::max(stats.peak_heap_objects, young.size() + old.size());
+
 	return obj;
 }
 
+GarbageCollector* GarbageCollector::get_active() {
+	return active;
+}
+
+void GarbageCollector::set_config(const GCConfig& config) {
+	this->config = config;
+	allocator = GCAllocator::get_by_name(config.allocator);
+	GCAllocator::set_active(allocator);
+	old_threshold = std::max(config.min_old_objects, size_t(old.size() * config.heap_growth_factor));
+}
+
+const GCStats& GarbageCollector::get_stats() const {
+	return stats;
+}
+
+const GCAllocator* GarbageCollector::get_allocator() const {
+	return allocator;
+}
+
 void GarbageCollector::add_root(GCObject* obj) {
 	roots.push_back(obj);
 }
@@ -77,10 +118,10 @@ void GarbageCollector::remove_root_container(std::weak_ptr<std::vector<RuntimeVa
 	}
 }
 
-void GarbageCollector::mark() {
+void GarbageCollector::for_each_root(const std::function<void(GCObject*)>& visit) {
 	for (auto it = roots.begin(); it != roots.end();) {
 		if (*it) {
-			mark_object(*it);
+			visit(*it);
 			++it;
 		}
 		else {
@@ -90,7 +131,7 @@ void GarbageCollector::mark() {
 
 	for (auto it = ptr_roots.begin(); it != ptr_roots.end();) {
 		if (*it) {
-			mark_object(**it);
+			visit(**it);
 			++it;
 		}
 		else {
@@ -100,7 +141,7 @@ void GarbageCollector::mark() {
 
 	for (auto it = var_roots.begin(); it != var_roots.end();) {
 		if (auto root = it->lock()) {
-			mark_object(root.get());
+			visit(root.get());
 			++it;
 		}
 		else {
@@ -111,7 +152,7 @@ void GarbageCollector::mark() {
 	for (auto it = root_containers.begin(); it != root_containers.end();) {
 		if (auto root = it->lock()) {
 			for (auto item : *root.get()) {
-				mark_object(item);
+				visit(item);
 			}
 			++it;
 		}
@@ -121,47 +162,218 @@ void GarbageCollector::mark() {
 	}
 }
 
+void GarbageCollector::mark() {
+	for_each_root([this](GCObject* root) {
+		mark_object(root);
+		});
+	drain_mark_stack(false);
+}
+
 void GarbageCollector::mark_object(GCObject* obj) {
 	if (obj == nullptr || obj->marked) return;
 	obj->marked = true;
+	marked_objects.push_back(obj);
+	mark_stack.push_back(obj);
+}
+
+void GarbageCollector::sweep() {
+	size_t live = 0;
 
-	for (GCObject* referenced : obj->get_references()) {
-		mark_object(referenced);
+	// the set may hold old objects freed below, so it is cleared while they are still alive
+	clear_remembered_set();
+
+	for (auto obj : old) {
+		if (obj->marked) {
+			old[live++] = obj;
+		}
+		else {
+			delete obj;
+			++stats.objects_freed;
+		}
 	}
+	old.resize(live);
+
+	// every nursery survivor is promoted, so no old-to-young references remain
+	for (auto obj : young) {
+		if (obj->marked) {
+			obj->old = true;
+			obj->age = 0;
+			old.push_back(obj);
+		}
+		else {
+			delete obj;
+			++stats.objects_freed;
+		}
+	}
+	young.clear();
+
+	unmark_all();
+
+	old_threshold = std::max(config.min_old_objects, size_t(old.size() * config.heap_growth_factor));
 }
 
-void GarbageCollector::sweep() {
-	for (auto it = heap.begin(); it != heap.end(); ) {
-		if (!(*it)->marked) {
-			delete* it;
-			it = heap.erase(it);
+void GarbageCollector::collect() {
+	auto start = std::chrono::steady_clock::now();
+
+	mark();
+	sweep();
+	++stats.full_cycles;
+
+	finish_cycle(start);
+}
+
+void GarbageCollector::mark_young() {
+	for_each_root([this](GCObject* root) {
+		if (root && root->old) {
+			root->for_each_reference([this](GCObject* referenced) {
+				mark_young_object(referenced);
+				});
 		}
 		else {
-			(*it)->marked = false;
-			++it;
+			mark_young_object(root);
+		}
+		});
+
+	for (auto remembered : GCObject::remembered_set) {
+		remembered->for_each_reference([this](GCObject* referenced) {
+			mark_young_object(referenced);
+			});
+	}
+
+	drain_mark_stack(true);
+}
+
+void GarbageCollector::mark_young_object(GCObject* obj) {
+	if (obj == nullptr || obj->marked || obj->old) return;
+	obj->marked = true;
+	marked_objects.push_back(obj);
+	mark_stack.push_back(obj);
+}
+
+void GarbageCollector::sweep_young() {
+	std::vector<GCObject*> promoted;
+	size_t live = 0;
+
+	for (auto obj : young) {
+		if (!obj->marked) {
+			delete obj;
+			++stats.objects_freed;
+		}
+		else if (++obj->age >= TENURING_THRESHOLD) {
+			obj->old = true;
+			old.push_back(obj);
+			promoted.push_back(obj);
+		}
+		else {
+			young[live++] = obj;
 		}
 	}
+	young.resize(live);
+
+	unmark_all();
 
-	for (auto it = roots.begin(); it != roots.end(); ++it) {
-		(*it)->marked = false;
+	auto has_young_reference = [](GCObject* obj) {
+		bool found = false;
+		obj->for_each_reference([&found](GCObject* referenced) {
+			found = found || (referenced && !referenced->old);
+			});
+		return found;
+		};
+
+	// drop remembered objects that no longer point into the nursery
+	auto& remembered_set = GCObject::remembered_set;
+	live = 0;
+	for (auto obj : remembered_set) {
+		if (has_young_reference(obj)) {
+			remembered_set[live++] = obj;
+		}
+		else {
+			obj->remembered = false;
+		}
 	}
+	remembered_set.resize(live);
 
-	for (auto it = var_roots.begin(); it != var_roots.end(); ++it) {
-		if (auto root = it->lock()) {
-			root->marked = false;
+	// freshly promoted objects may still reference survivors that stayed young
+	for (auto obj : promoted) {
+		if (has_young_reference(obj)) {
+			obj->write_barrier();
 		}
 	}
+}
+
+void GarbageCollector::collect_young() {
+	auto start = std::chrono::steady_clock::now();
+
+	mark_young();
+	sweep_young();
+	++stats.young_cycles;
+
+	if (old.size() > old_threshold) {
+		mark();
+		sweep();
+		++stats.full_cycles;
+	}
+
+	finish_cycle(start);
+}
+
+void GarbageCollector::maybe_collect() {
+	if (allocated_objects < config.young_object_budget
+		&& allocated_bytes < config.young_byte_budget) {
+		return;
+	}
 
-	for (const auto& iterable_ptr : root_containers) {
-		if (auto root = iterable_ptr.lock()) {
-			for (auto item : *root) {
-				item->marked = false;
+	collect_young();
+}
+
+void GarbageCollector::finish_cycle(std::chrono::steady_clock::time_point start) {
+	double pause = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	stats.total_pause_ms += pause;
+	stats.max_pause_ms = std::max(stats.max_pause_ms, pause);
+
+	allocated_objects = 0;
+	allocated_bytes = 0;
+}
+
+void GarbageCollector::drain_mark_stack(bool young_only) {
+	while (!mark_stack.empty()) {
+		auto obj = mark_stack.back();
+		mark_stack.pop_back();
+
+		obj->for_each_reference([this, young_only](GCObject* referenced) {
+			if (young_only) {
+				mark_young_object(referenced);
 			}
-		}
+			else {
+				mark_object(referenced);
+			}
+			});
 	}
 }
 
-void GarbageCollector::collect() {
-	mark();
-	sweep();
+void GarbageCollector::unmark_all() {
+	for (auto obj : marked_objects) {
+		obj->marked = false;
+	}
+	marked_objects.clear();
+}
+
+void GarbageCollector::clear_remembered_set() {
+	for (auto obj : GCObject::remembered_set) {
+		obj->remembered = false;
+	}
+	GCObject::remembered_set.clear();
+}
+
+RootGuard::RootGuard(GarbageCollector& gc, GCObject* obj)
+	: gc(gc), obj(obj) {
+	if (obj) {
+		gc.add_root(obj);
+	}
+}
+
+RootGuard::~RootGuard() {
+	if (obj) {
+		gc.remove_root(obj);
+	}
 }
@@ -7,25 +7,65 @@
 #include <ranges>
 #include <type_traits>
 #include <variant>
+#include <functional>
+#include <chrono>
 
 #include "gcobject.hpp"
+#include "gc_allocator.hpp"
 #include "types.hpp"
 
 namespace gc {
 
+	struct GCConfig {
+		// a young collection runs at the next safe point once either budget is exceeded
+		size_t young_object_budget = 10000;
+		size_t young_byte_budget = 4 * 1024 * 1024;
+		// a full collection runs once the old space grew by this factor since the last one
+		double heap_growth_factor = 2.0;
+		size_t min_old_objects = 4096;
+		// "pool" or "malloc"
+		std::string allocator = "pool";
+	};
+
+	struct GCStats {
+		size_t young_cycles = 0;
+		size_t full_cycles = 0;
+		double total_pause_ms = 0;
+		double max_pause_ms = 0;
+		size_t objects_freed = 0;
+		size_t peak_heap_objects = 0;
+	};
+
 	class GarbageCollector {
 	private:
-		std::vector<GCObject*> heap;
+		// young collections an object must survive before being promoted
+		static constexpr uint8_t TENURING_THRESHOLD = 2;
+
+		GCConfig config;
+		GCStats stats;
+		GCAllocator* allocator;
+		size_t allocated_objects = 0;
+		size_t allocated_bytes = 0;
+
+		std::vector<GCObject*> young;
+		std::vector<GCObject*> old;
+		size_t old_threshold = config.min_old_objects;
+		std::vector<GCObject*> mark_stack;
+		std::vector<GCObject*> marked_objects;
 		std::vector<GCObject*> roots;
 		std::vector<RuntimeValue**> ptr_roots;
 		std::vector<std::weak_ptr<GCObject>> var_roots;
 		std::vector<std::weak_ptr<std::vector<RuntimeValue*>>> root_containers;
 
+		// collector of the running engine, only one is alive at a time
+		static GarbageCollector* active;
+
 	public:
 		GarbageCollector();
 		~GarbageCollector();
 
 		GCObject* allocate(GCObject* obj);
+		static GarbageCollector* get_active();
 
 		void add_root(GCObject* obj);
 		void remove_root(GCObject* obj);
@@ -44,6 +84,37 @@ namespace gc {
 		void sweep();
 		void collect();
 
+		void mark_young();
+		void mark_young_object(GCObject* obj);
+		void sweep_young();
+		void collect_young();
+		void maybe_collect();
+
+		void set_config(const GCConfig& config);
+		const GCStats& get_stats() const;
+		const GCAllocator* get_allocator() const;
+
+	private:
+		void for_each_root(const std::function<void(GCObject*)>& visit);
+		void drain_mark_stack(bool young_only);
+		void unmark_all();
+		void finish_cycle(std::chrono::steady_clock::time_point start);
+		void clear_remembered_set();
+
+	};
+
+	// roots an object for the lifetime of the guard, also when an exception leaves the scope
+	class RootGuard {
+	private:
+		GarbageCollector& gc;
+		GCObject* obj;
+
+	public:
+		RootGuard(GarbageCollector& gc, GCObject* obj);
+		~RootGuard();
+
+		RootGuard(const RootGuard&) = delete;
+		RootGuard& operator=(const RootGuard&) = delete;
 	};
 
 }
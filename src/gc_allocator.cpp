@@ -0,0 +1,127 @@
+#include "gc_allocator.hpp"
+
+#include <new>
+#include <stdexcept>
+
+using namespace gc;
+
+GCAllocator* GCAllocator::active = nullptr;
+
+GCAllocator* GCAllocator::get_active() {
+	if (!active) {
+		active = PoolAllocator::instance();
+	}
+	return active;
+}
+
+void GCAllocator::set_active(GCAllocator* allocator) {
+	active = allocator;
+}
+
+GCAllocator* GCAllocator::get_by_name(const std::string& name) {
+	if (name == "pool") {
+		return PoolAllocator::instance();
+	}
+	if (name == "malloc") {
+		return MallocAllocator::instance();
+	}
+	throw std::runtime_error("invalid allocator '" + name + "'");
+}
+
+void GCAllocator::release(void* ptr, size_t size) {
+	// blocks may outlive a switch of the active allocator, so the pool is always asked first
+	if (!PoolAllocator::instance()->deallocate(ptr, size)) {
+		MallocAllocator::instance()->deallocate(ptr, size);
+	}
+}
+
+MallocAllocator* MallocAllocator::instance() {
+	// never destroyed, blocks can be released during static destruction
+	static MallocAllocator* allocator = new MallocAllocator();
+	return allocator;
+}
+
+void* MallocAllocator::allocate(size_t size) {
+	++allocations;
+	return ::operator new(size);
+}
+
+bool MallocAllocator::deallocate(void* ptr, size_t) {
+	++deallocations;
+	::operator delete(ptr);
+	return true;
+}
+
+std::string MallocAllocator::name() const {
+	return "malloc";
+}
+
+PoolAllocator* PoolAllocator::instance() {
+	// never destroyed, blocks can be released during static destruction
+	static PoolAllocator* allocator = new PoolAllocator();
+	return allocator;
+}
+
+size_t PoolAllocator::size_class(size_t size) {
+	return (size + GRANULARITY - 1) / GRANULARITY - 1;
+}
+
+void* PoolAllocator::allocate(size_t size) {
+	if (size == 0 || size > MAX_BLOCK_SIZE) {
+		return MallocAllocator::instance()->allocate(size);
+	}
+
+	auto cls = size_class(size);
+	if (!free_lists[cls]) {
+		refill(cls);
+	}
+
+	auto block = free_lists[cls];
+	free_lists[cls] = block->next;
+	++allocations;
+
+	return block;
+}
+
+bool PoolAllocator::deallocate(void* ptr, size_t size) {
+	if (size == 0 || size > MAX_BLOCK_SIZE) {
+		return false;
+	}
+
+	auto slab = reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t(SLAB_SIZE) - 1);
+	if (slabs.find(slab) == slabs.end()) {
+		return false;
+	}
+
+	auto cls = size_class(size);
+	auto block = static_cast<FreeBlock*>(ptr);
+	block->next = free_lists[cls];
+	free_lists[cls] = block;
+	++deallocations;
+
+	return true;
+}
+
+void PoolAllocator::refill(size_t cls) {
+	auto slab = static_cast<char*>(::operator new(SLAB_SIZE, std::align_val_t(SLAB_SIZE)));
+	slabs.insert(reinterpret_cast<uintptr_t>(slab));
+
+	// blocks are threaded in address order, so consecutive allocations stay contiguous
+	size_t block_size = (cls + 1) * GRANULARITY;
+	size_t block_count = SLAB_SIZE / block_size;
+	FreeBlock* next = free_lists[cls];
+	for (size_t i = block_count; i > 0; --i) {
+		auto block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * block_size);
+		block->next = next;
+		next = block;
+	}
+	free_lists[cls] = next;
+}
+
+std::string PoolAllocator::name() const {
+	return "pool";
+}
+
+size_t PoolAllocator::slab_count() const {
+	return slabs.size();
+}
@@ -0,0 +1,79 @@
+#ifndef GC_ALLOCATOR_HPP
+#define GC_ALLOCATOR_HPP
+
+#include <array>
+#include <vector>
+#include <string>
+#include <unordered_set>
+#include <cstdint>
+
+namespace gc {
+
+	class GCAllocator {
+	public:
+		size_t allocations = 0;
+		size_t deallocations = 0;
+
+		virtual ~GCAllocator() = default;
+
+		virtual void* allocate(size_t size) = 0;
+		// returns false when the block was not handed out by this allocator
+		virtual bool deallocate(void* ptr, size_t size) = 0;
+		virtual std::string name() const = 0;
+
+		// allocator used for every new GCObject
+		static GCAllocator* get_active();
+		static void set_active(GCAllocator* allocator);
+		static GCAllocator* get_by_name(const std::string& name);
+
+		// gives a block back to whichever allocator handed it out
+		static void release(void* ptr, size_t size);
+
+	private:
+		static GCAllocator* active;
+	};
+
+	class MallocAllocator : public GCAllocator {
+	public:
+		static MallocAllocator* instance();
+
+		void* allocate(size_t size) override;
+		bool deallocate(void* ptr, size_t size) override;
+		std::string name() const override;
+	};
+
+	// size-class slab allocator, each slab is aligned to its size and serves a single size class
+	class PoolAllocator : public GCAllocator {
+	public:
+		static constexpr size_t SLAB_SIZE = 64 * 1024;
+		static constexpr size_t GRANULARITY = 16;
+		static constexpr size_t MAX_BLOCK_SIZE = 512;
+		static constexpr size_t SIZE_CLASSES = MAX_BLOCK_SIZE / GRANULARITY;
+
+	private:
+		struct FreeBlock {
+			FreeBlock* next;
+		};
+
+		std::array<FreeBlock*, SIZE_CLASSES> free_lists{};
+		std::unordered_set<uintptr_t> slabs;
+
+	public:
+		static PoolAllocator* instance();
+
+		void* allocate(size_t size) override;
+		bool deallocate(void* ptr, size_t size) override;
+		std::string name() const override;
+
+		size_t slab_count() const;
+
+	private:
+		PoolAllocator() = default;
+
+		static size_t size_class(size_t size);
+		void refill(size_t size_class);
+	};
+
+}
+
+#endif // !GC_ALLOCATOR_HPP
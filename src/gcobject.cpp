@@ -1,5 +1,23 @@
 #include "gcobject.hpp"
+#include "gc_allocator.hpp"
 
 using namespace gc;
 
+std::vector<GCObject*> GCObject::remembered_set;
+
+void* GCObject::operator new(size_t size) {
+	return GCAllocator::get_active()->allocate(size);
+}
+
+void GCObject::operator delete(void* ptr, size_t size) {
+	GCAllocator::release(ptr, size);
+}
+
 GCObject::~GCObject() = default;
+
+void GCObject::write_barrier() {
+	if (old && !remembered) {
+		remembered = true;
+		remembered_set.push_back(this);
+	}
+}
@@ -2,14 +2,38 @@
 #define GCOBJECT_HPP
 
 #include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
 
 namespace gc {
 
     class GCObject {
     public:
         bool marked = false;
+        // true once the object was promoted from the nursery to the old generation
+        bool old = false;
+        // true while the object is queued in the remembered set
+        bool remembered = false;
+        // number of young collections survived
+        uint8_t age = 0;
+
+        // old objects that may hold references to young objects, scanned as roots by young collections
+        // only one collector is alive at a time, so the set is shared
+        static std::vector<GCObject*> remembered_set;
+
+        // objects are carved from the active GCAllocator
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
         virtual ~GCObject();
-        virtual std::vector<GCObject*> get_references() = 0;
+        // calls visit with every object this one references
+        virtual void for_each_reference(const std::function<void(GCObject*)>& visit) = 0;
+        // approximate number of bytes owned by the object, used for allocation budgets
+        virtual size_t get_size() const = 0;
+
+        // must be called whenever the references held by this object may have changed
+        void write_barrier();
     };
 
 }
@@ -23,18 +23,25 @@ Interpreter::Interpreter(std::shared_ptr<Scope> global_scope, std::shared_ptr<AS
 	gc.add_ptr_root(&current_expression_value);
 
 	push_namespace(default_namespace);
-	current_this_name.push(default_namespace);
+	program_this_name = default_namespace;
 	scopes[default_namespace].push_back(global_scope);
 
+	// recursion reuses the same frames instead of growing the stack on every call
+	call_stack.reserve(256);
+
 	built_in_libs["builtin"]->register_functions(this);
 
 	build_args(args);
 }
 
 void Interpreter::start() {
-	current_this_name.push(current_program.top()->name);
+	const auto outer_this_name = program_this_name;
+	const auto outer_scopes = program_scopes;
+	program_this_name = current_program.top()->name;
+	program_scopes = &scopes[get_namespace()];
 	visit(current_program.top());
-	current_this_name.pop();
+	program_this_name = outer_this_name;
+	program_scopes = outer_scopes;
 }
 
 void Interpreter::visit(std::shared_ptr<ASTProgramNode> astnode) {
@@ -217,8 +224,13 @@ void Interpreter::visit(std::shared_ptr<ASTAssignmentNode> astnode) {
 
 	// finds assignment variable
 	auto name_space = get_namespace();
-	std::shared_ptr<RuntimeVariable> variable = std::dynamic_pointer_cast<RuntimeVariable>(find_inner_most_variable(prg, name_space, astnode->identifier));
+	std::shared_ptr<RuntimeVariable> variable = std::dynamic_pointer_cast<RuntimeVariable>(find_inner_most_variable(prg, name_space, astnode->identifier, astnode->address, frame_scopes()));
 	RuntimeValue* value = access_value(variable->get_value(), astnode->identifier_vector);
+	// a packed element is read into a copy, compound operations write it back afterwards
+	RuntimeValue* packed_owner = packed_access_owner;
+	size_t packed_index = packed_access_index;
+	RootGuard owner_root(gc, packed_owner);
+	RootGuard element_root(gc, packed_owner ? value : nullptr);
 
 	// evaluate assignment expression
 	astnode->expr->accept(this);
@@ -275,6 +287,10 @@ void Interpreter::visit(std::shared_ptr<ASTAssignmentNode> astnode) {
 			RuntimeOperations::normalize_type(variable.get(), new_value);
 			// do value/sub value operation
 			RuntimeOperations::do_operation(astnode->op, value, new_value, evaluate_access_vector_ptr, false, pos);
+
+			if (packed_owner) {
+				packed_owner->update_packed_element(packed_index, value);
+			}
 		}
 	}
 
@@ -287,34 +303,27 @@ void Interpreter::visit(std::shared_ptr<ASTReturnNode> astnode) {
 	auto name_space = get_namespace();
 
 	if (astnode->expr) {
-		// gets the current function return
-		TypeDefinition curr_func_ret_type = current_function.top();
-		auto curr_func_call_id_vector = current_function_call_identifier_vector.top();
+		// gets the current function return, the frame itself can move while the expression makes calls
+		const auto& curr_func = *call_stack.back().function;
+		const auto& curr_func_ret_type = static_cast<const TypeDefinition&>(curr_func);
+		const auto& curr_func_call_id_vector = *call_stack.back().identifier_vector;
 		// evaluates return expression
 		astnode->expr->accept(this);
-		// keeps return value
-		RuntimeValue* returned_value = current_expression_value;
 
-		// evaluates access vector
-		RuntimeValue* value = access_value(current_expression_value, curr_func_call_id_vector);
-		// handle string char access
-		if (is_string(value->type) && curr_func_call_id_vector.back().access_vector.size() > 0 && has_string_access) {
-			has_string_access = false;
-			std::string str = value->get_s();
-			curr_func_call_id_vector.back().access_vector[curr_func_call_id_vector.back().access_vector.size() - 1]->accept(this);
-			auto pos = value->get_i();
+		// a tail call is checked by the call that runs it
+		if (!pending_tail_call) {
+			// keeps return value
+			RuntimeValue* returned_value = current_expression_value;
+			RuntimeValue* value = access_returned_value(returned_value, curr_func_call_id_vector);
 
-			value = alocate_value(new RuntimeValue(flx_char(str[pos])));
-		}
+			// check types match
+			if (!TypeDefinition::is_any_or_match_type(curr_func_ret_type, *returned_value, evaluate_access_vector_ptr)) {
+				ExceptionHandler::throw_return_type_err(curr_func.identifier,
+					curr_func_ret_type, *returned_value, evaluate_access_vector_ptr);
+			}
 
-		// check types match
-		if (!TypeDefinition::is_any_or_match_type(curr_func_ret_type, *returned_value, evaluate_access_vector_ptr)) {
-			ExceptionHandler::throw_return_type_err(current_function.top().identifier,
-				curr_func_ret_type, *returned_value, evaluate_access_vector_ptr);
+			current_expression_value = value;
 		}
-
-		// check if it's reference
-		current_expression_value = value->use_ref ? value : alocate_value(new RuntimeValue(value));
 	}
 	else {
 		current_expression_value = alocate_value(new RuntimeValue(Type::T_UNDEFINED));
@@ -336,7 +345,8 @@ void Interpreter::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
 	const auto& caller_program = current_program.top();
 	std::string name_space = get_namespace();
 	std::string identifier = astnode->identifier;
-	std::vector<Identifier> identifier_vector = astnode->identifier_vector;
+	const std::vector<Identifier>* identifier_vector = &astnode->identifier_vector;
+	std::vector<Identifier> value_identifier_vector;
 	bool strict = true;
 	std::vector<TypeDefinition*> signature;
 	std::shared_ptr<std::vector<RuntimeValue*>> function_arguments = std::make_shared<std::vector<RuntimeValue*>>();
@@ -358,60 +368,115 @@ void Interpreter::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
 		signature.push_back(pvalue);
 	}
 
-	std::shared_ptr<Scope> func_scope = get_inner_most_function_scope(caller_program, name_space, identifier, &signature, evaluate_access_vector_ptr, strict);
+	std::shared_ptr<Scope> func_scope = nullptr;
+	FunctionDefinition* declfun = nullptr;
+
+	if (const auto cached = astnode->call_cache.find(signature)) {
+		func_scope = cached->scope.lock();
+		declfun = cached->function;
+	}
+	if (!func_scope) {
+		func_scope = get_inner_most_function_scope(caller_program, name_space, identifier, &signature, evaluate_access_vector_ptr, strict);
+		if (!func_scope) {
+			strict = false;
+			func_scope = get_inner_most_function_scope(caller_program, name_space, identifier, &signature, evaluate_access_vector_ptr, strict);
+		}
+		if (func_scope) {
+			declfun = &func_scope->find_declared_function(identifier, &signature, evaluate_access_vector_ptr, strict);
+			astnode->call_cache.insert(signature, func_scope, *declfun);
+		}
+	}
+
 	if (func_scope) {
 		current_program.push(func_scope->owner);
 		pop_program = true;
 		name_space = func_scope->owner->name_space;
 	}
 	else {
-		strict = false;
+		// function values are resolved on every call
+		auto var_scope = get_inner_most_variable_scope(caller_program, name_space, identifier);
+		if (!var_scope) {
+			std::string func_name = ExceptionHandler::buid_signature(identifier, signature, evaluate_access_vector_ptr);
+			throw std::runtime_error("function '" + func_name + "' was never declared");
+		}
+		auto var = std::dynamic_pointer_cast<RuntimeVariable>(var_scope->find_declared_variable(identifier));
+		name_space = var->value->get_fun().first;
+		identifier = var->value->get_fun().second;
+		value_identifier_vector = std::vector<Identifier>{ Identifier(identifier) };
+		identifier_vector = &value_identifier_vector;
 		func_scope = get_inner_most_function_scope(caller_program, name_space, identifier, &signature, evaluate_access_vector_ptr, strict);
-		if (func_scope) {
-			current_program.push(func_scope->owner);
-			pop_program = true;
-			name_space = func_scope->owner->name_space;
-		}
-		else {
-			auto var_scope = get_inner_most_variable_scope(caller_program, name_space, identifier);
-			if (!var_scope) {
-				std::string func_name = ExceptionHandler::buid_signature(identifier, signature, evaluate_access_vector_ptr);
-				throw std::runtime_error("function '" + func_name + "' was never declared");
-			}
-			auto var = std::dynamic_pointer_cast<RuntimeVariable>(var_scope->find_declared_variable(identifier));
-			name_space = var->value->get_fun().first;
-			identifier = var->value->get_fun().second;
-			identifier_vector = std::vector<Identifier>{ Identifier(identifier) };
-			func_scope = get_inner_most_function_scope(caller_program, name_space, identifier, &signature, evaluate_access_vector_ptr, strict);
-			if (!func_scope) {
-				std::string func_name = ExceptionHandler::buid_signature(identifier, signature, evaluate_access_vector_ptr);
-				throw std::runtime_error("function '" + func_name + "' was never declared");
-			}
+		if (!func_scope) {
+			std::string func_name = ExceptionHandler::buid_signature(identifier, signature, evaluate_access_vector_ptr);
+			throw std::runtime_error("function '" + func_name + "' was never declared");
 		}
+		declfun = &func_scope->find_declared_function(identifier, &signature, evaluate_access_vector_ptr, strict);
 	}
 
-	auto& declfun = func_scope->find_declared_function(identifier, &signature, evaluate_access_vector_ptr, strict);
-
 	if (!pop) {
 		// function actualy is in another namespace
 		pop = push_namespace(name_space);
 	}
 
-	current_function.push(declfun);
-	current_function_defined_parameters.push(declfun.parameters);
-	current_this_name.push(identifier);
-	current_function_signature.push(signature);
-	current_function_call_identifier_vector.push(identifier_vector);
-	current_function_calling_arguments.push(*function_arguments);
+	// the function returning this call leaves its frame to it
+	if (astnode->is_tail_call && !call_stack.empty()) {
+		tail_call = TailCall{ declfun, identifier, function_arguments, pop_program ? func_scope->owner : nullptr, get_namespace() };
+		pending_tail_call = true;
+		current_expression_value = alocate_value(new RuntimeValue(Type::T_UNDEFINED));
+
+		if (pop_program) {
+			current_program.pop();
+		}
+
+		pop_namespace(pop);
+		return;
+	}
+
+	call_stack.push_back(CallFrame{ declfun, &identifier, identifier_vector, function_arguments.get(), true });
+
+	declfun->block->accept(this);
+
+	// tail calls run one after another in this frame, so their depth does not grow the stack
+	if (pending_tail_call) {
+		const auto tail_identifier_vector = std::vector<Identifier>{ Identifier(identifier) };
+		std::vector<const FunctionDefinition*> replaced_functions;
+
+		while (pending_tail_call) {
+			pending_tail_call = false;
+			auto next = std::move(tail_call);
+
+			replaced_functions.push_back(call_stack.back().function);
+			gc.remove_root_container(function_arguments);
+			function_arguments = next.arguments;
+			identifier = next.identifier;
+
+			if (next.program) {
+				current_program.push(next.program);
+			}
+			auto pop_tail = push_namespace(next.name_space);
+
+			call_stack.back() = CallFrame{ next.function, &identifier, &tail_identifier_vector, function_arguments.get(), true };
+			next.function->block->accept(this);
+
+			pop_namespace(pop_tail);
+			if (next.program) {
+				current_program.pop();
+			}
+		}
+
+		// the returned value is checked against every function it was returned through
+		RuntimeValue* returned_value = current_expression_value;
+		for (auto it = replaced_functions.rbegin(); it != replaced_functions.rend(); ++it) {
+			const auto& replaced_function = **it;
+			if (!TypeDefinition::is_any_or_match_type(replaced_function, *returned_value, evaluate_access_vector_ptr)) {
+				ExceptionHandler::throw_return_type_err(replaced_function.identifier,
+					replaced_function, *returned_value, evaluate_access_vector_ptr);
+			}
+		}
 
-	// it's not a stack cause it's one shot use, right it reachs block it's cleaned
-	function_call_name = identifier;
-	declfun.block->accept(this);
+		current_expression_value = access_returned_value(returned_value, *identifier_vector);
+	}
 
-	current_function.pop();
-	current_function_call_identifier_vector.pop();
-	current_function_signature.pop();
-	current_this_name.pop();
+	call_stack.pop_back();
 	gc.remove_root_container(function_arguments);
 
 	if (pop_program) {
@@ -424,7 +489,7 @@ void Interpreter::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
 void Interpreter::visit(std::shared_ptr<ASTBuiltinCallNode> astnode) {
 	set_curr_pos(astnode->row, astnode->col);
 	builtin_functions[astnode->identifier]();
-	current_expression_value = access_value(current_expression_value, current_function_call_identifier_vector.top());
+	current_expression_value = access_value(current_expression_value, *call_stack.back().identifier_vector);
 }
 
 void Interpreter::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode) {
@@ -432,12 +497,11 @@ void Interpreter::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode) {
 	auto pop = push_namespace(astnode->type_name_space);
 	const auto& name_space = get_namespace();
 
-	try {
-		// if its already declared, it's a block definition
-		auto& declfun = scopes[name_space].back()->find_declared_function(astnode->identifier, &astnode->parameters, evaluate_access_vector_ptr, true);
-		declfun.block = astnode->block;
+	// if its already declared, it's a block definition
+	if (auto declfun = scopes[name_space].back()->find_function(astnode->identifier, &astnode->parameters, evaluate_access_vector_ptr, true)) {
+		declfun->block = astnode->block;
 	}
-	catch (...) {
+	else {
 		auto& block = astnode->block;
 
 		// if node not has block and it's a builtin, it's create a builtin executor
@@ -472,12 +536,17 @@ void Interpreter::visit(std::shared_ptr<ASTBlockNode> astnode) {
 	const auto& name_space = get_namespace();
 	const auto& prg = current_program.top();
 
-	// the one use function_call_name
-	scopes[name_space].push_back(std::make_shared<Scope>(prg, function_call_name));
-	function_call_name = "";
-
-	// declare all parameters in block if its a function
-	declare_function_block_parameters(name_space);
+	// the first block of a call is the function scope, named after it for the return flow
+	if (!call_stack.empty() && call_stack.back().pending_block) {
+		auto& frame = call_stack.back();
+		frame.pending_block = false;
+		frame.scopes = &scopes[name_space];
+		frame.scopes->push_back(std::make_shared<Scope>(prg, *frame.identifier));
+		declare_function_block_parameters(frame);
+	}
+	else {
+		scopes[name_space].push_back(std::make_shared<Scope>(prg));
+	}
 
 	// executes block 
 	for (auto& stmt : astnode->statements) {
@@ -505,7 +574,7 @@ void Interpreter::visit(std::shared_ptr<ASTBlockNode> astnode) {
 	}
 
 	scopes[name_space].pop_back();
-	gc.collect();
+	gc.maybe_collect();
 }
 
 void Interpreter::visit(std::shared_ptr<ASTExitNode> astnode) {
@@ -559,15 +628,11 @@ void Interpreter::visit(std::shared_ptr<ASTSwitchNode> astnode) {
 		}
 	}
 
-	long long pos;
-	try {
-		// if has and match condition
-		auto hash = astnode->condition->hash(this);
-		pos = astnode->parsed_case_blocks.at(hash);
-	}
-	catch (...) {
-		// else we go to default block
-		pos = astnode->default_block;
+	// if has and match condition, else we go to default block
+	long long pos = astnode->default_block;
+	auto case_block = astnode->parsed_case_blocks.find(astnode->condition->hash(this));
+	if (case_block != astnode->parsed_case_blocks.end()) {
+		pos = case_block->second;
 	}
 
 	// executes block
@@ -599,7 +664,7 @@ void Interpreter::visit(std::shared_ptr<ASTSwitchNode> astnode) {
 
 	scopes[name_space].pop_back();
 	--is_switch;
-	gc.collect();
+	gc.maybe_collect();
 }
 
 void Interpreter::visit(std::shared_ptr<ASTElseIfNode> astnode) {
@@ -715,7 +780,7 @@ void Interpreter::visit(std::shared_ptr<ASTForNode> astnode) {
 
 	scopes[name_space].pop_back();
 	--is_loop;
-	gc.collect();
+	gc.maybe_collect();
 }
 
 void Interpreter::visit(std::shared_ptr<ASTForEachNode> astnode) {
@@ -735,18 +800,26 @@ void Interpreter::visit(std::shared_ptr<ASTForEachNode> astnode) {
 	// get as declaration node
 	auto itdecl = std::dynamic_pointer_cast<ASTDeclarationNode>(astnode->itdecl);
 
+	// loop variables are created once and rebound to each element
+	std::shared_ptr<RuntimeVariable> it_var = nullptr;
+	std::shared_ptr<RuntimeVariable> key_var = nullptr;
+
 	switch (current_expression_value->type) {
 	case Type::T_ARRAY: {
-		// if the collection is an array
-		const auto& colletion = current_expression_value->get_arr();
-		for (size_t i = 0; i < colletion.size(); ++i) {
-			auto val = colletion[i];
+		// if the collection is an array, iterated as a copy since the body may change it
+		const RuntimeValue colletion = RuntimeValue(current_expression_value);
+		// elements of an already checked scalar type skip the declaration type check
+		auto checked_type = Type::T_UNDEFINED;
+		RuntimeValue scratch;
+		for (size_t i = 0; i < colletion.get_arr_size(); ++i) {
+			auto val = const_cast<RuntimeValue*>(colletion.get_element(i, scratch));
+			if (!val->use_ref) {
+				val = alocate_value(new RuntimeValue(val));
+			}
 
-			// declare each valueat meta block
-			auto exnode = std::make_shared<ASTValueNode>(val, astnode->row, astnode->col);
-			itdecl->expr = exnode;
-			itdecl->accept(this);
-			itdecl->expr = nullptr;
+			const auto element_type = val->type;
+			bind_foreach_variable(it_var, *itdecl, val, element_type != checked_type);
+			checked_type = is_array(element_type) || is_struct(element_type) || is_function(element_type) ? Type::T_UNDEFINED : element_type;
 
 			astnode->block->accept(this);
 
@@ -773,12 +846,9 @@ void Interpreter::visit(std::shared_ptr<ASTForEachNode> astnode) {
 	case Type::T_STRING: {
 		// if the collection is a string
 		const auto& colletion = current_expression_value->get_s();
-		for (auto val : colletion) {
-			// declare each valueat meta block
-			auto exnode = std::make_shared<ASTValueNode>(alocate_value(new RuntimeValue(flx_char(val))), astnode->row, astnode->col);
-			itdecl->expr = exnode;
-			itdecl->accept(this);
-			itdecl->expr = nullptr;
+		for (size_t i = 0; i < colletion.size(); ++i) {
+			auto val = alocate_value(new RuntimeValue(flx_char(colletion[i])));
+			bind_foreach_variable(it_var, *itdecl, val, i == 0);
 
 			astnode->block->accept(this);
 
@@ -803,34 +873,51 @@ void Interpreter::visit(std::shared_ptr<ASTForEachNode> astnode) {
 		break;
 	}
 	case Type::T_STRUCT: {
-		// if the collection is a struct
-		const auto& colletion = current_expression_value->get_str();
-		for (const auto& val : colletion) {
-			auto key = std::make_shared<ASTLiteralNode<flx_string>>(flx_string(val.first), astnode->row, astnode->col);
-			auto value = std::make_shared<ASTValueNode>(val.second, astnode->row, astnode->col);
+		// if the collection is a struct, iterated as a copy since the body may change it
+		const flx_struct colletion = current_expression_value->get_str();
 
-			// when handling structs, we have a second type of declaration: unpacked declaration
-			// so if itdecl is null, it's a unpacked [key, value]
-			if (itdecl) {
-				std::map<std::string, std::shared_ptr<ASTExprNode>> values = { { "key", key }, { "value", value } };
-				auto exnode = std::make_shared<ASTStructConstructorNode>("Pair", language_namespace, values, astnode->row, astnode->col);
-				itdecl->expr = exnode;
-				itdecl->accept(this);
-				itdecl->expr = nullptr;
+		// when handling structs, we have a second type of declaration: unpacked declaration
+		// so if itdecl is null, it's a unpacked [key, value]
+		const auto idnode = std::dynamic_pointer_cast<ASTUnpackedDeclarationNode>(astnode->itdecl);
+		if (!itdecl && idnode && idnode->declarations.size() != 2) {
+			// expect a 2 sized unpacked declaration
+			throw std::runtime_error("invalid number of values");
+		}
 
+		// the pair definition is looked up once, each pair is then built directly
+		StructureDefinition pair_type;
+		if (itdecl && !colletion.empty()) {
+			set_curr_pos(astnode->row, astnode->col);
+			auto pop = push_namespace(language_namespace);
+			pair_type = find_inner_most_struct(prg, get_namespace(), "Pair");
+			pop_namespace(pop);
+		}
+
+		bool first = true;
+		for (const auto& val : colletion) {
+			auto key = alocate_value(new RuntimeValue(flx_string(val.first)));
+			auto value = val.second;
+			if (!value->use_ref) {
+				value = alocate_value(new RuntimeValue(value));
 			}
-			else if (const auto idnode = std::dynamic_pointer_cast<ASTUnpackedDeclarationNode>(astnode->itdecl)) {
-				// expect a 2 sized unpacked declaration
-				if (idnode->declarations.size() != 2) {
-					throw std::runtime_error("invalid number of values");
-				}
 
-				idnode->declarations[0]->expr = key;
-				idnode->declarations[1]->expr = value;
-				idnode->accept(this);
-				idnode->declarations[0]->expr = nullptr;
-				idnode->declarations[1]->expr = nullptr;
+			if (itdecl) {
+				flx_struct pair = { { "key", key }, { "value", value } };
+				for (const auto& member : pair_type.variables) {
+					if (!pair.contains(member.first)) {
+						RuntimeValue* member_value = alocate_value(new RuntimeValue(member.second.type));
+						member_value->set_null();
+						pair[member.first] = member_value;
+					}
+				}
+				// every pair has the same type, so it is checked only once
+				bind_foreach_variable(it_var, *itdecl, alocate_value(new RuntimeValue(pair, "Pair", language_namespace)), first);
+			}
+			else if (idnode) {
+				bind_foreach_variable(key_var, *idnode->declarations[0], key, first);
+				bind_foreach_variable(it_var, *idnode->declarations[1], value, true);
 			}
+			first = false;
 
 			astnode->block->accept(this);
 
@@ -860,7 +947,31 @@ void Interpreter::visit(std::shared_ptr<ASTForEachNode> astnode) {
 
 	scopes[name_space].pop_back();
 	--is_loop;
-	gc.collect();
+	gc.maybe_collect();
+}
+
+void Interpreter::bind_foreach_variable(std::shared_ptr<RuntimeVariable>& variable, const ASTDeclarationNode& decl, RuntimeValue* value, bool check_type) {
+	if (!variable) {
+		variable = std::make_shared<RuntimeVariable>(decl.identifier, decl.type,
+			decl.array_type, decl.dim,
+			decl.type_name, decl.type_name_space);
+		gc.add_var_root(variable);
+		scopes[get_namespace()].back()->declare_variable(decl.identifier, variable);
+	}
+	variable->set_value(value);
+
+	// validate assignment type
+	if (check_type && !is_undefined(value->type)
+		&& (!TypeDefinition::is_any_or_match_type(*variable, *value, evaluate_access_vector_ptr) ||
+			is_array(variable->type) && !is_any(variable->array_type)
+			&& !TypeDefinition::match_type(*variable, *value, evaluate_access_vector_ptr, false, true))) {
+		ExceptionHandler::throw_declaration_type_err(decl.identifier, *variable, *value, evaluate_access_vector_ptr);
+	}
+
+	check_build_array(value, decl.dim);
+
+	// normalize string and number types
+	RuntimeOperations::normalize_type(variable.get(), value);
 }
 
 void Interpreter::visit(std::shared_ptr<ASTTryCatchNode> astnode) {
@@ -869,17 +980,18 @@ void Interpreter::visit(std::shared_ptr<ASTTryCatchNode> astnode) {
 	const auto& name_space = get_namespace();
 	const auto& prg = current_program.top();
 
-	try {
-		scopes[name_space].push_back(std::make_shared<Scope>(prg));
+	// no extra scope around the try block, so lexical addresses match the semantic analysis
+	const auto scope_depth = scopes[name_space].size();
+	const auto call_depth = call_stack.size();
 
+	try {
 		astnode->try_block->accept(this);
-
-		scopes[name_space].pop_back();
-		gc.collect();
+		gc.maybe_collect();
 	}
 	catch (std::exception ex) {
-		scopes[name_space].pop_back();
-		gc.collect();
+		scopes[name_space].resize(scope_depth);
+		call_stack.resize(call_depth);
+		gc.maybe_collect();
 
 		scopes[name_space].push_back(std::make_shared<Scope>(prg));
 
@@ -910,7 +1022,7 @@ void Interpreter::visit(std::shared_ptr<ASTTryCatchNode> astnode) {
 
 		astnode->catch_block->accept(this);
 		scopes[name_space].pop_back();
-		gc.collect();
+		gc.maybe_collect();
 	}
 }
 
@@ -927,7 +1039,7 @@ void Interpreter::visit(std::shared_ptr<ASTThrowNode> astnode) {
 			throw std::runtime_error("expected flx::Exception not " + ExceptionHandler::buid_type_str(*current_expression_value, evaluate_access_vector_ptr));
 		}
 
-		throw std::exception(current_expression_value->get_str()["error"]->get_s().c_str());
+		throw std::exception(current_expression_value->get_str().at("error")->get_s().c_str());
 	}
 	// handle bare string
 	else if (is_string(current_expression_value->type)) {
@@ -1067,6 +1179,9 @@ void Interpreter::visit(std::shared_ptr<ASTArrayConstructorNode> astnode) {
 
 	// initialize raw array
 	flx_array arr = flx_array(astnode->values.size());
+	// scalars of a single type are stored packed, the array is boxed when an element does not fit
+	PackedArray packed_arr(Type::T_UNDEFINED);
+	bool packed = astnode->values.size() > 0;
 
 	// clean array type on start
 	if (current_expression_array_dim.size() == 0) {
@@ -1102,6 +1217,20 @@ void Interpreter::visit(std::shared_ptr<ASTArrayConstructorNode> astnode) {
 			}
 		}
 
+		if (packed) {
+			if (i == 0 && current_expression_value->is_packable()) {
+				packed_arr = PackedArray(current_expression_value->type);
+			}
+			if (packed_arr.push_back(current_expression_value)) {
+				continue;
+			}
+			packed = false;
+			for (size_t j = 0; j < i; ++j) {
+				arr[j] = alocate_value(new RuntimeValue());
+				packed_arr.read(j, arr[j]);
+			}
+		}
+
 		// check if it's a reference
 		RuntimeValue* arr_value = current_expression_value;
 		if (!current_expression_value->use_ref) {
@@ -1114,8 +1243,10 @@ void Interpreter::visit(std::shared_ptr<ASTArrayConstructorNode> astnode) {
 	// as size by dimension is fixed, it's not necessary to check after max (max nested deep)
 	is_max = true;
 
-	current_expression_value = alocate_value(
-		new RuntimeValue(arr, current_expression_array_type.type, current_expression_array_dim,
+	current_expression_value = alocate_value(packed
+		? new RuntimeValue(std::move(packed_arr), current_expression_array_type.type, current_expression_array_dim,
+			current_expression_array_type.type_name, current_expression_array_type.type_name_space)
+		: new RuntimeValue(arr, current_expression_array_type.type, current_expression_array_dim,
 			current_expression_array_type.type_name, current_expression_array_type.type_name_space)
 	);
 
@@ -1145,16 +1276,20 @@ void Interpreter::visit(std::shared_ptr<ASTStructConstructorNode> astnode) {
 	const auto& prg = current_program.top();
 
 	auto name_space = get_namespace();
-	auto type_struct = find_inner_most_struct(prg, name_space, astnode->type_name);
+	const auto& type_struct = find_inner_most_struct(prg, name_space, astnode->type_name);
 
+	// fields are laid out in declaration order, so every value built here shares the layout of its type
 	auto str = flx_struct();
+	for (const auto& struct_var_def : type_struct.variables) {
+		str[struct_var_def.first] = nullptr;
+	}
 
 	for (auto& expr : astnode->values) {
 		// check it is a member
 		if (type_struct.variables.find(expr.first) == type_struct.variables.end()) {
 			ExceptionHandler::throw_struct_member_err(astnode->name_space, astnode->type_name, expr.first);
 		}
-		VariableDefinition var_type_struct = type_struct.variables[expr.first];
+		const auto& var_type_struct = type_struct.variables.at(expr.first);
 
 		expr.second->accept(this);
 
@@ -1188,7 +1323,7 @@ void Interpreter::visit(std::shared_ptr<ASTStructConstructorNode> astnode) {
 
 	// declare rest values as null
 	for (auto& struct_var_def : type_struct.variables) {
-		if (str.find(struct_var_def.first) == str.end()) {
+		if (!str[struct_var_def.first]) {
 			RuntimeValue* str_value = alocate_value(new RuntimeValue(struct_var_def.second.type));
 			str_value->set_null();
 			str[struct_var_def.first] = str_value;
@@ -1205,8 +1340,8 @@ void Interpreter::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
 	auto pop = push_namespace(astnode->name_space);
 	auto name_space = get_namespace();
 	const auto& prg = current_program.top();
-	try {
-		auto variable = std::dynamic_pointer_cast<RuntimeVariable>(find_inner_most_variable(prg, name_space, astnode->identifier));
+	auto variable = std::dynamic_pointer_cast<RuntimeVariable>(lookup_inner_most_variable(prg, name_space, astnode->identifier, astnode->address, frame_scopes()));
+	if (variable) {
 		auto sub_val = access_value(variable->get_value(), astnode->identifier_vector);
 		sub_val->reset_ref();
 
@@ -1222,60 +1357,62 @@ void Interpreter::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
 			char_value->set(flx_char(str[pos]));
 			current_expression_value = char_value;
 		}
+		pop_namespace(pop);
+		return;
 	}
-	catch (...) {
-		const auto& dim = astnode->identifier_vector[0].access_vector;
-		auto type = Type::T_UNDEFINED;
-		auto expression_value = alocate_value(new RuntimeValue(Type::T_UNDEFINED));
 
-		if (astnode->identifier == "bool") {
-			type = Type::T_BOOL;
-		}
-		else if (astnode->identifier == "int") {
-			type = Type::T_INT;
-		}
-		else if (astnode->identifier == "float") {
-			type = Type::T_FLOAT;
-		}
-		else if (astnode->identifier == "char") {
-			type = Type::T_CHAR;
-		}
-		else if (astnode->identifier == "string") {
-			type = Type::T_STRING;
-		}
-		else if (astnode->identifier == "function") {
-			type = Type::T_FUNCTION;
-		}
+	// not a variable, so it is a type, struct or function name
+	const auto& dim = astnode->identifier_vector[0].access_vector;
+	auto type = Type::T_UNDEFINED;
+	auto expression_value = alocate_value(new RuntimeValue(Type::T_UNDEFINED));
 
-		if (is_undefined(type)) {
-			std::shared_ptr<Scope> curr_scope = get_inner_most_struct_definition_scope(prg, name_space, astnode->identifier);
+	if (astnode->identifier == "bool") {
+		type = Type::T_BOOL;
+	}
+	else if (astnode->identifier == "int") {
+		type = Type::T_INT;
+	}
+	else if (astnode->identifier == "float") {
+		type = Type::T_FLOAT;
+	}
+	else if (astnode->identifier == "char") {
+		type = Type::T_CHAR;
+	}
+	else if (astnode->identifier == "string") {
+		type = Type::T_STRING;
+	}
+	else if (astnode->identifier == "function") {
+		type = Type::T_FUNCTION;
+	}
+
+	if (is_undefined(type)) {
+		std::shared_ptr<Scope> curr_scope = get_inner_most_struct_definition_scope(prg, name_space, astnode->identifier);
+		if (!curr_scope) {
+			curr_scope = get_inner_most_function_scope(prg, name_space, astnode->identifier, nullptr, evaluate_access_vector_ptr);
 			if (!curr_scope) {
-				curr_scope = get_inner_most_function_scope(prg, name_space, astnode->identifier, nullptr, evaluate_access_vector_ptr);
-				if (!curr_scope) {
-					throw std::runtime_error("identifier '" + astnode->identifier + "' was not declared");
-				}
-				auto fun = flx_function();
-				fun.first = name_space;
-				fun.second = astnode->identifier;
-				current_expression_value = alocate_value(new RuntimeValue(Type::T_FUNCTION));
-				current_expression_value->set(fun);
-				return;
+				throw std::runtime_error("identifier '" + astnode->identifier + "' was not declared");
 			}
-			type = Type::T_STRUCT;
-			auto str = flx_struct();
-			expression_value->set(str, astnode->identifier, name_space);
+			auto fun = flx_function();
+			fun.first = name_space;
+			fun.second = astnode->identifier;
+			current_expression_value = alocate_value(new RuntimeValue(Type::T_FUNCTION));
+			current_expression_value->set(fun);
+			return;
 		}
+		type = Type::T_STRUCT;
+		auto str = flx_struct();
+		expression_value->set(str, astnode->identifier, name_space);
+	}
 
-		expression_value->set_type(type);
+	expression_value->set_type(type);
 
-		if (dim.size() > 0) {
-			flx_array arr = build_array(dim, expression_value, dim.size() - 1);
+	if (dim.size() > 0) {
+		flx_array arr = build_array(dim, expression_value, dim.size() - 1);
 
-			current_expression_value = alocate_value(new RuntimeValue(arr, type, dim));
-		}
-		else {
-			current_expression_value = alocate_value(new RuntimeValue(expression_value));
-		}
+		current_expression_value = alocate_value(new RuntimeValue(arr, type, dim));
+	}
+	else {
+		current_expression_value = alocate_value(new RuntimeValue(expression_value));
 	}
 
 	pop_namespace(pop);
@@ -1335,10 +1472,10 @@ void Interpreter::visit(std::shared_ptr<ASTInNode> astnode) {
 	bool res = false;
 
 	if (is_array(current_expression_value->type)) {
-		flx_array expr_col = current_expression_value->get_arr();
+		RuntimeValue scratch;
 
-		for (size_t i = 0; i < expr_col.size(); ++i) {
-			res = RuntimeOperations::equals_value(&expr_val, expr_col[i]);
+		for (size_t i = 0; i < current_expression_value->get_arr_size(); ++i) {
+			res = RuntimeOperations::equals_value(&expr_val, current_expression_value->get_element(i, scratch));
 			if (res) {
 				break;
 			}
@@ -1373,7 +1510,11 @@ void Interpreter::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
 		}
 	}
 	else {
+		// a reference needs the element itself, so a packed array it is taken from gets boxed
+		bool box_access = box_array_access;
+		box_array_access = astnode->unary_op == "ref";
 		astnode->expr->accept(this);
+		box_array_access = box_access;
 
 		if (astnode->unary_op == "ref" || astnode->unary_op == "unref") {
 			if (astnode->unary_op == "unref") {
@@ -1546,7 +1687,7 @@ void Interpreter::visit(std::shared_ptr<ASTNullNode> astnode) {
 void Interpreter::visit(std::shared_ptr<ASTThisNode> astnode) {
 	set_curr_pos(astnode->row, astnode->col);
 
-	current_expression_value = alocate_value(new RuntimeValue(flx_string(current_this_name.top())));
+	current_expression_value = alocate_value(new RuntimeValue(flx_string(call_stack.empty() ? program_this_name : *call_stack.back().identifier)));
 }
 
 void Interpreter::visit(std::shared_ptr<ASTTypingNode> astnode) {
@@ -1611,22 +1752,23 @@ RuntimeValue* Interpreter::set_value(std::shared_ptr<RuntimeVariable> var, const
 		auto access_vector = evaluate_access_vector(identifier_vector[i].access_vector);
 
 		if (access_vector.size() > 0) {
-			auto current_val = value->get_raw_arr();
+			RuntimeValue* current_val = value;
 			size_t s = 0;
 			size_t access_pos = 0;
 
 			for (s = 0; s < access_vector.size() - 1; ++s) {
 				access_pos = access_vector.at(s);
+				const auto& current_arr = *current_val->get_raw_arr();
 
 				// break if it is a string, and the string access will be handled in identifier node evaluation
-				if (is_string((*current_val)[access_pos]->type)) {
-					(*current_val)[access_pos]->get_s()[access_vector.at(s + 1)] = new_value->get_c();
-					return (*current_val)[access_pos];
+				if (is_string(current_arr[access_pos]->type)) {
+					current_arr[access_pos]->get_s()[access_vector.at(s + 1)] = new_value->get_c();
+					return current_arr[access_pos];
 				}
-				if (access_pos >= current_val->size()) {
+				if (access_pos >= current_arr.size()) {
 					throw std::runtime_error("invalid array position access");
 				}
-				current_val = (*current_val)[access_pos]->get_raw_arr();
+				current_val = current_arr[access_pos];
 			}
 			if (is_string(value->type)) {
 				value->get_s()[access_vector.at(s)] = new_value->get_c();
@@ -1634,10 +1776,16 @@ RuntimeValue* Interpreter::set_value(std::shared_ptr<RuntimeVariable> var, const
 			}
 			access_pos = access_vector.at(s);
 			if (i == identifier_vector.size() - 1) {
-				(*current_val)[access_pos] = new_value;
+				if (access_pos >= current_val->get_arr_size()) {
+					throw std::runtime_error("invalid array position access");
+				}
+				// packed arrays take scalars of their element type without boxing them
+				if (!current_val->set_packed_element(access_pos, new_value)) {
+					(*current_val->get_raw_arr())[access_pos] = new_value;
+				}
 			}
 			else {
-				value = (*current_val)[access_pos];
+				value = (*current_val->get_raw_arr())[access_pos];
 			}
 		}
 
@@ -1656,10 +1804,10 @@ RuntimeValue* Interpreter::set_value(std::shared_ptr<RuntimeVariable> var, const
 			}
 
 			if (i == identifier_vector.size() - 1 && identifier_vector[i].access_vector.size() == 0) {
-				value->set_sub(identifier_vector[i].identifier, new_value);
+				value->set_sub(identifier_vector[i].identifier, new_value, identifier_vector[i].field_cache);
 			}
 			else {
-				value = value->get_str()[identifier_vector[i].identifier];
+				value = value->get_str().at(identifier_vector[i].identifier, identifier_vector[i].field_cache);
 			}
 		}
 	}
@@ -1671,30 +1819,43 @@ RuntimeValue* Interpreter::access_value(RuntimeValue* value, const std::vector<I
 	RuntimeValue* next_value = value;
 
 	auto access_vector = evaluate_access_vector(identifier_vector[i].access_vector);
+	packed_access_owner = nullptr;
 
 	if (access_vector.size() > 0) {
-		auto current_val = next_value->get_arr();
+		RuntimeValue* current_val = next_value;
 		size_t s = 0;
 		size_t access_pos = 0;
 
 		for (s = 0; s < access_vector.size() - 1; ++s) {
 			access_pos = access_vector.at(s);
+			const auto& current_arr = current_val->get_arr();
 			// break if it is a string, and the string access will be handled in identifier node evaluation
-			if (is_string(current_val[access_pos]->type)) {
+			if (is_string(current_arr[access_pos]->type)) {
 				has_string_access = true;
 				break;
 			}
-			if (access_pos >= current_val.size()) {
+			if (access_pos >= current_arr.size()) {
 				throw std::runtime_error("invalid array position access");
 			}
-			current_val = current_val[access_pos]->get_arr();
+			current_val = current_arr[access_pos];
 		}
 		if (is_string(next_value->type)) {
 			has_string_access = true;
 			return next_value;
 		}
 		access_pos = access_vector.at(s);
-		next_value = current_val[access_pos];
+		if (current_val->is_packed() && !box_array_access) {
+			if (access_pos >= current_val->get_arr_size()) {
+				throw std::runtime_error("invalid array position access");
+			}
+			// packed elements are read into a new value, the owner is kept to write it back
+			next_value = alocate_value(new RuntimeValue());
+			current_val->get_packed()->read(access_pos, next_value);
+			packed_access_owner = current_val;
+			packed_access_index = access_pos;
+			return next_value;
+		}
+		next_value = current_val->get_arr()[access_pos];
 	}
 
 	++i;
@@ -1711,7 +1872,7 @@ RuntimeValue* Interpreter::access_value(RuntimeValue* value, const std::vector<I
 			throw std::runtime_error("cannot reach '" + ss.str() + "', previous '" + identifier_vector[i - 1].identifier + "' value is null");
 		}
 
-		next_value = next_value->get_str()[identifier_vector[i].identifier];
+		next_value = next_value->get_str().at(identifier_vector[i].identifier, identifier_vector[i].field_cache);
 
 		if (identifier_vector[i].access_vector.size() > 0 || i < identifier_vector.size()) {
 			return access_value(next_value, identifier_vector, i);
@@ -1723,15 +1884,29 @@ RuntimeValue* Interpreter::access_value(RuntimeValue* value, const std::vector<I
 
 void Interpreter::check_build_array(RuntimeValue* new_value, std::vector<std::shared_ptr<ASTExprNode>> dim) {
 	if (is_array(new_value->type) && dim.size() > 0) {
-		auto arr = new_value->get_arr();
+		size_t size = new_value->get_arr_size();
 		bool has_array = false;
 		flx_array rarr = flx_array();
 
-		if (arr.size() == 1) {
+		if (size == 1) {
+			auto init_value = new_value->get_arr()[0];
+
+			// one dimensional arrays of scalars are filled packed
+			if (dim.size() == 1 && init_value->is_packable()) {
+				current_expression_array_type = *init_value;
+				dim[0]->accept(this);
+				new_value->set(build_packed_array(init_value, current_expression_value->get_i()),
+					current_expression_array_type.type,
+					current_expression_array_type.dim,
+					current_expression_array_type.type_name,
+					current_expression_array_type.type_name_space);
+				return;
+			}
+
 			has_array = true;
-			rarr = build_array(dim, arr[0], dim.size() - 1);
+			rarr = build_array(dim, init_value, dim.size() - 1);
 		}
-		else if (arr.size() == 0) {
+		else if (size == 0) {
 			has_array = true;
 			rarr = build_undefined_array(dim, dim.size() - 1);
 		}
@@ -1762,16 +1937,26 @@ flx_array Interpreter::build_array(const std::vector<std::shared_ptr<ASTExprNode
 		size = current_expression_value->get_i();
 	}
 
-	raw_arr = flx_array(size);
+	// the innermost rows of scalars are built packed, the outer elements share them until written
+	bool packed = dim.size() - 1 == i && i > 0 && init_value->is_packable();
+	PackedArray packed_arr(init_value->type);
 
-	for (size_t j = 0; j < size; ++j) {
-		auto val = alocate_value(new RuntimeValue(init_value));
+	if (packed) {
+		current_expression_array_type = *init_value;
+		packed_arr = build_packed_array(init_value, size);
+	}
+	else {
+		raw_arr = flx_array(size);
 
-		if (is_undefined(current_expression_array_type.type) || is_array(current_expression_array_type.type)) {
-			current_expression_array_type = *val;
-		}
+		for (size_t j = 0; j < size; ++j) {
+			auto val = alocate_value(new RuntimeValue(init_value));
 
-		raw_arr[j] = val;
+			if (is_undefined(current_expression_array_type.type) || is_array(current_expression_array_type.type)) {
+				current_expression_array_type = *val;
+			}
+
+			raw_arr[j] = val;
+		}
 	}
 
 	--i;
@@ -1785,8 +1970,11 @@ flx_array Interpreter::build_array(const std::vector<std::shared_ptr<ASTExprNode
 			--curr_dim_i;
 		}
 
-		auto val = alocate_value(new RuntimeValue(raw_arr, current_expression_array_type.array_type, curr_arr_dim,
-			current_expression_array_type.type_name, current_expression_array_type.type_name_space));
+		auto val = alocate_value(packed
+			? new RuntimeValue(std::move(packed_arr), current_expression_array_type.array_type, curr_arr_dim,
+				current_expression_array_type.type_name, current_expression_array_type.type_name_space)
+			: new RuntimeValue(raw_arr, current_expression_array_type.array_type, curr_arr_dim,
+				current_expression_array_type.type_name, current_expression_array_type.type_name_space));
 
 		return build_array(dim, val, i);
 	}
@@ -1794,6 +1982,17 @@ flx_array Interpreter::build_array(const std::vector<std::shared_ptr<ASTExprNode
 	return raw_arr;
 }
 
+PackedArray Interpreter::build_packed_array(const RuntimeValue* init_value, size_t size) {
+	PackedArray arr(init_value->type);
+	arr.data.reserve(size * PackedArray::element_size(init_value->type));
+
+	for (size_t j = 0; j < size; ++j) {
+		arr.push_back(init_value);
+	}
+
+	return arr;
+}
+
 flx_array Interpreter::build_undefined_array(const std::vector<std::shared_ptr<ASTExprNode>>& dim, long long i) {
 	flx_array raw_arr;
 
@@ -1934,44 +2133,60 @@ void Interpreter::declare_function_parameter(std::shared_ptr<Scope> scope, const
 	}
 }
 
-void Interpreter::declare_function_block_parameters(const std::string& name_space) {
-	auto& curr_scope = scopes[name_space].back();
+RuntimeValue* Interpreter::access_returned_value(RuntimeValue* value, const std::vector<Identifier>& identifier_vector) {
+	// evaluates access vector
+	RuntimeValue* accessed_value = access_value(value, identifier_vector);
+	// handle string char access
+	if (is_string(accessed_value->type) && identifier_vector.back().access_vector.size() > 0 && has_string_access) {
+		has_string_access = false;
+		std::string str = accessed_value->get_s();
+		identifier_vector.back().access_vector[identifier_vector.back().access_vector.size() - 1]->accept(this);
+		auto pos = accessed_value->get_i();
+
+		accessed_value = alocate_value(new RuntimeValue(flx_char(str[pos])));
+	}
+
+	// check if it's reference
+	return accessed_value->use_ref ? accessed_value : alocate_value(new RuntimeValue(accessed_value));
+}
+
+void Interpreter::declare_function_block_parameters(const CallFrame& frame) {
+	// default values can make calls that move the frame
+	const auto& parameters = frame.function->parameters;
+	const auto& arguments = *frame.arguments;
+	auto curr_scope = scopes[get_namespace()].back();
 	auto rest_name = std::string();
 	auto vec = std::vector<RuntimeValue*>();
 	size_t i = 0;
 
-	if (current_function_calling_arguments.size() == 0 || current_function_defined_parameters.size() == 0) {
-		return;
-	}
-
 	// adds function arguments
-	for (i = 0; i < current_function_calling_arguments.top().size(); ++i) {
-		auto current_function_calling_argument = current_function_calling_arguments.top()[i];
+	for (i = 0; i < arguments.size(); ++i) {
+		auto argument = arguments[i];
 
-		if (current_function_defined_parameters.top().size() > i) {
-			validates_reference_type_assignment(*current_function_defined_parameters.top()[i], current_function_calling_argument);
-			RuntimeOperations::normalize_type(current_function_defined_parameters.top()[i], current_function_calling_argument);
+		if (parameters.size() > i) {
+			validates_reference_type_assignment(*parameters[i], argument);
+			RuntimeOperations::normalize_type(parameters[i], argument);
 		}
 
 		// is reference : not reference
-		RuntimeValue* current_value = current_function_calling_argument;
-		if (!current_function_calling_argument->use_ref) {
-			current_value = alocate_value(new RuntimeValue(current_function_calling_argument));
+		RuntimeValue* current_value = argument;
+		if (!argument->use_ref) {
+			current_value = alocate_value(new RuntimeValue(argument));
 			current_value->ref.reset();
 		}
 
-		if (i >= current_function_defined_parameters.top().size()) {
+		if (i >= parameters.size()) {
 			vec.push_back(current_value);
 		}
 		else {
-			if (const auto decl = dynamic_cast<VariableDefinition*>(current_function_defined_parameters.top()[i])) {
+			if (const auto decl = dynamic_cast<VariableDefinition*>(parameters[i])) {
 				declare_function_parameter(curr_scope, decl->identifier, current_value);
 
 				// is rest
 				if (decl->is_rest) {
 					rest_name = decl->identifier;
 					// if is last parameter and is array
-					if (current_function_defined_parameters.top().size() - 1 == i
+					if (parameters.size() - 1 == i
 						&& is_array(current_value->type)) {
 						for (size_t i = 0; i < vec.size(); ++i) {
 							vec.push_back(current_value->get_arr()[i]);
@@ -1982,9 +2197,9 @@ void Interpreter::declare_function_block_parameters(const std::string& name_spac
 					}
 				}
 			}
-			else if (const auto decls = dynamic_cast<UnpackedVariableDefinition*>(current_function_defined_parameters.top()[i])) {
+			else if (const auto decls = dynamic_cast<UnpackedVariableDefinition*>(parameters[i])) {
 				for (auto& decl : decls->variables) {
-					auto sub_value = alocate_value(new RuntimeValue(current_value->get_str()[decl.identifier]));
+					auto sub_value = alocate_value(new RuntimeValue(current_value->get_str().at(decl.identifier)));
 					declare_function_parameter(curr_scope, decl.identifier, sub_value);
 				}
 			}
@@ -1992,8 +2207,8 @@ void Interpreter::declare_function_block_parameters(const std::string& name_spac
 	}
 
 	// adds default values
-	for (; i < current_function_defined_parameters.top().size(); ++i) {
-		if (const auto decl = dynamic_cast<VariableDefinition*>(current_function_defined_parameters.top()[i])) {
+	for (; i < parameters.size(); ++i) {
+		if (const auto decl = dynamic_cast<VariableDefinition*>(parameters[i])) {
 			if (decl->is_rest) {
 				break;
 			}
@@ -2016,9 +2231,10 @@ void Interpreter::declare_function_block_parameters(const std::string& name_spac
 		var->set_value(rest);
 		curr_scope->declare_variable(rest_name, var);
 	}
+}
 
-	current_function_defined_parameters.pop();
-	current_function_calling_arguments.pop();
+const std::vector<std::shared_ptr<Scope>>& Interpreter::frame_scopes() const {
+	return call_stack.empty() ? *program_scopes : *call_stack.back().scopes;
 }
 
 void Interpreter::build_args(const std::vector<std::string>& args) {
@@ -4,6 +4,7 @@
 #include <memory>
 #include <map>
 #include <stack>
+#include <vector>
 #include <functional>
 
 #include "types.hpp"
@@ -18,6 +19,32 @@ using namespace parser;
 using namespace gc;
 
 namespace visitor {
+
+	// activation of a called function, it points to data owned by the call and the declaration
+	class CallFrame {
+	public:
+		const FunctionDefinition* function;
+		// name seen by 'this' and access vector applied to the returned value
+		const std::string* identifier;
+		const std::vector<Identifier>* identifier_vector;
+		const std::vector<RuntimeValue*>* arguments;
+		// the first block of the call names its scope and declares the parameters
+		bool pending_block;
+		// scope stack of the function namespace, taken when the first block starts
+		std::vector<std::shared_ptr<Scope>>* scopes = nullptr;
+	};
+
+	// call returned in tail position, the call running the function that returns it executes it in the same frame
+	class TailCall {
+	public:
+		FunctionDefinition* function;
+		std::string identifier;
+		std::shared_ptr<std::vector<RuntimeValue*>> arguments;
+		// program and namespace pushed for the function body, the program is null when the call keeps the caller one
+		std::shared_ptr<ASTProgramNode> program;
+		std::string name_space;
+	};
+
 	class Interpreter : public Visitor, public MetaVisitor {
 	public:
 		std::map<std::string, std::function<void()>> builtin_functions;
@@ -28,14 +55,13 @@ namespace visitor {
 
 	private:
 		dim_eval_func_t evaluate_access_vector_ptr = std::bind(&Interpreter::evaluate_access_vector, this, std::placeholders::_1);
-		std::string function_call_name;
 		std::string return_from_function_name;
-		std::stack<std::vector<TypeDefinition*>> current_function_signature;
-		std::stack<std::vector<Identifier>> current_function_call_identifier_vector;
-		std::stack<FunctionDefinition> current_function;
-		std::stack<std::vector<TypeDefinition*>> current_function_defined_parameters;
-		std::stack<std::vector<RuntimeValue*>> current_function_calling_arguments;
-		std::stack<std::string> current_this_name;
+		std::vector<CallFrame> call_stack;
+		// 'this' and scope stack outside of functions
+		std::string program_this_name;
+		std::vector<std::shared_ptr<Scope>>* program_scopes = nullptr;
+		TailCall tail_call;
+		bool pending_tail_call = false;
 		size_t is_switch = 0;
 		size_t is_loop = 0;
 		bool continue_block = false;
@@ -45,6 +71,11 @@ namespace visitor {
 		bool executed_elif = false;
 		bool has_string_access = false;
 		bool exception = false;
+		// set while evaluating a 'ref' operand, element accesses box packed arrays instead of copying the element
+		bool box_array_access = false;
+		// packed array and position of the element copied by the last access_value, null otherwise
+		RuntimeValue* packed_access_owner = nullptr;
+		size_t packed_access_index = 0;
 
 		std::vector<std::shared_ptr<ASTExprNode>> current_expression_array_dim;
 		int current_expression_array_dim_max = 0;
@@ -61,7 +92,10 @@ namespace visitor {
 		std::vector<unsigned int> calculate_array_dim_size(const flx_array& arr);
 
 		void check_build_array(RuntimeValue* new_value, std::vector<std::shared_ptr<ASTExprNode>> dim);
+		// binds a foreach variable to the next element, the variable is declared on the first one
+		void bind_foreach_variable(std::shared_ptr<RuntimeVariable>& variable, const ASTDeclarationNode& decl, RuntimeValue* value, bool check_type);
 		flx_array build_array(const std::vector<std::shared_ptr<ASTExprNode>>& dim, RuntimeValue* init_value, long long i);
+		PackedArray build_packed_array(const RuntimeValue* init_value, size_t size);
 		flx_array build_undefined_array(const std::vector<std::shared_ptr<ASTExprNode>>& dim, long long i);
 
 		RuntimeValue* set_value(std::shared_ptr<RuntimeVariable> var, const std::vector<Identifier>& identifier_vector, RuntimeValue* new_value);
@@ -69,7 +103,9 @@ namespace visitor {
 
 		long long hash(RuntimeValue* value);
 
-		void declare_function_block_parameters(const std::string& name_space);
+		void declare_function_block_parameters(const CallFrame& frame);
+		const std::vector<std::shared_ptr<Scope>>& frame_scopes() const;
+		RuntimeValue* access_returned_value(RuntimeValue* value, const std::vector<Identifier>& identifier_vector);
 		void build_args(const std::vector<std::string>& args);
 
 		void set_curr_pos(unsigned int row, unsigned int col) override;
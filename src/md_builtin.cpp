@@ -67,7 +67,7 @@ void ModuleBuiltin::register_functions(visitor::Interpreter* visitor) {
 		auto& scope = visitor->scopes[default_namespace].back();
 		if (scope->already_declared_variable("args")) {
 			auto var = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("args"));
-			auto args = var->value->get_arr();
+			const auto& args = var->value->get_arr();
 
 			for (size_t i = 0; i < args.size(); ++i) {
 				std::cout << RuntimeOperations::parse_value_to_string(args[i]);
@@ -109,7 +109,7 @@ void ModuleBuiltin::register_functions(visitor::Interpreter* visitor) {
 		auto val = visitor->alocate_value(new RuntimeValue(Type::T_INT));
 
 		if (is_array(itval->type)) {
-			val->set(flx_int(itval->get_arr().size()));
+			val->set(flx_int(itval->get_arr_size()));
 		}
 		else {
 			val->set(flx_int(itval->get_s().size()));
@@ -201,7 +201,7 @@ void ModuleBuiltin::register_functions(VirtualMachine* vm) {
 		auto val = new RuntimeValue(Type::T_INT);
 
 		if (is_array(itval->type)) {
-			val->set(flx_int(itval->get_arr().size()));
+			val->set(flx_int(itval->get_arr_size()));
 		}
 		else {
 			val->set(flx_int(itval->get_s().size()));
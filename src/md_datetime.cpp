@@ -83,8 +83,8 @@ void ModuleDateTime::register_functions(visitor::Interpreter* visitor) {
 			std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("right_date_time"))->value
 		};
 
-		time_t lt = vals[0]->get_str()["timestamp"]->get_i();
-		time_t rt = vals[1]->get_str()["timestamp"]->get_i();
+		time_t lt = vals[0]->get_str().at("timestamp")->get_i();
+		time_t rt = vals[1]->get_str().at("timestamp")->get_i();
 		time_t t = difftime(lt, rt);
 		tm* tm = new struct tm();
 		gmtime_s(tm, &t);
@@ -100,7 +100,7 @@ void ModuleDateTime::register_functions(visitor::Interpreter* visitor) {
 			std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("format"))->value
 		};
 
-		time_t t = vals[0]->get_str()["timestamp"]->get_i();
+		time_t t = vals[0]->get_str().at("timestamp")->get_i();
 		std::string fmt = vals[1]->get_s();
 		tm* tm = new struct tm();
 		gmtime_s(tm, &t);
@@ -118,7 +118,7 @@ void ModuleDateTime::register_functions(visitor::Interpreter* visitor) {
 			std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("format"))->value
 		};
 
-		time_t t = vals[0]->get_str()["timestamp"]->get_i();
+		time_t t = vals[0]->get_str().at("timestamp")->get_i();
 		std::string fmt = vals[1]->get_s();
 		tm* tm = new struct tm();
 		localtime_s(tm, &t);
@@ -133,7 +133,7 @@ void ModuleDateTime::register_functions(visitor::Interpreter* visitor) {
 		auto& scope = visitor->scopes[language_namespace].back();
 		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("date_time"))->value;
 
-		time_t t = val->get_str()["timestamp"]->get_i();
+		time_t t = val->get_str().at("timestamp")->get_i();
 		tm* tm = new struct tm();
 		gmtime_s(tm, &t);
 		char buffer[26];
@@ -150,7 +150,7 @@ void ModuleDateTime::register_functions(visitor::Interpreter* visitor) {
 		auto& scope = visitor->scopes[language_namespace].back();
 		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("date_time"))->value;
 
-		time_t t = val->get_str()["timestamp"]->get_i();
+		time_t t = val->get_str().at("timestamp")->get_i();
 		tm* tm = new struct tm();
 		localtime_s(tm, &t);
 		char buffer[26];
@@ -63,7 +63,7 @@ void ModuleFiles::register_functions(visitor::Interpreter* visitor) {
 		if (!parser::is_void(val->type)) {
 			auto rval = visitor->alocate_value(new RuntimeValue(parser::Type::T_STRING));
 
-			std::fstream* fs = ((std::fstream*)val->get_str()[INSTANCE_ID_NAME]->get_i());
+			std::fstream* fs = ((std::fstream*)val->get_str().at(INSTANCE_ID_NAME)->get_i());
 
 			fs->seekg(0);
 
@@ -85,7 +85,7 @@ void ModuleFiles::register_functions(visitor::Interpreter* visitor) {
 		if (!parser::is_void(val->type)) {
 			auto rval = visitor->alocate_value(new RuntimeValue(parser::Type::T_STRING));
 
-			std::fstream* fs = ((std::fstream*)val->get_str()[INSTANCE_ID_NAME]->get_i());
+			std::fstream* fs = ((std::fstream*)val->get_str().at(INSTANCE_ID_NAME)->get_i());
 
 			std::string line;
 			std::getline(*fs, line);
@@ -103,7 +103,7 @@ void ModuleFiles::register_functions(visitor::Interpreter* visitor) {
 			auto rval = visitor->alocate_value(new RuntimeValue(parser::Type::T_ARRAY));
 			rval->set_arr_type(parser::Type::T_CHAR);
 
-			std::fstream* fs = ((std::fstream*)val->get_str()[INSTANCE_ID_NAME]->get_i());
+			std::fstream* fs = ((std::fstream*)val->get_str().at(INSTANCE_ID_NAME)->get_i());
 
 			fs->seekg(0);
 
@@ -115,15 +115,12 @@ void ModuleFiles::register_functions(visitor::Interpreter* visitor) {
 			// buffer to store readed data
 			char* buffer = new char[buffer_size];
 
-			flx_array arr = flx_array(buffer_size);
+			// bytes are kept packed, one char each
+			PackedArray arr = PackedArray(parser::Type::T_CHAR);
 
 			// read all bytes
 			if (fs->read(buffer, buffer_size)) {
-				for (size_t i = 0; i < buffer_size; ++i) {
-					RuntimeValue* val = visitor->alocate_value(new RuntimeValue(parser::Type::T_CHAR));
-					val->set(buffer[i]);
-					arr[i] = val;
-				}
+				arr.data.assign(buffer, buffer + buffer_size);
 			}
 			rval->set(arr, Type::T_CHAR, std::vector<std::shared_ptr<ASTExprNode>>());
 
@@ -142,7 +139,7 @@ void ModuleFiles::register_functions(visitor::Interpreter* visitor) {
 
 		RuntimeValue* cpfile = vals[0];
 		if (!parser::is_void(cpfile->type)) {
-			std::fstream* fs = ((std::fstream*)cpfile->get_str()[INSTANCE_ID_NAME]->get_i());
+			std::fstream* fs = ((std::fstream*)cpfile->get_str().at(INSTANCE_ID_NAME)->get_i());
 			*fs << vals[1]->get_s();
 		}
 		};
@@ -156,16 +153,16 @@ void ModuleFiles::register_functions(visitor::Interpreter* visitor) {
 
 		RuntimeValue* cpfile = vals[0];
 		if (!parser::is_void(cpfile->type)) {
-			std::fstream* fs = ((std::fstream*)cpfile->get_str()[INSTANCE_ID_NAME]->get_i());
+			std::fstream* fs = ((std::fstream*)cpfile->get_str().at(INSTANCE_ID_NAME)->get_i());
 
-			auto arr = vals[1]->get_arr();
+			RuntimeValue scratch;
 
-			std::streamsize buffer_size = arr.size();
+			std::streamsize buffer_size = vals[1]->get_arr_size();
 
 			char* buffer = new char[buffer_size];
 
 			for (size_t i = 0; i < buffer_size; ++i) {
-				buffer[i] = arr[i]->get_c();
+				buffer[i] = vals[1]->get_element(i, scratch)->get_c();
 			}
 
 			fs->write(buffer, sizeof(buffer));
@@ -178,7 +175,7 @@ void ModuleFiles::register_functions(visitor::Interpreter* visitor) {
 
 		if (!parser::is_void(val->type)) {
 			auto rval = visitor->alocate_value(new RuntimeValue(parser::Type::T_BOOL));
-			rval->set(flx_bool(((std::fstream*)val->get_str()[INSTANCE_ID_NAME]->get_i())->is_open()));
+			rval->set(flx_bool(((std::fstream*)val->get_str().at(INSTANCE_ID_NAME)->get_i())->is_open()));
 			visitor->current_expression_value = rval;
 		}
 		};
@@ -188,9 +185,9 @@ void ModuleFiles::register_functions(visitor::Interpreter* visitor) {
 		auto val = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("file"))->value;
 
 		if (!parser::is_void(val->type)) {
-			if (((std::fstream*)val->get_str()[INSTANCE_ID_NAME]->get_i())) {
-				((std::fstream*)val->get_str()[INSTANCE_ID_NAME]->get_i())->close();
-				((std::fstream*)val->get_str()[INSTANCE_ID_NAME]->get_i())->~basic_fstream();
+			if (((std::fstream*)val->get_str().at(INSTANCE_ID_NAME)->get_i())) {
+				((std::fstream*)val->get_str().at(INSTANCE_ID_NAME)->get_i())->close();
+				((std::fstream*)val->get_str().at(INSTANCE_ID_NAME)->get_i())->~basic_fstream();
 				val->set_null();
 			}
 		}
@@ -81,14 +81,14 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::runtime_error("Window is null");
 		}
-		if (!win->get_str()[INSTANCE_ID_NAME]->get_i()) {
+		if (!win->get_str().at(INSTANCE_ID_NAME)->get_i()) {
 			throw std::runtime_error("Window is corrupted");
 		}
 		int r, g, b;
-		r = (int)vals[1]->get_str()["r"]->get_i();
-		g = (int)vals[1]->get_str()["g"]->get_i();
-		b = (int)vals[1]->get_str()["b"]->get_i();
-		((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->clear_screen(RGB(r, g, b));
+		r = (int)vals[1]->get_str().at("r")->get_i();
+		g = (int)vals[1]->get_str().at("g")->get_i();
+		b = (int)vals[1]->get_str().at("b")->get_i();
+		((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->clear_screen(RGB(r, g, b));
 
 		};
 
@@ -100,10 +100,10 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::runtime_error("Window is null");
 		}
-		if (!win->get_str()[INSTANCE_ID_NAME]->get_i()) {
+		if (!win->get_str().at(INSTANCE_ID_NAME)->get_i()) {
 			throw std::runtime_error("Window is corrupted");
 		}
-		visitor->current_expression_value=visitor->alocate_value(new RuntimeValue(flx_int(((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->get_width())));
+		visitor->current_expression_value=visitor->alocate_value(new RuntimeValue(flx_int(((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->get_width())));
 
 		};
 
@@ -115,10 +115,10 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::runtime_error("Window is null");
 		}
-		if (!win->get_str()[INSTANCE_ID_NAME]->get_i()) {
+		if (!win->get_str().at(INSTANCE_ID_NAME)->get_i()) {
 			throw std::runtime_error("Window is corrupted");
 		}
-		visitor->current_expression_value = visitor->alocate_value(new RuntimeValue(flx_int(((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->get_height())));
+		visitor->current_expression_value = visitor->alocate_value(new RuntimeValue(flx_int(((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->get_height())));
 
 		};
 
@@ -135,16 +135,16 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::runtime_error("Window is null");
 		}
-		if (!win->get_str()[INSTANCE_ID_NAME]->get_i()) {
+		if (!win->get_str().at(INSTANCE_ID_NAME)->get_i()) {
 			throw std::runtime_error("Window is corrupted");
 		}
 		int x, y, r, g, b;
 		x = (int)vals[1]->get_i();
 		y = (int)vals[2]->get_i();
-		r = (int)vals[3]->get_str()["r"]->get_i();
-		g = (int)vals[3]->get_str()["g"]->get_i();
-		b = (int)vals[3]->get_str()["b"]->get_i();
-		((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->draw_pixel(x, y, RGB(r, g, b));
+		r = (int)vals[3]->get_str().at("r")->get_i();
+		g = (int)vals[3]->get_str().at("g")->get_i();
+		b = (int)vals[3]->get_str().at("b")->get_i();
+		((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->draw_pixel(x, y, RGB(r, g, b));
 
 		};
 
@@ -163,7 +163,7 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::runtime_error("Window is null");
 		}
-		if (!win->get_str()[INSTANCE_ID_NAME]->get_i()) {
+		if (!win->get_str().at(INSTANCE_ID_NAME)->get_i()) {
 			throw std::runtime_error("Window is corrupted");
 		}
 		int x1, y1, x2, y2, r, g, b;
@@ -171,10 +171,10 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		y1 = (int)vals[2]->get_i();
 		x2 = (int)vals[3]->get_i();
 		y2 = (int)vals[4]->get_i();
-		r = (int)vals[5]->get_str()["r"]->get_i();
-		g = (int)vals[5]->get_str()["g"]->get_i();
-		b = (int)vals[5]->get_str()["b"]->get_i();
-		((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->draw_line(x1, y1, x2, y2, RGB(r, g, b));
+		r = (int)vals[5]->get_str().at("r")->get_i();
+		g = (int)vals[5]->get_str().at("g")->get_i();
+		b = (int)vals[5]->get_str().at("b")->get_i();
+		((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->draw_line(x1, y1, x2, y2, RGB(r, g, b));
 
 		};
 
@@ -193,7 +193,7 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::runtime_error("Window is null");
 		}
-		if (!((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())) {
+		if (!((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())) {
 			throw std::runtime_error("Window is corrupted");
 		}
 		int x, y, width, height, r, g, b;
@@ -201,10 +201,10 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		y = (int)vals[2]->get_i();
 		width = (int)vals[3]->get_i();
 		height = (int)vals[4]->get_i();
-		r = (int)vals[5]->get_str()["r"]->get_i();
-		g = (int)vals[5]->get_str()["g"]->get_i();
-		b = (int)vals[5]->get_str()["b"]->get_i();
-		((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->draw_rect(x, y, width, height, RGB(r, g, b));
+		r = (int)vals[5]->get_str().at("r")->get_i();
+		g = (int)vals[5]->get_str().at("g")->get_i();
+		b = (int)vals[5]->get_str().at("b")->get_i();
+		((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->draw_rect(x, y, width, height, RGB(r, g, b));
 
 		};
 
@@ -223,7 +223,7 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::runtime_error("Window is null");
 		}
-		if (!((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())) {
+		if (!((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())) {
 			throw std::runtime_error("Window is corrupted");
 		}
 		int x, y, width, height, r, g, b;
@@ -231,10 +231,10 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		y = (int)vals[2]->get_i();
 		width = (int)vals[3]->get_i();
 		height = (int)vals[4]->get_i();
-		r = (int)vals[5]->get_str()["r"]->get_i();
-		g = (int)vals[5]->get_str()["g"]->get_i();
-		b = (int)vals[5]->get_str()["b"]->get_i();
-		((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->fill_rect(x, y, width, height, RGB(r, g, b));
+		r = (int)vals[5]->get_str().at("r")->get_i();
+		g = (int)vals[5]->get_str().at("g")->get_i();
+		b = (int)vals[5]->get_str().at("b")->get_i();
+		((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->fill_rect(x, y, width, height, RGB(r, g, b));
 
 		};
 
@@ -252,17 +252,17 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::runtime_error("Window is null");
 		}
-		if (!((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())) {
+		if (!((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())) {
 			throw std::runtime_error("Window is corrupted");
 		}
 		int xc, yc, radius, r, g, b;
 		xc = (int)vals[1]->get_i();
 		yc = (int)vals[2]->get_i();
 		radius = (int)vals[3]->get_i();
-		r = (int)vals[4]->get_str()["r"]->get_i();
-		g = (int)vals[4]->get_str()["g"]->get_i();
-		b = (int)vals[4]->get_str()["b"]->get_i();
-		((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->draw_circle(xc, yc, radius, RGB(r, g, b));
+		r = (int)vals[4]->get_str().at("r")->get_i();
+		g = (int)vals[4]->get_str().at("g")->get_i();
+		b = (int)vals[4]->get_str().at("b")->get_i();
+		((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->draw_circle(xc, yc, radius, RGB(r, g, b));
 
 		};
 
@@ -280,17 +280,17 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::runtime_error("Window is null");
 		}
-		if (!((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())) {
+		if (!((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())) {
 			throw std::runtime_error("Window is corrupted");
 		}
 		int xc, yc, radius, r, g, b;
 		xc = (int)vals[1]->get_i();
 		yc = (int)vals[2]->get_i();
 		radius = (int)vals[3]->get_i();
-		r = (int)vals[4]->get_str()["r"]->get_i();
-		g = (int)vals[4]->get_str()["g"]->get_i();
-		b = (int)vals[4]->get_str()["b"]->get_i();
-		((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->fill_circle(xc, yc, radius, RGB(r, g, b));
+		r = (int)vals[4]->get_str().at("r")->get_i();
+		g = (int)vals[4]->get_str().at("g")->get_i();
+		b = (int)vals[4]->get_str().at("b")->get_i();
+		((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->fill_circle(xc, yc, radius, RGB(r, g, b));
 
 		};
 
@@ -354,26 +354,26 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::runtime_error("Window is null");
 		}
-		if (!((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())) {
+		if (!((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())) {
 			throw std::runtime_error("Window is corrupted");
 		}
 		int x = (int)vals[1]->get_i();
 		int y = (int)vals[2]->get_i();
 		std::string text = vals[3]->get_s();
-		int r = (int)vals[4]->get_str()["r"]->get_i();
-		int g = (int)vals[4]->get_str()["g"]->get_i();
-		int b = (int)vals[4]->get_str()["b"]->get_i();
+		int r = (int)vals[4]->get_str().at("r")->get_i();
+		int g = (int)vals[4]->get_str().at("g")->get_i();
+		int b = (int)vals[4]->get_str().at("b")->get_i();
 
 		RuntimeValue* font_value = vals[5];
 		if (parser::is_void(font_value->type)) {
 			throw std::exception("font is null");
 		}
-		utils::Font* font = (utils::Font*)font_value->get_str()[INSTANCE_ID_NAME]->get_i();
+		utils::Font* font = (utils::Font*)font_value->get_str().at(INSTANCE_ID_NAME)->get_i();
 		if (!font) {
 			throw std::runtime_error("there was an error handling font");
 		}
 
-		((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->draw_text(x, y, text, RGB(r, g, b), font);
+		((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->draw_text(x, y, text, RGB(r, g, b), font);
 
 		};
 
@@ -389,7 +389,7 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::runtime_error("Window is null");
 		}
-		if (!((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())) {
+		if (!((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())) {
 			throw std::runtime_error("Window is corrupted");
 		}
 		std::string text = vals[1]->get_s();
@@ -397,12 +397,12 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(font_value->type)) {
 			throw std::exception("font is null");
 		}
-		utils::Font* font = (utils::Font*)font_value->get_str()[INSTANCE_ID_NAME]->get_i();
+		utils::Font* font = (utils::Font*)font_value->get_str().at(INSTANCE_ID_NAME)->get_i();
 		if (!font) {
 			throw std::runtime_error("there was an error handling font");
 		}
 
-		auto point = ((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->get_text_size(text, font);
+		auto point = ((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->get_text_size(text, font);
 
 		flx_struct str = flx_struct();
 		str["width"] = visitor->alocate_value(new RuntimeValue(flx_int(point.cx * 2 * 0.905)));
@@ -456,7 +456,7 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(win->type)) {
 			throw std::exception("window is null");
 		}
-		auto window = ((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i());
+		auto window = ((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i());
 		if (!window) {
 			throw std::runtime_error("there was an error handling window");
 		}
@@ -464,7 +464,7 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(img->type)) {
 			throw std::exception("window is null");
 		}
-		auto image = ((utils::Image*)img->get_str()[INSTANCE_ID_NAME]->get_i());
+		auto image = ((utils::Image*)img->get_str().at(INSTANCE_ID_NAME)->get_i());
 		if (!image) {
 			throw std::runtime_error("there was an error handling image");
 		}
@@ -480,8 +480,8 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 
 		RuntimeValue* win = val;
 		if (!parser::is_void(win->type)) {
-			if (((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())) {
-				((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->update();
+			if (((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())) {
+				((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->update();
 			}
 		}
 
@@ -493,8 +493,8 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 
 		RuntimeValue* win = val;
 		if (!parser::is_void(win->type)) {
-			if (((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())) {
-				((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->~Window();
+			if (((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())) {
+				((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->~Window();
 				win->set_null();
 			}
 		}
@@ -506,8 +506,8 @@ void ModuleGraphics::register_functions(visitor::Interpreter* visitor) {
 		RuntimeValue* win = std::dynamic_pointer_cast<RuntimeVariable>(scope->find_declared_variable("window"))->value;
 		auto val = visitor->alocate_value(new RuntimeValue(parser::Type::T_BOOL));
 		if (!parser::is_void(win->type)) {
-			if (((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())) {
-				val->set(flx_bool(((utils::Window*)win->get_str()[INSTANCE_ID_NAME]->get_i())->is_quit()));
+			if (((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())) {
+				val->set(flx_bool(((utils::Window*)win->get_str().at(INSTANCE_ID_NAME)->get_i())->is_quit()));
 			}
 			else {
 				val->set(flx_bool(true));
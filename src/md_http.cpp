@@ -31,14 +31,14 @@ void ModuleHTTP::register_functions(visitor::Interpreter* visitor) {
 		if (parser::is_void(config_value->type)) {
 			throw std::exception("Config is null");
 		}
-		flx_struct config_str = config_value->get_str();
-		std::string hostname = config_str["hostname"]->get_s();
-		std::string path = config_str["path"]->get_s();
-		std::string method = config_str["method"]->get_s();
+		const auto& config_str = config_value->get_str();
+		std::string hostname = config_str.at("hostname")->get_s();
+		std::string path = config_str.at("path")->get_s();
+		std::string method = config_str.at("method")->get_s();
 		std::string port = "80";
 		std::string headers = "";
 		std::string parameters = "";
-		std::string data = config_str["data"]->get_s();
+		std::string data = config_str.at("data")->get_s();
 
 		// check mandatory parameters
 		if (hostname.empty()) {
@@ -54,14 +54,14 @@ void ModuleHTTP::register_functions(visitor::Interpreter* visitor) {
 		}
 
 		// get port
-		int param_port = config_str["port"]->get_i();
+		int param_port = config_str.at("port")->get_i();
 		if (param_port  != 0) {
 			port = std::to_string(param_port);
 		}
 
 		// build parameters
-		flx_struct str_parameters = config_str["parameters"]->get_str();
-		for (auto parameter : str_parameters) {
+		const auto& str_parameters = config_str.at("parameters")->get_str();
+		for (const auto& parameter : str_parameters) {
 			if (parameters.empty()) {
 				parameters = "?";
 			}
@@ -72,8 +72,8 @@ void ModuleHTTP::register_functions(visitor::Interpreter* visitor) {
 		}
 
 		// build headers
-		flx_struct str_headers = config_str["headers"]->get_str();
-		for (auto header : str_headers) {
+		const auto& str_headers = config_str.at("headers")->get_str();
+		for (const auto& header : str_headers) {
 			headers += header.first + ": " + header.second->get_s() + "\r\n";
 		}
 
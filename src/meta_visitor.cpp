@@ -35,7 +35,7 @@ void MetaVisitor::validates_reference_type_assignment(TypeDefinition owner, Valu
 	}
 }
 
-StructureDefinition MetaVisitor::find_inner_most_struct(std::shared_ptr<ASTProgramNode> program, const std::string& name_space, const std::string& identifier) {
+const StructureDefinition& MetaVisitor::find_inner_most_struct(std::shared_ptr<ASTProgramNode> program, const std::string& name_space, const std::string& identifier) {
 	std::shared_ptr<Scope> scope = get_inner_most_struct_definition_scope(program, name_space, identifier);
 	if (!scope) {
 		throw std::runtime_error("struct '" + identifier + "' not found");
@@ -51,6 +51,29 @@ std::shared_ptr<Variable> MetaVisitor::find_inner_most_variable(std::shared_ptr<
 	return scope->find_declared_variable(identifier);
 }
 
+std::shared_ptr<Variable> MetaVisitor::find_inner_most_variable(std::shared_ptr<ASTProgramNode> program, const std::string& name_space, const std::string& identifier,
+	const LexicalAddress& address, const std::vector<std::shared_ptr<Scope>>& frame_scopes) {
+	auto var = lookup_inner_most_variable(program, name_space, identifier, address, frame_scopes);
+	if (!var) {
+		throw std::runtime_error("variable '" + identifier + "' not found");
+	}
+	return var;
+}
+
+std::shared_ptr<Variable> MetaVisitor::lookup_inner_most_variable(std::shared_ptr<ASTProgramNode> program, const std::string& name_space, const std::string& identifier,
+	const LexicalAddress& address, const std::vector<std::shared_ptr<Scope>>& frame_scopes) {
+	if (address.is_resolved() && size_t(address.depth) < frame_scopes.size()) {
+		if (auto var = frame_scopes[frame_scopes.size() - 1 - address.depth]->find_declared_variable(address.slot)) {
+			return var;
+		}
+	}
+	std::shared_ptr<Scope> scope = get_inner_most_variable_scope(program, name_space, identifier);
+	if (!scope) {
+		return nullptr;
+	}
+	return scope->find_declared_variable(identifier);
+}
+
 std::shared_ptr<Scope> MetaVisitor::get_inner_most_variable_scope_aux(const std::string& name_space, const std::string& identifier, std::vector<std::string>& visited) {
 	if (name_space.empty()) {
 		return nullptr;
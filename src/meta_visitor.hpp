@@ -15,6 +15,7 @@ namespace parser {
 	template <typename T> class ASTLiteralNode;
 	class ASTLambdaFunction;
 	class ASTIdentifierNode;
+	class LexicalAddress;
 }
 
 using namespace parser;
@@ -32,8 +33,14 @@ namespace visitor {
 
 		void validates_reference_type_assignment(TypeDefinition owner, Value* value);
 
-		StructureDefinition find_inner_most_struct(std::shared_ptr<ASTProgramNode> program, const std::string& name_space, const std::string& identifier);
+		const StructureDefinition& find_inner_most_struct(std::shared_ptr<ASTProgramNode> program, const std::string& name_space, const std::string& identifier);
 		std::shared_ptr<Variable> find_inner_most_variable(std::shared_ptr<ASTProgramNode> program, const std::string& name_space, const std::string& identifier);
+		// resolved addresses are looked up in the scopes of the running frame
+		std::shared_ptr<Variable> find_inner_most_variable(std::shared_ptr<ASTProgramNode> program, const std::string& name_space, const std::string& identifier,
+			const LexicalAddress& address, const std::vector<std::shared_ptr<Scope>>& frame_scopes);
+		// returns nullptr when the variable is not declared
+		std::shared_ptr<Variable> lookup_inner_most_variable(std::shared_ptr<ASTProgramNode> program, const std::string& name_space, const std::string& identifier,
+			const LexicalAddress& address, const std::vector<std::shared_ptr<Scope>>& frame_scopes);
 
 		std::shared_ptr<Scope> get_inner_most_struct_definition_scope_aux(const std::string& name_space, const std::string& identifier, std::vector<std::string>& visited);
 		std::shared_ptr<Scope> get_inner_most_struct_definition_scope(std::shared_ptr<ASTProgramNode> program, const std::string& name_space, const std::string& identifier,
@@ -0,0 +1,26 @@
+#include "register_bytecode.hpp"
+
+using namespace vm;
+
+RegisterValue::RegisterValue()
+	: type(Type::T_UNDEFINED), i(0) {}
+
+RegisterValue::RegisterValue(flx_bool value)
+	: type(Type::T_BOOL), f(0) {
+	b = value;
+}
+
+RegisterValue::RegisterValue(flx_int value)
+	: type(Type::T_INT), i(value) {}
+
+RegisterValue::RegisterValue(flx_float value)
+	: type(Type::T_FLOAT), f(value) {}
+
+RegisterValue RegisterValue::null() {
+	RegisterValue value;
+	value.type = Type::T_VOID;
+	return value;
+}
+
+RegisterInstruction::RegisterInstruction(RegisterOpCode opcode, uint32_t a, uint32_t b, uint32_t c)
+	: opcode(opcode), a(a), b(b), c(c) {}
@@ -0,0 +1,117 @@
+#ifndef REGISTER_BYTECODE_HPP
+#define REGISTER_BYTECODE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+namespace vm {
+
+	// three-address instructions, a is the destination and b and c are the sources
+	enum RegisterOpCode : uint8_t {
+		ROP_MOVE,
+		// move checking and normalizing to the declared type in c
+		ROP_STORE,
+		ROP_GET_GLOBAL,
+		ROP_SET_GLOBAL,
+		ROP_CAST,
+		// arithmetic and comparison
+		ROP_ADD,
+		ROP_SUB,
+		ROP_MUL,
+		ROP_DIV,
+		ROP_REMAINDER,
+		ROP_FLOOR_DIV,
+		// division whose left value is read through an untyped variable, ints divide as floats
+		ROP_UNTYPED_DIV,
+		ROP_UNTYPED_FLOOR_DIV,
+		ROP_EXP,
+		ROP_EQL,
+		ROP_DIF,
+		ROP_LT,
+		ROP_LTE,
+		ROP_GT,
+		ROP_GTE,
+		ROP_SPACE_SHIP,
+		ROP_AND,
+		ROP_OR,
+		ROP_BIT_AND,
+		ROP_BIT_OR,
+		ROP_BIT_XOR,
+		ROP_LEFT_SHIFT,
+		ROP_RIGHT_SHIFT,
+		ROP_NEG,
+		ROP_NOT,
+		ROP_BIT_NOT,
+		// control flow, jump targets are in a
+		ROP_JUMP,
+		ROP_JUMP_IF_FALSE,
+		ROP_JUMP_IF_TRUE,
+		// a receives the result, b is the function index and c the first argument register
+		ROP_CALL,
+		ROP_RETURN,
+		// b is the first argument register, c the argument count
+		ROP_PRINT,
+		ROP_PRINTLN,
+		ROP_EXIT,
+		ROP_HALT
+	};
+
+	// operands with this bit set index the constant table instead of the frame
+	const uint32_t REGISTER_CONSTANT = 0x80000000u;
+
+	class RegisterValue {
+	public:
+		Type type;
+		union {
+			flx_bool b;
+			flx_int i;
+			flx_float f;
+			// index in the program strings, only string literals reach registers
+			uint32_t s;
+		};
+
+		RegisterValue();
+		explicit RegisterValue(flx_bool value);
+		explicit RegisterValue(flx_int value);
+		explicit RegisterValue(flx_float value);
+
+		static RegisterValue null();
+	};
+
+	class RegisterInstruction {
+	public:
+		RegisterOpCode opcode;
+		uint32_t a;
+		uint32_t b;
+		uint32_t c;
+
+		RegisterInstruction(RegisterOpCode opcode, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0);
+	};
+
+	class RegisterFunction {
+	public:
+		std::string identifier;
+		Type type;
+		size_t entry = 0;
+		size_t param_count = 0;
+		size_t frame_size = 0;
+	};
+
+	class RegisterProgram {
+	public:
+		std::string name;
+		std::vector<RegisterInstruction> code;
+		// source position of every instruction, used in runtime error messages
+		std::vector<CodePosition> positions;
+		std::vector<RegisterValue> constants;
+		std::vector<std::string> strings;
+		std::vector<RegisterFunction> functions;
+		size_t main_frame_size = 0;
+	};
+
+}
+
+#endif // !REGISTER_BYTECODE_HPP
@@ -0,0 +1,694 @@
+#include "register_compiler.hpp"
+#include "scalar_subset.hpp"
+
+using namespace visitor;
+using namespace parser;
+using namespace vm;
+
+RegisterCompiler::RegisterCompiler(std::shared_ptr<ASTProgramNode> main_program, std::map<std::string, std::shared_ptr<ASTProgramNode>> programs)
+	: Visitor(programs, main_program, default_namespace) {}
+
+bool RegisterCompiler::start() {
+	program.name = current_program.top()->name;
+
+	try {
+		ScalarSubset(main_program, programs).check();
+	}
+	catch (const ScalarUnsupportedError& ex) {
+		unsupported_reason = "(RCMP) " + std::string(ex.what()) + " is not supported by the register vm";
+		return false;
+	}
+
+	declare_functions();
+
+	scopes.emplace_back();
+	visit(current_program.top());
+	emit(ROP_HALT);
+	program.main_frame_size = frame_size;
+
+	// the top level scope of the main program lives at the bottom of the register file
+	globals = scopes.front();
+	for (size_t i = 0; i < function_nodes.size(); ++i) {
+		compile_function(i);
+	}
+	return true;
+}
+
+void RegisterCompiler::declare_functions() {
+	for (const auto& statement : current_program.top()->statements) {
+		auto fun = std::dynamic_pointer_cast<ASTFunctionDefinitionNode>(statement);
+		if (!fun) {
+			continue;
+		}
+		RegisterFunction function;
+		function.identifier = fun->identifier;
+		function.type = fun->type;
+		function.param_count = fun->parameters.size();
+
+		function_indexes[fun->identifier] = program.functions.size();
+		program.functions.push_back(function);
+		function_nodes.push_back(fun);
+	}
+}
+
+void RegisterCompiler::compile_function(size_t index) {
+	const auto& fun = function_nodes[index];
+	set_curr_pos(fun->row, fun->col);
+
+	current_function = index;
+	program.functions[index].entry = program.code.size();
+	scopes.clear();
+	scopes.emplace_back();
+	locals_top = 0;
+	next_register = 0;
+	frame_size = 0;
+
+	// arguments arrive in the first registers, typed ones are checked and normalized once on entry
+	for (const auto param : fun->parameters) {
+		auto var = dynamic_cast<VariableDefinition*>(param);
+		auto reg = declare_local();
+		if (!is_any(var->type)) {
+			emit(ROP_STORE, reg, reg, uint32_t(var->type));
+		}
+		scopes.back()[var->identifier] = RegisterVariable{ reg, var->type, false };
+	}
+
+	fun->block->accept(this);
+	emit(ROP_RETURN, add_constant(RegisterValue()));
+
+	program.functions[index].frame_size = frame_size;
+	scopes.clear();
+}
+
+void RegisterCompiler::compile_statement(std::shared_ptr<ASTNode> statement) {
+	target = no_target;
+	statement->accept(this);
+	// temporaries only live for the statement that created them
+	next_register = locals_top;
+}
+
+size_t RegisterCompiler::emit(RegisterOpCode opcode, uint32_t a, uint32_t b, uint32_t c) {
+	program.code.emplace_back(opcode, a, b, c);
+	program.positions.emplace_back(curr_row, curr_col);
+	return program.code.size() - 1;
+}
+
+void RegisterCompiler::patch_jump(size_t pos) {
+	program.code[pos].a = uint32_t(program.code.size());
+}
+
+void RegisterCompiler::patch_jumps(const std::vector<size_t>& jumps, size_t pos) {
+	for (const auto jump : jumps) {
+		program.code[jump].a = uint32_t(pos);
+	}
+}
+
+uint32_t RegisterCompiler::alloc_register() {
+	auto reg = next_register++;
+	if (next_register > frame_size) {
+		frame_size = next_register;
+	}
+	return reg;
+}
+
+uint32_t RegisterCompiler::declare_local() {
+	next_register = locals_top;
+	auto reg = alloc_register();
+	locals_top = next_register;
+	return reg;
+}
+
+uint32_t RegisterCompiler::take_target() {
+	auto dest = target;
+	target = no_target;
+	return dest;
+}
+
+uint32_t RegisterCompiler::result_register(uint32_t dest) {
+	return dest == no_target ? alloc_register() : dest;
+}
+
+uint32_t RegisterCompiler::compile_expression(std::shared_ptr<ASTExprNode> expr, uint32_t dest) {
+	target = dest;
+	current_untyped = false;
+	expr->accept(this);
+	target = no_target;
+	return current_operand;
+}
+
+void RegisterCompiler::compile_into(std::shared_ptr<ASTExprNode> expr, uint32_t reg) {
+	auto operand = compile_expression(expr, reg);
+	if (operand != reg) {
+		emit(ROP_MOVE, reg, operand);
+	}
+	current_operand = reg;
+}
+
+void RegisterCompiler::compile_store(uint32_t reg, uint32_t operand, Type operand_type, Type variable_type) {
+	if (is_any(variable_type) || operand_type == variable_type) {
+		if (operand != reg) {
+			emit(ROP_MOVE, reg, operand);
+		}
+	}
+	else {
+		emit(ROP_STORE, reg, operand, uint32_t(variable_type));
+	}
+}
+
+void RegisterCompiler::compile_assignment(const std::string& identifier, const std::string& op, std::shared_ptr<ASTExprNode> expr) {
+	bool is_global = false;
+	const auto variable = *find_variable(identifier, is_global);
+
+	if (op == "=") {
+		if (is_global) {
+			auto operand = compile_expression(expr);
+			emit(ROP_SET_GLOBAL, variable.reg, operand, uint32_t(variable.type));
+		}
+		else {
+			auto operand = compile_expression(expr, variable.reg);
+			compile_store(variable.reg, operand, current_type, variable.type);
+		}
+		current_operand = variable.reg;
+		current_type = variable.type;
+		return;
+	}
+
+	const auto bop = op.substr(0, op.size() - 1);
+	auto opcode = binary_opcode(bop, variable.untyped);
+	auto operand = compile_expression(expr);
+	auto type = ScalarSubset::result_type(bop, variable.type, current_type);
+
+	if (is_global) {
+		auto reg = alloc_register();
+		emit(ROP_GET_GLOBAL, reg, variable.reg);
+		emit(opcode, reg, reg, operand);
+		emit(ROP_SET_GLOBAL, variable.reg, reg, uint32_t(variable.type));
+		current_operand = reg;
+	}
+	else {
+		emit(opcode, variable.reg, variable.reg, operand);
+		if (!is_any(variable.type) && type != variable.type) {
+			emit(ROP_STORE, variable.reg, variable.reg, uint32_t(variable.type));
+		}
+		current_operand = variable.reg;
+	}
+	current_type = variable.type;
+}
+
+size_t RegisterCompiler::compile_condition_jump(std::shared_ptr<ASTExprNode> condition, RegisterOpCode jump, size_t target) {
+	auto operand = compile_expression(condition);
+	return emit(jump, uint32_t(target), operand);
+}
+
+uint32_t RegisterCompiler::add_constant(const RegisterValue& value) {
+	program.constants.push_back(value);
+	return uint32_t(program.constants.size() - 1) | REGISTER_CONSTANT;
+}
+
+uint32_t RegisterCompiler::int_constant(flx_int value) {
+	auto it = int_constants.find(value);
+	if (it != int_constants.end()) {
+		return it->second;
+	}
+	return int_constants[value] = add_constant(RegisterValue(value));
+}
+
+uint32_t RegisterCompiler::float_constant(flx_float value) {
+	auto it = float_constants.find(value);
+	if (it != float_constants.end()) {
+		return it->second;
+	}
+	return float_constants[value] = add_constant(RegisterValue(value));
+}
+
+const RegisterVariable* RegisterCompiler::find_variable(const std::string& identifier, bool& is_global) const {
+	for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+		auto var = it->find(identifier);
+		if (var != it->end()) {
+			is_global = false;
+			return &var->second;
+		}
+	}
+	if (current_function >= 0) {
+		auto var = globals.find(identifier);
+		if (var != globals.end()) {
+			is_global = true;
+			return &var->second;
+		}
+	}
+	return nullptr;
+}
+
+RegisterOpCode RegisterCompiler::binary_opcode(const std::string& op, bool untyped) {
+	static const std::unordered_map<std::string, RegisterOpCode> opcodes = {
+		{ "+", ROP_ADD }, { "-", ROP_SUB }, { "*", ROP_MUL }, { "/", ROP_DIV },
+		{ "%", ROP_REMAINDER }, { "/%", ROP_FLOOR_DIV }, { "**", ROP_EXP },
+		{ "==", ROP_EQL }, { "!=", ROP_DIF }, { "<", ROP_LT }, { "<=", ROP_LTE },
+		{ ">", ROP_GT }, { ">=", ROP_GTE }, { "<=>", ROP_SPACE_SHIP },
+		{ "and", ROP_AND }, { "or", ROP_OR }, { "&", ROP_BIT_AND }, { "|", ROP_BIT_OR },
+		{ "^", ROP_BIT_XOR }, { "<<", ROP_LEFT_SHIFT }, { ">>", ROP_RIGHT_SHIFT }
+	};
+
+	auto opcode = opcodes.at(op);
+	if (untyped && opcode == ROP_DIV) {
+		return ROP_UNTYPED_DIV;
+	}
+	if (untyped && opcode == ROP_FLOOR_DIV) {
+		return ROP_UNTYPED_FLOOR_DIV;
+	}
+	return opcode;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTProgramNode> astnode) {
+	for (const auto& statement : astnode->statements) {
+		compile_statement(statement);
+	}
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTUsingNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTNamespaceManagerNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTDeclarationNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto reg = declare_local();
+	if (astnode->expr) {
+		auto operand = compile_expression(astnode->expr, reg);
+		compile_store(reg, operand, current_type, astnode->type);
+	}
+	else {
+		emit(ROP_MOVE, reg, add_constant(RegisterValue()));
+	}
+
+	scopes.back()[astnode->identifier] = RegisterVariable{ reg, astnode->type, is_any(astnode->type) };
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTUnpackedDeclarationNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTAssignmentNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	compile_assignment(astnode->identifier, astnode->op, astnode->expr);
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTReturnNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	const auto type = program.functions[current_function].type;
+	uint32_t operand;
+	if (astnode->expr) {
+		operand = compile_expression(astnode->expr);
+		if (!is_any(type) && !is_void(type) && current_type != type) {
+			auto reg = alloc_register();
+			emit(ROP_STORE, reg, operand, uint32_t(type));
+			operand = reg;
+		}
+	}
+	else {
+		operand = add_constant(RegisterValue());
+	}
+
+	emit(ROP_RETURN, operand);
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTExitNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	emit(ROP_EXIT, compile_expression(astnode->exit_code));
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTBlockNode> astnode) {
+	auto top = locals_top;
+	scopes.emplace_back();
+
+	for (const auto& statement : astnode->statements) {
+		compile_statement(statement);
+	}
+
+	scopes.pop_back();
+	locals_top = top;
+	next_register = top;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTContinueNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	continue_jumps.back().push_back(emit(ROP_JUMP));
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTBreakNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	break_jumps.back().push_back(emit(ROP_JUMP));
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTSwitchNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTEnumNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTTryCatchNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTThrowNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTEllipsisNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTElseIfNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTIfNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	std::vector<size_t> end_jumps;
+	auto next = compile_condition_jump(astnode->condition, ROP_JUMP_IF_FALSE);
+	astnode->if_block->accept(this);
+
+	for (const auto& else_if : astnode->else_ifs) {
+		set_curr_pos(else_if->row, else_if->col);
+		end_jumps.push_back(emit(ROP_JUMP));
+		patch_jump(next);
+		next = compile_condition_jump(else_if->condition, ROP_JUMP_IF_FALSE);
+		else_if->block->accept(this);
+	}
+
+	if (astnode->else_block) {
+		end_jumps.push_back(emit(ROP_JUMP));
+		patch_jump(next);
+		astnode->else_block->accept(this);
+	}
+	else {
+		patch_jump(next);
+	}
+
+	patch_jumps(end_jumps, program.code.size());
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTForNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto top = locals_top;
+	scopes.emplace_back();
+
+	if (astnode->dci[0]) {
+		compile_statement(astnode->dci[0]);
+	}
+
+	// the condition is tested at the bottom so each iteration takes a single jump
+	auto to_condition = emit(ROP_JUMP);
+	auto body = program.code.size();
+
+	break_jumps.emplace_back();
+	continue_jumps.emplace_back();
+	astnode->block->accept(this);
+
+	patch_jumps(continue_jumps.back(), program.code.size());
+	if (astnode->dci[2]) {
+		compile_statement(astnode->dci[2]);
+	}
+
+	patch_jump(to_condition);
+	if (auto condition = std::dynamic_pointer_cast<ASTExprNode>(astnode->dci[1])) {
+		compile_condition_jump(condition, ROP_JUMP_IF_TRUE, body);
+		next_register = locals_top;
+	}
+	else {
+		emit(ROP_JUMP, uint32_t(body));
+	}
+
+	patch_jumps(break_jumps.back(), program.code.size());
+	break_jumps.pop_back();
+	continue_jumps.pop_back();
+
+	scopes.pop_back();
+	locals_top = top;
+	next_register = top;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTForEachNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTWhileNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto to_condition = emit(ROP_JUMP);
+	auto body = program.code.size();
+
+	break_jumps.emplace_back();
+	continue_jumps.emplace_back();
+	astnode->block->accept(this);
+
+	patch_jump(to_condition);
+	patch_jumps(continue_jumps.back(), program.code.size());
+	compile_condition_jump(astnode->condition, ROP_JUMP_IF_TRUE, body);
+
+	patch_jumps(break_jumps.back(), program.code.size());
+	break_jumps.pop_back();
+	continue_jumps.pop_back();
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTDoWhileNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto body = program.code.size();
+
+	break_jumps.emplace_back();
+	continue_jumps.emplace_back();
+	astnode->block->accept(this);
+
+	patch_jumps(continue_jumps.back(), program.code.size());
+	compile_condition_jump(astnode->condition, ROP_JUMP_IF_TRUE, body);
+
+	patch_jumps(break_jumps.back(), program.code.size());
+	break_jumps.pop_back();
+	continue_jumps.pop_back();
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTFunctionDefinitionNode>) {
+	// top level functions are compiled after the main program
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTStructDefinitionNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTLiteralNode<flx_bool>> astnode) {
+	current_operand = add_constant(RegisterValue(astnode->val));
+	current_type = Type::T_BOOL;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTLiteralNode<flx_int>> astnode) {
+	current_operand = int_constant(astnode->val);
+	current_type = Type::T_INT;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTLiteralNode<flx_float>> astnode) {
+	current_operand = float_constant(astnode->val);
+	current_type = Type::T_FLOAT;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTLiteralNode<flx_char>>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTLiteralNode<flx_string>>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTLambdaFunction>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTArrayConstructorNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTStructConstructorNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTBinaryExprNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto dest = take_target();
+
+	if (astnode->op == "and") {
+		// the right side only runs when the left one is true
+		auto reg = alloc_register();
+		compile_into(astnode->left, reg);
+		auto jump = emit(ROP_JUMP_IF_FALSE, 0, reg);
+		auto right = compile_expression(astnode->right);
+		emit(ROP_AND, reg, reg, right);
+		patch_jump(jump);
+		current_operand = reg;
+		current_type = Type::T_BOOL;
+		return;
+	}
+
+	auto left = compile_expression(astnode->left);
+	auto ltype = current_type;
+	auto untyped = current_untyped;
+	auto right = compile_expression(astnode->right);
+	auto rtype = current_type;
+
+	auto reg = result_register(dest);
+	emit(binary_opcode(astnode->op, untyped), reg, left, right);
+	current_operand = reg;
+	current_type = ScalarSubset::result_type(astnode->op, ltype, rtype);
+	current_untyped = untyped && ScalarSubset::keeps_untyped(astnode->op);
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto dest = take_target();
+	const auto& op = astnode->unary_op;
+
+	if (op == "++" || op == "--") {
+		auto one = std::make_shared<ASTLiteralNode<flx_int>>(1, astnode->row, astnode->col);
+		auto id = std::dynamic_pointer_cast<ASTIdentifierNode>(astnode->expr);
+		if (id && id->name_space.empty() && id->identifier_vector.size() == 1 && id->identifier_vector[0].access_vector.empty()) {
+			compile_assignment(id->identifier, std::string{ op[0] } + "=", one);
+		}
+		else {
+			auto operand = compile_expression(astnode->expr);
+			auto type = current_type;
+			auto reg = result_register(dest);
+			emit(op == "++" ? ROP_ADD : ROP_SUB, reg, operand, int_constant(1));
+			current_operand = reg;
+			current_type = ScalarSubset::result_type(std::string{ op[0] }, type, Type::T_INT);
+		}
+		return;
+	}
+
+	RegisterOpCode opcode;
+	if (op == "-") {
+		opcode = ROP_NEG;
+	}
+	else if (op == "not") {
+		opcode = ROP_NOT;
+	}
+	else {
+		opcode = ROP_BIT_NOT;
+	}
+
+	auto operand = compile_expression(astnode->expr);
+	auto type = current_type;
+	auto untyped = current_untyped;
+	auto reg = result_register(dest);
+	emit(opcode, reg, operand);
+	current_untyped = untyped;
+	current_operand = reg;
+	current_type = opcode == ROP_NOT ? Type::T_BOOL : opcode == ROP_NEG ? type : Type::T_ANY;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto dest = take_target();
+
+	bool is_global = false;
+	auto variable = find_variable(astnode->identifier, is_global);
+
+	if (is_global) {
+		auto reg = result_register(dest);
+		emit(ROP_GET_GLOBAL, reg, variable->reg);
+		current_operand = reg;
+	}
+	else {
+		current_operand = variable->reg;
+	}
+	current_type = variable->type;
+	current_untyped = variable->untyped;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTTernaryNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto reg = result_register(take_target());
+
+	auto to_false = compile_condition_jump(astnode->condition, ROP_JUMP_IF_FALSE);
+	compile_into(astnode->value_if_true, reg);
+	auto true_type = current_type;
+	auto to_end = emit(ROP_JUMP);
+
+	patch_jump(to_false);
+	compile_into(astnode->value_if_false, reg);
+	patch_jump(to_end);
+
+	current_operand = reg;
+	current_type = true_type == current_type ? true_type : Type::T_ANY;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTInNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto dest = take_target();
+
+	const auto& identifier = astnode->identifier;
+	auto it = function_indexes.find(identifier);
+	const bool is_print = it == function_indexes.end();
+
+	// arguments take consecutive registers, the callee frame starts at the first one
+	const auto first = next_register;
+	for (size_t i = 0; i < astnode->parameters.size(); ++i) {
+		alloc_register();
+	}
+	for (size_t i = 0; i < astnode->parameters.size(); ++i) {
+		const auto& param = astnode->parameters[i];
+		auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_string>>(param);
+		if (is_print && literal) {
+			auto index = string_indexes.find(literal->val);
+			RegisterValue value;
+			value.type = Type::T_STRING;
+			if (index != string_indexes.end()) {
+				value.s = index->second;
+			}
+			else {
+				value.s = string_indexes[literal->val] = uint32_t(program.strings.size());
+				program.strings.push_back(literal->val);
+			}
+			emit(ROP_MOVE, first + uint32_t(i), add_constant(value));
+		}
+		else {
+			compile_into(param, first + uint32_t(i));
+		}
+	}
+
+	auto reg = result_register(dest);
+	if (is_print) {
+		emit(identifier == "print" ? ROP_PRINT : ROP_PRINTLN, reg, first, uint32_t(astnode->parameters.size()));
+		current_type = Type::T_ANY;
+	}
+	else {
+		emit(ROP_CALL, reg, uint32_t(it->second), first);
+		current_type = program.functions[it->second].type;
+	}
+	current_operand = reg;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTTypeCastNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto dest = take_target();
+
+	auto operand = compile_expression(astnode->expr);
+	auto reg = result_register(dest);
+	emit(ROP_CAST, reg, operand, uint32_t(astnode->type));
+	current_operand = reg;
+	current_type = astnode->type;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTNullNode>) {
+	current_operand = add_constant(RegisterValue::null());
+	current_type = Type::T_VOID;
+}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTThisNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTTypingNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTValueNode>) {}
+
+void RegisterCompiler::visit(std::shared_ptr<ASTBuiltinCallNode>) {}
+
+long long RegisterCompiler::hash(std::shared_ptr<ASTExprNode>) { return 0; }
+long long RegisterCompiler::hash(std::shared_ptr<ASTValueNode>) { return 0; }
+long long RegisterCompiler::hash(std::shared_ptr<ASTLiteralNode<flx_bool>>) { return 0; }
+long long RegisterCompiler::hash(std::shared_ptr<ASTLiteralNode<flx_int>>) { return 0; }
+long long RegisterCompiler::hash(std::shared_ptr<ASTLiteralNode<flx_float>>) { return 0; }
+long long RegisterCompiler::hash(std::shared_ptr<ASTLiteralNode<flx_char>>) { return 0; }
+long long RegisterCompiler::hash(std::shared_ptr<ASTLiteralNode<flx_string>>) { return 0; }
+long long RegisterCompiler::hash(std::shared_ptr<ASTIdentifierNode>) { return 0; }
+
+void RegisterCompiler::set_curr_pos(unsigned int row, unsigned int col) {
+	curr_row = row;
+	curr_col = col;
+}
+
+std::string RegisterCompiler::msg_header() {
+	return "(RCMP) " + current_program.top()->name + '[' + std::to_string(curr_row) + ':' + std::to_string(curr_col) + "]: ";
+}
@@ -0,0 +1,152 @@
+#ifndef REGISTER_COMPILER_HPP
+#define REGISTER_COMPILER_HPP
+
+#include <memory>
+#include <map>
+#include <vector>
+#include <unordered_map>
+
+#include "register_bytecode.hpp"
+#include "ast.hpp"
+
+using namespace visitor;
+using namespace parser;
+using namespace vm;
+
+namespace visitor {
+
+	class RegisterVariable {
+	public:
+		uint32_t reg;
+		Type type;
+		bool untyped;
+	};
+
+	// compiles programs inside the scalar subset to register bytecode
+	class RegisterCompiler : public Visitor {
+	public:
+		RegisterProgram program;
+		// why the program could not be compiled, empty on success
+		std::string unsupported_reason;
+
+	private:
+		static const uint32_t no_target = UINT32_MAX;
+
+		std::vector<std::unordered_map<std::string, RegisterVariable>> scopes;
+		std::unordered_map<std::string, RegisterVariable> globals;
+		std::unordered_map<std::string, size_t> function_indexes;
+		std::vector<std::shared_ptr<ASTFunctionDefinitionNode>> function_nodes;
+		long long current_function = -1;
+
+		uint32_t locals_top = 0;
+		uint32_t next_register = 0;
+		size_t frame_size = 0;
+
+		std::vector<std::vector<size_t>> break_jumps;
+		std::vector<std::vector<size_t>> continue_jumps;
+
+		std::map<flx_int, uint32_t> int_constants;
+		std::map<flx_float, uint32_t> float_constants;
+		std::unordered_map<std::string, uint32_t> string_indexes;
+
+		// expression results, an operand is a frame register or a constant
+		uint32_t target = no_target;
+		uint32_t current_operand = 0;
+		Type current_type = Type::T_ANY;
+		// whether the value still refers to an untyped variable, which changes '/' and '/%'
+		bool current_untyped = false;
+
+	private:
+		void declare_functions();
+		void compile_function(size_t index);
+		void compile_statement(std::shared_ptr<ASTNode> statement);
+
+		size_t emit(RegisterOpCode opcode, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0);
+		void patch_jump(size_t pos);
+		void patch_jumps(const std::vector<size_t>& jumps, size_t pos);
+
+		uint32_t alloc_register();
+		uint32_t declare_local();
+		uint32_t take_target();
+		uint32_t result_register(uint32_t dest);
+
+		uint32_t compile_expression(std::shared_ptr<ASTExprNode> expr, uint32_t dest = no_target);
+		void compile_into(std::shared_ptr<ASTExprNode> expr, uint32_t reg);
+		void compile_store(uint32_t reg, uint32_t operand, Type operand_type, Type variable_type);
+		void compile_assignment(const std::string& identifier, const std::string& op, std::shared_ptr<ASTExprNode> expr);
+		size_t compile_condition_jump(std::shared_ptr<ASTExprNode> condition, RegisterOpCode jump, size_t target = 0);
+
+		uint32_t add_constant(const RegisterValue& value);
+		uint32_t int_constant(flx_int value);
+		uint32_t float_constant(flx_float value);
+
+		const RegisterVariable* find_variable(const std::string& identifier, bool& is_global) const;
+		static RegisterOpCode binary_opcode(const std::string& op, bool untyped);
+
+		void set_curr_pos(unsigned int row, unsigned int col) override;
+		std::string msg_header() override;
+
+	public:
+		RegisterCompiler(std::shared_ptr<ASTProgramNode> main_program, std::map<std::string, std::shared_ptr<ASTProgramNode>> programs);
+		~RegisterCompiler() = default;
+
+		// returns false when the program uses something outside the supported subset
+		bool start();
+
+		void visit(std::shared_ptr<ASTProgramNode>) override;
+		void visit(std::shared_ptr<ASTUsingNode>) override;
+		void visit(std::shared_ptr<ASTNamespaceManagerNode>) override;
+		void visit(std::shared_ptr<ASTDeclarationNode>) override;
+		void visit(std::shared_ptr<ASTUnpackedDeclarationNode>) override;
+		void visit(std::shared_ptr<ASTAssignmentNode>) override;
+		void visit(std::shared_ptr<ASTReturnNode>) override;
+		void visit(std::shared_ptr<ASTExitNode>) override;
+		void visit(std::shared_ptr<ASTBlockNode>) override;
+		void visit(std::shared_ptr<ASTContinueNode>) override;
+		void visit(std::shared_ptr<ASTBreakNode>) override;
+		void visit(std::shared_ptr<ASTSwitchNode>) override;
+		void visit(std::shared_ptr<ASTEnumNode>) override;
+		void visit(std::shared_ptr<ASTTryCatchNode>) override;
+		void visit(std::shared_ptr<ASTThrowNode>) override;
+		void visit(std::shared_ptr<ASTEllipsisNode>) override;
+		void visit(std::shared_ptr<ASTElseIfNode>) override;
+		void visit(std::shared_ptr<ASTIfNode>) override;
+		void visit(std::shared_ptr<ASTForNode>) override;
+		void visit(std::shared_ptr<ASTForEachNode>) override;
+		void visit(std::shared_ptr<ASTWhileNode>) override;
+		void visit(std::shared_ptr<ASTDoWhileNode>) override;
+		void visit(std::shared_ptr<ASTFunctionDefinitionNode>) override;
+		void visit(std::shared_ptr<ASTStructDefinitionNode>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_bool>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_int>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_float>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_char>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_string>>) override;
+		void visit(std::shared_ptr<ASTLambdaFunction>) override;
+		void visit(std::shared_ptr<ASTArrayConstructorNode>) override;
+		void visit(std::shared_ptr<ASTStructConstructorNode>) override;
+		void visit(std::shared_ptr<ASTBinaryExprNode>) override;
+		void visit(std::shared_ptr<ASTUnaryExprNode>) override;
+		void visit(std::shared_ptr<ASTIdentifierNode>) override;
+		void visit(std::shared_ptr<ASTTernaryNode>) override;
+		void visit(std::shared_ptr<ASTInNode>) override;
+		void visit(std::shared_ptr<ASTFunctionCallNode>) override;
+		void visit(std::shared_ptr<ASTTypeCastNode>) override;
+		void visit(std::shared_ptr<ASTNullNode>) override;
+		void visit(std::shared_ptr<ASTThisNode>) override;
+		void visit(std::shared_ptr<ASTTypingNode>) override;
+		void visit(std::shared_ptr<ASTValueNode>) override;
+		void visit(std::shared_ptr<ASTBuiltinCallNode>) override;
+
+		long long hash(std::shared_ptr<ASTExprNode>) override;
+		long long hash(std::shared_ptr<ASTValueNode>) override;
+		long long hash(std::shared_ptr<ASTIdentifierNode>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_bool>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_int>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_float>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_char>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_string>>) override;
+	};
+}
+
+#endif // !REGISTER_COMPILER_HPP
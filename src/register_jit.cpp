@@ -0,0 +1,385 @@
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "register_jit.hpp"
+
+using namespace vm;
+
+namespace {
+
+	const uint8_t RAX = 0;
+	// registers holding the frame and the constant table while native code runs
+	const uint8_t R_FRAME = 10;
+	const uint8_t R_CONSTANTS = 11;
+
+	const uint8_t JUMP = 0x00;
+	const uint8_t JUMP_EQ = 0x84;
+	const uint8_t JUMP_NE = 0x85;
+
+	const size_t TYPE_FIELD = offsetof(RegisterValue, type);
+	const size_t VALUE_FIELD = offsetof(RegisterValue, i);
+
+	static_assert(sizeof(Type) == 4, "type guards compare 32 bit tags");
+	static_assert(sizeof(RegisterValue) % 8 == 0, "values are copied in 64 bit words");
+
+}
+
+ExecutableMemory::ExecutableMemory(const std::vector<uint8_t>& code)
+	: size(code.size()) {
+#ifdef _WIN32
+	memory = static_cast<uint8_t*>(VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+	if (!memory) {
+		throw std::runtime_error("could not allocate executable memory");
+	}
+	std::memcpy(memory, code.data(), size);
+	DWORD old_protect;
+	if (!VirtualProtect(memory, size, PAGE_EXECUTE_READ, &old_protect)) {
+		VirtualFree(memory, 0, MEM_RELEASE);
+		throw std::runtime_error("could not protect executable memory");
+	}
+	FlushInstructionCache(GetCurrentProcess(), memory, size);
+#else
+	void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapped == MAP_FAILED) {
+		throw std::runtime_error("could not allocate executable memory");
+	}
+	memory = static_cast<uint8_t*>(mapped);
+	std::memcpy(memory, code.data(), size);
+	if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+		munmap(memory, size);
+		throw std::runtime_error("could not protect executable memory");
+	}
+#endif
+}
+
+ExecutableMemory::~ExecutableMemory() {
+#ifdef _WIN32
+	VirtualFree(memory, 0, MEM_RELEASE);
+#else
+	munmap(memory, size);
+#endif
+}
+
+const uint8_t* ExecutableMemory::data() const {
+	return memory;
+}
+
+size_t JitFunction::run(RegisterValue* frame, const RegisterValue* constants, size_t pc) const {
+	return size_t(entry(frame, constants, labels[pc - begin]));
+}
+
+JitCompiler::JitCompiler(const RegisterProgram& program)
+	: program(program) {}
+
+bool JitCompiler::is_supported() {
+#if defined(__x86_64__) || defined(_M_X64)
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::unique_ptr<JitFunction> JitCompiler::compile(size_t begin, size_t end) {
+	if (!is_supported()) {
+		return nullptr;
+	}
+
+	this->begin = begin;
+	this->end = end;
+	code.clear();
+	labels.assign(end - begin + 1, 0);
+	label_patches.clear();
+	exit_patches.clear();
+
+	// entry stub, moves the arguments to the fixed registers and jumps to the requested instruction
+#ifdef _WIN32
+	code.insert(code.end(), { 0x49, 0x89, 0xCA, 0x49, 0x89, 0xD3, 0x41, 0xFF, 0xE0 });
+#else
+	code.insert(code.end(), { 0x49, 0x89, 0xFA, 0x49, 0x89, 0xF3, 0xFF, 0xE2 });
+#endif
+
+	for (size_t pos = begin; pos < end; ++pos) {
+		compile_instruction(pos);
+	}
+	labels[end - begin] = code.size();
+	emit_exit(end);
+
+	std::map<size_t, size_t> exits;
+	for (const auto& [field, pos] : exit_patches) {
+		auto it = exits.find(pos);
+		if (it == exits.end()) {
+			it = exits.emplace(pos, code.size()).first;
+			emit_exit(pos);
+		}
+		patch_rel32(field, it->second);
+	}
+	for (const auto& [field, target] : label_patches) {
+		patch_rel32(field, labels[target - begin]);
+	}
+
+	auto function = std::make_unique<JitFunction>();
+	function->memory = std::make_unique<ExecutableMemory>(code);
+	function->entry = reinterpret_cast<jit_entry_t>(const_cast<uint8_t*>(function->memory->data()));
+	function->begin = begin;
+	for (const auto label : labels) {
+		function->labels.push_back(function->memory->data() + label);
+	}
+
+	return function;
+}
+
+void JitCompiler::compile_instruction(size_t pos) {
+	labels[pos - begin] = code.size();
+
+	const auto& instruction = program.code[pos];
+	switch (instruction.opcode) {
+	case ROP_MOVE:
+		copy_value(instruction.a, instruction.b);
+		break;
+	case ROP_STORE:
+		// only exact types, normalization and errors are left to the interpreter
+		guard_type(instruction.b, Type(instruction.c), pos);
+		copy_value(instruction.a, instruction.b);
+		break;
+	case ROP_ADD:
+	case ROP_SUB:
+	case ROP_MUL:
+		compile_arithmetic(instruction, pos);
+		break;
+	case ROP_DIV:
+	case ROP_REMAINDER:
+		compile_division(instruction, pos);
+		break;
+	case ROP_EQL:
+	case ROP_DIF:
+	case ROP_LT:
+	case ROP_LTE:
+	case ROP_GT:
+	case ROP_GTE:
+		compile_relational(instruction, pos);
+		break;
+	case ROP_AND:
+	case ROP_OR:
+		compile_logical(instruction, pos);
+		break;
+	case ROP_NEG:
+	case ROP_NOT:
+	case ROP_BIT_NOT:
+		compile_unary(instruction, pos);
+		break;
+	case ROP_JUMP:
+		emit_jump(JUMP, instruction.a);
+		break;
+	case ROP_JUMP_IF_FALSE:
+	case ROP_JUMP_IF_TRUE:
+		compile_conditional_jump(instruction, pos);
+		break;
+	default:
+		emit_exit(pos);
+		break;
+	}
+}
+
+void JitCompiler::compile_arithmetic(const RegisterInstruction& instruction, size_t pos) {
+	guard_type(instruction.b, Type::T_INT, pos);
+	guard_type(instruction.c, Type::T_INT, pos);
+
+	emit_mem(true, { 0x8B }, RAX, instruction.b, VALUE_FIELD);
+	switch (instruction.opcode) {
+	case ROP_ADD:
+		emit_mem(true, { 0x03 }, RAX, instruction.c, VALUE_FIELD);
+		break;
+	case ROP_SUB:
+		emit_mem(true, { 0x2B }, RAX, instruction.c, VALUE_FIELD);
+		break;
+	default:
+		emit_mem(true, { 0x0F, 0xAF }, RAX, instruction.c, VALUE_FIELD);
+		break;
+	}
+	emit_mem(true, { 0x89 }, RAX, instruction.a, VALUE_FIELD);
+	store_type(instruction.a, Type::T_INT);
+}
+
+void JitCompiler::compile_division(const RegisterInstruction& instruction, size_t pos) {
+	guard_type(instruction.b, Type::T_INT, pos);
+	guard_type(instruction.c, Type::T_INT, pos);
+
+	// zero raises the division error and -1 can overflow, both stay in the interpreter
+	for (const uint8_t divisor : { uint8_t(0x00), uint8_t(0xFF) }) {
+		emit_mem(true, { 0x83 }, 7, instruction.c, VALUE_FIELD);
+		emit_byte(divisor);
+		emit_byte(0x0F);
+		emit_byte(JUMP_EQ);
+		exit_patches.emplace_back(code.size(), pos);
+		emit_u32(0);
+	}
+
+	emit_mem(true, { 0x8B }, RAX, instruction.b, VALUE_FIELD);
+	// cqo, idiv
+	code.insert(code.end(), { 0x48, 0x99 });
+	emit_mem(true, { 0xF7 }, 7, instruction.c, VALUE_FIELD);
+	if (instruction.opcode == ROP_REMAINDER) {
+		// mov rax, rdx
+		code.insert(code.end(), { 0x48, 0x89, 0xD0 });
+	}
+	emit_mem(true, { 0x89 }, RAX, instruction.a, VALUE_FIELD);
+	store_type(instruction.a, Type::T_INT);
+}
+
+void JitCompiler::compile_relational(const RegisterInstruction& instruction, size_t pos) {
+	guard_type(instruction.b, Type::T_INT, pos);
+	guard_type(instruction.c, Type::T_INT, pos);
+
+	uint8_t setcc;
+	switch (instruction.opcode) {
+	case ROP_EQL:
+		setcc = 0x94;
+		break;
+	case ROP_DIF:
+		setcc = 0x95;
+		break;
+	case ROP_LT:
+		setcc = 0x9C;
+		break;
+	case ROP_LTE:
+		setcc = 0x9E;
+		break;
+	case ROP_GT:
+		setcc = 0x9F;
+		break;
+	default:
+		setcc = 0x9D;
+		break;
+	}
+
+	emit_mem(true, { 0x8B }, RAX, instruction.b, VALUE_FIELD);
+	emit_mem(true, { 0x3B }, RAX, instruction.c, VALUE_FIELD);
+	code.insert(code.end(), { 0x0F, setcc, 0xC0 });
+	emit_mem(false, { 0x88 }, RAX, instruction.a, VALUE_FIELD);
+	store_type(instruction.a, Type::T_BOOL);
+}
+
+void JitCompiler::compile_logical(const RegisterInstruction& instruction, size_t pos) {
+	guard_type(instruction.b, Type::T_BOOL, pos);
+	guard_type(instruction.c, Type::T_BOOL, pos);
+
+	emit_mem(false, { 0x8A }, RAX, instruction.b, VALUE_FIELD);
+	emit_mem(false, { uint8_t(instruction.opcode == ROP_AND ? 0x22 : 0x0A) }, RAX, instruction.c, VALUE_FIELD);
+	emit_mem(false, { 0x88 }, RAX, instruction.a, VALUE_FIELD);
+	store_type(instruction.a, Type::T_BOOL);
+}
+
+void JitCompiler::compile_unary(const RegisterInstruction& instruction, size_t pos) {
+	if (instruction.opcode == ROP_NOT) {
+		guard_type(instruction.b, Type::T_BOOL, pos);
+		emit_mem(false, { 0x8A }, RAX, instruction.b, VALUE_FIELD);
+		// xor al, 1
+		code.insert(code.end(), { 0x34, 0x01 });
+		emit_mem(false, { 0x88 }, RAX, instruction.a, VALUE_FIELD);
+		store_type(instruction.a, Type::T_BOOL);
+		return;
+	}
+
+	guard_type(instruction.b, Type::T_INT, pos);
+	emit_mem(true, { 0x8B }, RAX, instruction.b, VALUE_FIELD);
+	// neg rax or not rax
+	code.insert(code.end(), { 0x48, 0xF7, uint8_t(instruction.opcode == ROP_NEG ? 0xD8 : 0xD0) });
+	emit_mem(true, { 0x89 }, RAX, instruction.a, VALUE_FIELD);
+	store_type(instruction.a, Type::T_INT);
+}
+
+void JitCompiler::compile_conditional_jump(const RegisterInstruction& instruction, size_t pos) {
+	// non bool conditions raise their error in the interpreter
+	guard_type(instruction.b, Type::T_BOOL, pos);
+	emit_mem(false, { 0x80 }, 7, instruction.b, VALUE_FIELD);
+	emit_byte(0x00);
+	emit_jump(instruction.opcode == ROP_JUMP_IF_FALSE ? JUMP_EQ : JUMP_NE, instruction.a);
+}
+
+void JitCompiler::emit_byte(uint8_t byte) {
+	code.push_back(byte);
+}
+
+void JitCompiler::emit_u32(uint32_t value) {
+	for (size_t i = 0; i < 4; ++i) {
+		code.push_back(uint8_t(value >> (i * 8)));
+	}
+}
+
+void JitCompiler::emit_mem(bool wide, std::initializer_list<uint8_t> opcode, uint8_t reg, uint32_t operand, size_t field) {
+	const uint8_t base = operand & REGISTER_CONSTANT ? R_CONSTANTS : R_FRAME;
+	const size_t index = operand & ~REGISTER_CONSTANT;
+
+	// rex, opcode, modrm with a 32 bit displacement from the base register
+	emit_byte(uint8_t(0x40 | (wide ? 0x08 : 0) | (reg & 8 ? 0x04 : 0) | (base & 8 ? 0x01 : 0)));
+	for (const auto byte : opcode) {
+		emit_byte(byte);
+	}
+	emit_byte(uint8_t(0x80 | (reg & 7) << 3 | (base & 7)));
+	emit_u32(uint32_t(index * sizeof(RegisterValue) + field));
+}
+
+void JitCompiler::emit_exit(size_t pos) {
+	// mov eax, pos; ret
+	emit_byte(0xB8);
+	emit_u32(uint32_t(pos));
+	emit_byte(0xC3);
+}
+
+void JitCompiler::emit_jump(uint8_t condition, size_t target) {
+	if (condition == JUMP) {
+		emit_byte(0xE9);
+	}
+	else {
+		emit_byte(0x0F);
+		emit_byte(condition);
+	}
+
+	if (target >= begin && target < end) {
+		label_patches.emplace_back(code.size(), target);
+	}
+	else {
+		exit_patches.emplace_back(code.size(), target);
+	}
+	emit_u32(0);
+}
+
+void JitCompiler::guard_type(uint32_t operand, Type type, size_t pos) {
+	// cmp dword [type], type; jne exit
+	emit_mem(false, { 0x81 }, 7, operand, TYPE_FIELD);
+	emit_u32(uint32_t(type));
+	emit_byte(0x0F);
+	emit_byte(JUMP_NE);
+	exit_patches.emplace_back(code.size(), pos);
+	emit_u32(0);
+}
+
+void JitCompiler::store_type(uint32_t reg, Type type) {
+	emit_mem(false, { 0xC7 }, 0, reg, TYPE_FIELD);
+	emit_u32(uint32_t(type));
+}
+
+void JitCompiler::copy_value(uint32_t dest, uint32_t src) {
+	if (dest == src) {
+		return;
+	}
+	for (size_t offset = 0; offset < sizeof(RegisterValue); offset += 8) {
+		emit_mem(true, { 0x8B }, RAX, src, offset);
+		emit_mem(true, { 0x89 }, RAX, dest, offset);
+	}
+}
+
+void JitCompiler::patch_rel32(size_t field, size_t target) {
+	const auto rel = uint32_t(int32_t(target) - int32_t(field + 4));
+	for (size_t i = 0; i < 4; ++i) {
+		code[field + i] = uint8_t(rel >> (i * 8));
+	}
+}
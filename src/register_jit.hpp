@@ -0,0 +1,94 @@
+#ifndef REGISTER_JIT_HPP
+#define REGISTER_JIT_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <initializer_list>
+
+#include "register_bytecode.hpp"
+
+namespace vm {
+
+	// calls and loop back edges a code unit runs in the interpreter before being compiled
+	const size_t JIT_THRESHOLD = 1000;
+
+	// native code receives the frame registers, the constant table and the address to start at,
+	// and returns the position of the instruction it handed back to the interpreter
+	typedef uint64_t(*jit_entry_t)(RegisterValue* frame, const RegisterValue* constants, const uint8_t* start);
+
+	class ExecutableMemory {
+	private:
+		uint8_t* memory = nullptr;
+		size_t size = 0;
+
+	public:
+		explicit ExecutableMemory(const std::vector<uint8_t>& code);
+		ExecutableMemory(const ExecutableMemory&) = delete;
+		ExecutableMemory& operator=(const ExecutableMemory&) = delete;
+		~ExecutableMemory();
+
+		const uint8_t* data() const;
+	};
+
+	class JitFunction {
+	public:
+		std::unique_ptr<ExecutableMemory> memory;
+		jit_entry_t entry = nullptr;
+		size_t begin = 0;
+		// native address of each instruction of the unit, every one of them is an entry point
+		std::vector<const uint8_t*> labels;
+
+		size_t run(RegisterValue* frame, const RegisterValue* constants, size_t pc) const;
+	};
+
+	// baseline x86-64 translation of a code unit, int and bool instructions run natively behind type guards
+	// and anything else leaves to the interpreter through a side exit
+	class JitCompiler {
+	private:
+		const RegisterProgram& program;
+		size_t begin = 0;
+		size_t end = 0;
+		std::vector<uint8_t> code;
+		std::vector<size_t> labels;
+		// rel32 fields and the instruction label they jump to
+		std::vector<std::pair<size_t, size_t>> label_patches;
+		// rel32 fields and the position their side exit returns
+		std::vector<std::pair<size_t, size_t>> exit_patches;
+
+	private:
+		void emit_byte(uint8_t byte);
+		void emit_u32(uint32_t value);
+		void emit_mem(bool wide, std::initializer_list<uint8_t> opcode, uint8_t reg, uint32_t operand, size_t field);
+		void emit_exit(size_t pos);
+		void emit_jump(uint8_t condition, size_t target);
+
+		void guard_type(uint32_t operand, Type type, size_t pos);
+		void store_type(uint32_t reg, Type type);
+		void copy_value(uint32_t dest, uint32_t src);
+
+		void compile_instruction(size_t pos);
+		void compile_arithmetic(const RegisterInstruction& instruction, size_t pos);
+		void compile_division(const RegisterInstruction& instruction, size_t pos);
+		void compile_relational(const RegisterInstruction& instruction, size_t pos);
+		void compile_logical(const RegisterInstruction& instruction, size_t pos);
+		void compile_unary(const RegisterInstruction& instruction, size_t pos);
+		void compile_conditional_jump(const RegisterInstruction& instruction, size_t pos);
+
+		void patch_rel32(size_t field, size_t target);
+
+	public:
+		explicit JitCompiler(const RegisterProgram& program);
+		~JitCompiler() = default;
+
+		// whether this build can run native code
+		static bool is_supported();
+
+		// translates the instructions in [begin, end)
+		std::unique_ptr<JitFunction> compile(size_t begin, size_t end);
+	};
+
+}
+
+#endif // !REGISTER_JIT_HPP
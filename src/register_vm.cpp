@@ -0,0 +1,346 @@
+#include <iostream>
+#include <memory>
+#include <functional>
+
+#include "register_vm.hpp"
+#include "scalar_operations.hpp"
+
+using namespace vm;
+
+RegisterVirtualMachine::RegisterVirtualMachine(const RegisterProgram& program, bool use_jit)
+	: program(program), use_jit(use_jit && JitCompiler::is_supported()) {
+	unit_begins.push_back(0);
+	for (const auto& function : program.functions) {
+		unit_begins.push_back(function.entry);
+	}
+	unit_begins.push_back(program.code.size());
+
+	hotness.assign(program.functions.size() + 1, 0);
+	native_units.resize(program.functions.size() + 1);
+}
+
+flx_int RegisterVirtualMachine::run() {
+	registers.assign(program.main_frame_size, RegisterValue());
+	frames.clear();
+	frame = registers.data();
+
+	const auto* code = program.code.data();
+	const auto* constants = program.constants.data();
+	size_t base = 0;
+	size_t pc = 0;
+	size_t unit = 0;
+	const JitFunction* native = nullptr;
+
+	try {
+		while (true) {
+			// native code runs until an instruction it does not handle, which is interpreted below
+			if (native) {
+				pc = native->run(frame, constants, pc);
+			}
+
+			const auto& instruction = code[pc++];
+
+			switch (instruction.opcode) {
+			case ROP_MOVE:
+				frame[instruction.a] = operand(instruction.b);
+				break;
+			case ROP_STORE:
+				frame[instruction.a] = ScalarOperations::store(operand(instruction.b), Type(instruction.c));
+				break;
+			case ROP_GET_GLOBAL:
+				frame[instruction.a] = registers[instruction.b];
+				break;
+			case ROP_SET_GLOBAL:
+				registers[instruction.a] = ScalarOperations::store(operand(instruction.b), Type(instruction.c));
+				break;
+			case ROP_CAST:
+				frame[instruction.a] = ScalarOperations::cast(operand(instruction.b), Type(instruction.c));
+				break;
+
+			case ROP_ADD:
+				arithmetic_operation(instruction, "+", std::plus<>());
+				break;
+			case ROP_SUB:
+				arithmetic_operation(instruction, "-", std::minus<>());
+				break;
+			case ROP_MUL:
+				arithmetic_operation(instruction, "*", std::multiplies<>());
+				break;
+			case ROP_DIV:
+				division_operation(instruction, "/");
+				break;
+			case ROP_REMAINDER:
+				division_operation(instruction, "%");
+				break;
+			case ROP_FLOOR_DIV:
+				frame[instruction.a] = ScalarOperations::operation("/%", operand(instruction.b), operand(instruction.c));
+				break;
+			case ROP_UNTYPED_DIV:
+				untyped_division(instruction, "/");
+				break;
+			case ROP_UNTYPED_FLOOR_DIV:
+				untyped_division(instruction, "/%");
+				break;
+			case ROP_EXP:
+				frame[instruction.a] = ScalarOperations::operation("**", operand(instruction.b), operand(instruction.c));
+				break;
+			case ROP_EQL:
+				relational_operation(instruction, "==", std::equal_to<>());
+				break;
+			case ROP_DIF:
+				relational_operation(instruction, "!=", std::not_equal_to<>());
+				break;
+			case ROP_LT:
+				relational_operation(instruction, "<", std::less<>());
+				break;
+			case ROP_LTE:
+				relational_operation(instruction, "<=", std::less_equal<>());
+				break;
+			case ROP_GT:
+				relational_operation(instruction, ">", std::greater<>());
+				break;
+			case ROP_GTE:
+				relational_operation(instruction, ">=", std::greater_equal<>());
+				break;
+			case ROP_SPACE_SHIP:
+				frame[instruction.a] = ScalarOperations::operation("<=>", operand(instruction.b), operand(instruction.c));
+				break;
+			case ROP_AND:
+				logical_operation(instruction, "and");
+				break;
+			case ROP_OR:
+				logical_operation(instruction, "or");
+				break;
+			case ROP_BIT_AND:
+				frame[instruction.a] = ScalarOperations::operation("&", operand(instruction.b), operand(instruction.c));
+				break;
+			case ROP_BIT_OR:
+				frame[instruction.a] = ScalarOperations::operation("|", operand(instruction.b), operand(instruction.c));
+				break;
+			case ROP_BIT_XOR:
+				frame[instruction.a] = ScalarOperations::operation("^", operand(instruction.b), operand(instruction.c));
+				break;
+			case ROP_LEFT_SHIFT:
+				frame[instruction.a] = ScalarOperations::operation("<<", operand(instruction.b), operand(instruction.c));
+				break;
+			case ROP_RIGHT_SHIFT:
+				frame[instruction.a] = ScalarOperations::operation(">>", operand(instruction.b), operand(instruction.c));
+				break;
+			case ROP_NEG:
+			case ROP_NOT:
+			case ROP_BIT_NOT:
+				unary_operation(instruction);
+				break;
+
+			case ROP_JUMP:
+			case ROP_JUMP_IF_FALSE:
+			case ROP_JUMP_IF_TRUE:
+				if (instruction.opcode == ROP_JUMP
+					|| ScalarOperations::condition(operand(instruction.b)) == (instruction.opcode == ROP_JUMP_IF_TRUE)) {
+					if (use_jit && instruction.a < pc) {
+						native = count_hotness(unit);
+					}
+					pc = instruction.a;
+				}
+				break;
+
+			case ROP_CALL: {
+				const auto& function = program.functions[instruction.b];
+				frames.push_back(RegisterFrame{ base, pc, instruction.a, unit });
+				base += instruction.c;
+				if (registers.size() < base + function.frame_size) {
+					registers.resize(base + function.frame_size);
+				}
+				frame = registers.data() + base;
+				pc = function.entry;
+				unit = instruction.b + 1;
+				native = use_jit ? count_hotness(unit) : nullptr;
+				break;
+			}
+			case ROP_RETURN: {
+				const auto value = operand(instruction.a);
+				const auto caller = frames.back();
+				frames.pop_back();
+				base = caller.base;
+				frame = registers.data() + base;
+				pc = caller.return_pc;
+				frame[caller.result] = value;
+				unit = caller.unit;
+				native = native_units[unit].get();
+				break;
+			}
+
+			case ROP_PRINT:
+			case ROP_PRINTLN:
+				print(instruction);
+				break;
+			case ROP_EXIT: {
+				const auto& value = operand(instruction.a);
+				if (!is_int(value.type)) {
+					throw std::runtime_error("expected int value");
+				}
+				return value.i;
+			}
+			case ROP_HALT:
+				return 0;
+
+			default:
+				throw std::runtime_error("invalid register instruction");
+			}
+		}
+	}
+	catch (const std::exception& ex) {
+		throw std::runtime_error(msg_header(pc - 1) + ex.what());
+	}
+}
+
+const RegisterValue& RegisterVirtualMachine::operand(uint32_t index) const {
+	return index & REGISTER_CONSTANT ? program.constants[index & ~REGISTER_CONSTANT] : frame[index];
+}
+
+template <typename Operation>
+void RegisterVirtualMachine::arithmetic_operation(const RegisterInstruction& instruction, const char* op, Operation operation) {
+	const auto& lval = operand(instruction.b);
+	const auto& rval = operand(instruction.c);
+
+	if (lval.type == rval.type) {
+		if (is_int(lval.type)) {
+			frame[instruction.a] = RegisterValue(flx_int(operation(lval.i, rval.i)));
+			return;
+		}
+		if (is_float(lval.type)) {
+			frame[instruction.a] = RegisterValue(flx_float(operation(lval.f, rval.f)));
+			return;
+		}
+	}
+
+	frame[instruction.a] = ScalarOperations::operation(op, lval, rval);
+}
+
+template <typename Operation>
+void RegisterVirtualMachine::relational_operation(const RegisterInstruction& instruction, const char* op, Operation operation) {
+	const auto& lval = operand(instruction.b);
+	const auto& rval = operand(instruction.c);
+
+	if (lval.type == rval.type) {
+		if (is_int(lval.type)) {
+			frame[instruction.a] = RegisterValue(flx_bool(operation(lval.i, rval.i)));
+			return;
+		}
+		if (is_float(lval.type)) {
+			frame[instruction.a] = RegisterValue(flx_bool(operation(lval.f, rval.f)));
+			return;
+		}
+	}
+
+	frame[instruction.a] = ScalarOperations::operation(op, lval, rval);
+}
+
+void RegisterVirtualMachine::division_operation(const RegisterInstruction& instruction, const char* op) {
+	const auto& lval = operand(instruction.b);
+	const auto& rval = operand(instruction.c);
+	const bool is_div = op[0] == '/';
+
+	// zero divisors take the generic path, which raises the error
+	if (lval.type == rval.type) {
+		if (is_int(lval.type) && rval.i != 0) {
+			frame[instruction.a] = RegisterValue(flx_int(is_div ? lval.i / rval.i : lval.i % rval.i));
+			return;
+		}
+		if (is_float(lval.type) && is_div && int(rval.f) != 0) {
+			frame[instruction.a] = RegisterValue(flx_float(lval.f / rval.f));
+			return;
+		}
+	}
+
+	frame[instruction.a] = ScalarOperations::operation(op, lval, rval);
+}
+
+void RegisterVirtualMachine::untyped_division(const RegisterInstruction& instruction, const char* op) {
+	const auto& lval = operand(instruction.b);
+	const auto& rval = operand(instruction.c);
+	const bool is_div = op[1] == '\0';
+
+	if (is_div && is_int(lval.type) && is_int(rval.type) && rval.i != 0) {
+		frame[instruction.a] = RegisterValue(flx_float(flx_float(lval.i) / flx_float(rval.i)));
+		return;
+	}
+	if (is_div && lval.type == rval.type && is_float(lval.type) && int(rval.f) != 0) {
+		frame[instruction.a] = RegisterValue(flx_float(lval.f / rval.f));
+		return;
+	}
+
+	frame[instruction.a] = ScalarOperations::untyped_division(op, lval, rval);
+}
+
+void RegisterVirtualMachine::logical_operation(const RegisterInstruction& instruction, const char* op) {
+	const auto& lval = operand(instruction.b);
+	const auto& rval = operand(instruction.c);
+
+	if (is_bool(lval.type) && is_bool(rval.type)) {
+		frame[instruction.a] = RegisterValue(flx_bool(op[0] == 'a' ? lval.b && rval.b : lval.b || rval.b));
+		return;
+	}
+
+	frame[instruction.a] = ScalarOperations::operation(op, lval, rval);
+}
+
+void RegisterVirtualMachine::unary_operation(const RegisterInstruction& instruction) {
+	const auto& value = operand(instruction.b);
+
+	switch (instruction.opcode) {
+	case ROP_NEG:
+		if (is_int(value.type)) {
+			frame[instruction.a] = RegisterValue(flx_int(-value.i));
+			return;
+		}
+		if (is_float(value.type)) {
+			frame[instruction.a] = RegisterValue(flx_float(-value.f));
+			return;
+		}
+		frame[instruction.a] = ScalarOperations::unary("-", value);
+		break;
+	case ROP_NOT:
+		if (is_bool(value.type)) {
+			frame[instruction.a] = RegisterValue(flx_bool(!value.b));
+			return;
+		}
+		frame[instruction.a] = ScalarOperations::unary("not", value);
+		break;
+	default:
+		if (is_int(value.type)) {
+			frame[instruction.a] = RegisterValue(flx_int(~value.i));
+			return;
+		}
+		frame[instruction.a] = ScalarOperations::unary("~", value);
+		break;
+	}
+}
+
+void RegisterVirtualMachine::print(const RegisterInstruction& instruction) {
+	for (uint32_t i = 0; i < instruction.c; ++i) {
+		const auto& value = frame[instruction.b + i];
+		if (is_string(value.type)) {
+			std::cout << program.strings[value.s];
+		}
+		else {
+			std::cout << ScalarOperations::to_string(value);
+		}
+	}
+	if (instruction.opcode == ROP_PRINTLN) {
+		std::cout << std::endl;
+	}
+	frame[instruction.a] = RegisterValue();
+}
+
+const JitFunction* RegisterVirtualMachine::count_hotness(size_t unit) {
+	if (++hotness[unit] == JIT_THRESHOLD) {
+		native_units[unit] = JitCompiler(program).compile(unit_begins[unit], unit_begins[unit + 1]);
+	}
+	return native_units[unit].get();
+}
+
+std::string RegisterVirtualMachine::msg_header(size_t pos) const {
+	const auto& position = program.positions[pos];
+	return "(RVM) " + program.name + '[' + std::to_string(position.row) + ':' + std::to_string(position.col) + "]: ";
+}
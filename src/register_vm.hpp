@@ -0,0 +1,66 @@
+#ifndef REGISTER_VIRTUAL_MACHINE_HPP
+#define REGISTER_VIRTUAL_MACHINE_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "register_bytecode.hpp"
+#include "register_jit.hpp"
+#include "types.hpp"
+
+namespace vm {
+
+	class RegisterFrame {
+	public:
+		size_t base;
+		size_t return_pc;
+		// caller register that receives the returned value
+		uint32_t result;
+		size_t unit;
+	};
+
+	// runs register bytecode, every call gets a window of the register file starting at its first argument
+	class RegisterVirtualMachine {
+	private:
+		const RegisterProgram& program;
+		std::vector<RegisterValue> registers;
+		std::vector<RegisterFrame> frames;
+		// registers of the running function, refreshed whenever the register file grows
+		RegisterValue* frame = nullptr;
+
+		// code units are the main program followed by each function, unit i runs from unit_begins[i] to unit_begins[i + 1]
+		bool use_jit;
+		std::vector<size_t> unit_begins;
+		std::vector<size_t> hotness;
+		std::vector<std::unique_ptr<JitFunction>> native_units;
+
+	private:
+		const RegisterValue& operand(uint32_t index) const;
+
+		template <typename Operation>
+		void arithmetic_operation(const RegisterInstruction& instruction, const char* op, Operation operation);
+		template <typename Operation>
+		void relational_operation(const RegisterInstruction& instruction, const char* op, Operation operation);
+		void division_operation(const RegisterInstruction& instruction, const char* op);
+		void untyped_division(const RegisterInstruction& instruction, const char* op);
+		void logical_operation(const RegisterInstruction& instruction, const char* op);
+		void unary_operation(const RegisterInstruction& instruction);
+		void print(const RegisterInstruction& instruction);
+
+		std::string msg_header(size_t pos) const;
+
+		// counts a call or back edge of the unit and returns its native code once it is hot
+		const JitFunction* count_hotness(size_t unit);
+
+	public:
+		RegisterVirtualMachine(const RegisterProgram& program, bool use_jit);
+		~RegisterVirtualMachine() = default;
+
+		// returns the exit code of the program
+		flx_int run();
+	};
+
+}
+
+#endif // !REGISTER_VIRTUAL_MACHINE_HPP
@@ -0,0 +1,142 @@
+#include <memory>
+
+#include "scalar_operations.hpp"
+#include "exception_handler.hpp"
+
+using namespace vm;
+
+static dim_eval_func_t evaluate_access_vector_ptr = [](const std::vector<std::shared_ptr<ASTExprNode>>&) {
+	return std::vector<unsigned int>();
+	};
+
+RuntimeValue* ScalarOperations::box(const RegisterValue& value) {
+	switch (value.type) {
+	case Type::T_BOOL:
+		return new RuntimeValue(value.b);
+	case Type::T_INT:
+		return new RuntimeValue(value.i);
+	case Type::T_FLOAT:
+		return new RuntimeValue(value.f);
+	default:
+		return new RuntimeValue(value.type);
+	}
+}
+
+RegisterValue ScalarOperations::unbox(const RuntimeValue* value) {
+	switch (value->type) {
+	case Type::T_BOOL:
+		return RegisterValue(value->get_b());
+	case Type::T_INT:
+		return RegisterValue(value->get_i());
+	case Type::T_FLOAT:
+		return RegisterValue(value->get_f());
+	case Type::T_UNDEFINED:
+		return RegisterValue();
+	case Type::T_VOID:
+		return RegisterValue::null();
+	default:
+		throw std::runtime_error("'" + type_str(value->type) + "' values are not supported outside the interpreter");
+	}
+}
+
+RegisterValue ScalarOperations::operation(const std::string& op, const RegisterValue& lval, const RegisterValue& rval) {
+	std::unique_ptr<RuntimeValue> left(box(lval));
+	std::unique_ptr<RuntimeValue> right(box(rval));
+
+	auto res = RuntimeOperations::do_operation(op, left.get(), right.get(), evaluate_access_vector_ptr, true);
+	// the result is either one of the operands updated in place or a new value
+	std::unique_ptr<RuntimeValue> created(res != left.get() && res != right.get() ? res : nullptr);
+
+	return unbox(res);
+}
+
+RegisterValue ScalarOperations::untyped_division(const std::string& op, const RegisterValue& lval, const RegisterValue& rval) {
+	if (is_int(lval.type) && is_int(rval.type)) {
+		return operation(op, RegisterValue(flx_float(lval.i)), RegisterValue(flx_float(rval.i)));
+	}
+	return operation(op, lval, rval);
+}
+
+RegisterValue ScalarOperations::unary(const std::string& op, const RegisterValue& value) {
+	if (op == "-" && is_int(value.type)) {
+		return RegisterValue(flx_int(-value.i));
+	}
+	if (op == "-" && is_float(value.type)) {
+		return RegisterValue(flx_float(-value.f));
+	}
+	if (op == "not" && is_bool(value.type)) {
+		return RegisterValue(flx_bool(!value.b));
+	}
+	if (op == "~" && is_int(value.type)) {
+		return RegisterValue(flx_int(~value.i));
+	}
+	ExceptionHandler::throw_unary_operation_err(op, TypeDefinition(value.type), evaluate_access_vector_ptr);
+	return RegisterValue();
+}
+
+RegisterValue ScalarOperations::cast(const RegisterValue& value, Type type) {
+	switch (type) {
+	case Type::T_BOOL:
+		switch (value.type) {
+		case Type::T_BOOL:
+			return value;
+		case Type::T_INT:
+			return RegisterValue(flx_bool(value.i != 0));
+		case Type::T_FLOAT:
+			return RegisterValue(flx_bool(value.f != .0));
+		default:
+			break;
+		}
+		break;
+	case Type::T_INT:
+		switch (value.type) {
+		case Type::T_BOOL:
+			return RegisterValue(flx_int(value.b));
+		case Type::T_INT:
+			return value;
+		case Type::T_FLOAT:
+			return RegisterValue(flx_int(value.f));
+		default:
+			break;
+		}
+		break;
+	case Type::T_FLOAT:
+		switch (value.type) {
+		case Type::T_BOOL:
+			return RegisterValue(flx_float(value.b));
+		case Type::T_INT:
+			return RegisterValue(flx_float(value.i));
+		case Type::T_FLOAT:
+			return value;
+		default:
+			break;
+		}
+		break;
+	default:
+		break;
+	}
+	return RegisterValue();
+}
+
+RegisterValue ScalarOperations::store(const RegisterValue& value, Type type) {
+	if (is_any(type) || value.type == type || is_void(value.type)) {
+		return value;
+	}
+	if (is_float(type) && is_int(value.type)) {
+		return RegisterValue(flx_float(value.i));
+	}
+	ExceptionHandler::throw_mismatched_type_err(TypeDefinition(type), TypeDefinition(value.type), evaluate_access_vector_ptr);
+	return value;
+}
+
+flx_bool ScalarOperations::condition(const RegisterValue& value) {
+	if (!is_bool(value.type)) {
+		ExceptionHandler::throw_condition_type_err();
+	}
+	return value.b;
+}
+
+std::string ScalarOperations::to_string(const RegisterValue& value) {
+	std::unique_ptr<RuntimeValue> boxed(box(value));
+	return RuntimeOperations::parse_value_to_string(boxed.get());
+}
@@ -0,0 +1,33 @@
+#ifndef SCALAR_OPERATIONS_HPP
+#define SCALAR_OPERATIONS_HPP
+
+#include <string>
+
+#include "register_bytecode.hpp"
+#include "types.hpp"
+
+namespace vm {
+
+	// slow and error paths of the scalar subset shared by the register vm, the closure engine and translated programs,
+	// values outside their fast paths go through the interpreter operations so every engine gives the same results
+	class ScalarOperations {
+	public:
+		static RuntimeValue* box(const RegisterValue& value);
+		static RegisterValue unbox(const RuntimeValue* value);
+
+		static RegisterValue operation(const std::string& op, const RegisterValue& lval, const RegisterValue& rval);
+		// '/' and '/%' whose left value is read through an untyped variable, ints divide as floats
+		static RegisterValue untyped_division(const std::string& op, const RegisterValue& lval, const RegisterValue& rval);
+		static RegisterValue unary(const std::string& op, const RegisterValue& value);
+		// undefined values stay undefined
+		static RegisterValue cast(const RegisterValue& value, Type type);
+		// checked store into a variable of the given type, ints widen to floats
+		static RegisterValue store(const RegisterValue& value, Type type);
+		static flx_bool condition(const RegisterValue& value);
+
+		static std::string to_string(const RegisterValue& value);
+	};
+
+}
+
+#endif // !SCALAR_OPERATIONS_HPP
@@ -0,0 +1,456 @@
+#include "scalar_subset.hpp"
+#include "token.hpp"
+
+using namespace visitor;
+using namespace parser;
+using namespace lexer;
+
+ScalarSubset::ScalarSubset(std::shared_ptr<ASTProgramNode> main_program, std::map<std::string, std::shared_ptr<ASTProgramNode>> programs)
+	: Visitor(programs, main_program, default_namespace) {}
+
+void ScalarSubset::check() {
+	declare_functions();
+
+	scopes.emplace_back();
+	visit(current_program.top());
+
+	// the top level scope of the main program holds the globals seen by the functions
+	globals = scopes.front();
+	for (const auto& fun : function_nodes) {
+		check_function(fun);
+	}
+
+	for (const auto& identifier : function_globals) {
+		if (local_names.find(identifier) != local_names.end()) {
+			unsupported("access to '" + identifier + "' from functions while a local hides it");
+		}
+	}
+}
+
+void ScalarSubset::declare_functions() {
+	for (const auto& statement : current_program.top()->statements) {
+		auto fun = std::dynamic_pointer_cast<ASTFunctionDefinitionNode>(statement);
+		if (!fun) {
+			continue;
+		}
+		set_curr_pos(fun->row, fun->col);
+
+		if (!fun->block) {
+			unsupported("function declaration '" + fun->identifier + "'");
+		}
+		if (functions.find(fun->identifier) != functions.end()) {
+			unsupported("overloaded function '" + fun->identifier + "'");
+		}
+		if (!fun->dim.empty() || (!is_scalar(fun->type) && !is_void(fun->type))) {
+			unsupported("return type of '" + fun->identifier + "'");
+		}
+		for (const auto param : fun->parameters) {
+			auto var = dynamic_cast<VariableDefinition*>(param);
+			if (!var || var->is_rest || var->default_value || !is_supported_variable(*var)) {
+				unsupported("parameters of '" + fun->identifier + "'");
+			}
+		}
+
+		functions[fun->identifier] = fun->parameters.size();
+		function_nodes.push_back(fun);
+	}
+}
+
+void ScalarSubset::check_function(const std::shared_ptr<ASTFunctionDefinitionNode>& fun) {
+	set_curr_pos(fun->row, fun->col);
+
+	in_function = true;
+	scopes.clear();
+	scopes.emplace_back();
+
+	for (const auto param : fun->parameters) {
+		declare(dynamic_cast<VariableDefinition*>(param)->identifier);
+	}
+	fun->block->accept(this);
+
+	scopes.clear();
+	in_function = false;
+}
+
+void ScalarSubset::declare(const std::string& identifier) {
+	if (in_function || scopes.size() > 1) {
+		local_names.insert(identifier);
+	}
+	scopes.back().insert(identifier);
+}
+
+void ScalarSubset::check_variable(const std::string& identifier, const std::string& what) {
+	for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+		if (it->find(identifier) != it->end()) {
+			return;
+		}
+	}
+	if (in_function && globals.find(identifier) != globals.end()) {
+		function_globals.insert(identifier);
+		return;
+	}
+	unsupported(what);
+}
+
+void ScalarSubset::check_plain(const std::string& identifier, const std::string& name_space,
+	const std::vector<Identifier>& identifier_vector, const std::string& what) {
+	if (!name_space.empty() || identifier_vector.size() != 1 || !identifier_vector[0].access_vector.empty()) {
+		unsupported(what + " '" + identifier + "'");
+	}
+}
+
+bool ScalarSubset::is_scalar(Type type) {
+	return is_any(type) || is_bool(type) || is_int(type) || is_float(type);
+}
+
+bool ScalarSubset::is_supported_variable(const TypeDefinition& type) {
+	return is_scalar(type.type) && type.dim.empty() && !type.use_ref;
+}
+
+Type ScalarSubset::result_type(const std::string& op, Type ltype, Type rtype) {
+	if (op == "+" || op == "-" || op == "*") {
+		return ltype == rtype && (is_int(ltype) || is_float(ltype)) ? ltype : Type::T_ANY;
+	}
+	if (Token::is_equality_op(op) || (Token::is_relational_op(op) && op != "<=>") || op == "and" || op == "or") {
+		return Type::T_BOOL;
+	}
+	return Type::T_ANY;
+}
+
+bool ScalarSubset::keeps_untyped(const std::string& op) {
+	return !Token::is_equality_op(op) && !Token::is_relational_op(op) && op != "and" && op != "or";
+}
+
+void ScalarSubset::unsupported(const std::string& what) {
+	throw ScalarUnsupportedError(msg_header() + what);
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTProgramNode> astnode) {
+	for (const auto& statement : astnode->statements) {
+		statement->accept(this);
+	}
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTUsingNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("using");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTNamespaceManagerNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("namespace management");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTDeclarationNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	if (!is_supported_variable(*astnode)) {
+		unsupported("declaration of '" + astnode->identifier + "'");
+	}
+	if (astnode->expr) {
+		astnode->expr->accept(this);
+	}
+	declare(astnode->identifier);
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTUnpackedDeclarationNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("unpacked declaration");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTAssignmentNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	check_plain(astnode->identifier, astnode->name_space, astnode->identifier_vector, "assignment to");
+	check_variable(astnode->identifier, "assignment to '" + astnode->identifier + "'");
+	astnode->expr->accept(this);
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTReturnNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	if (!in_function) {
+		unsupported("return outside of a function");
+	}
+	if (astnode->expr) {
+		astnode->expr->accept(this);
+	}
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTExitNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	astnode->exit_code->accept(this);
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTBlockNode> astnode) {
+	scopes.emplace_back();
+	for (const auto& statement : astnode->statements) {
+		statement->accept(this);
+	}
+	scopes.pop_back();
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTContinueNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	if (loop_depth == 0) {
+		unsupported("continue outside of a loop");
+	}
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTBreakNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	if (loop_depth == 0) {
+		unsupported("break outside of a loop");
+	}
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTSwitchNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("switch");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTEnumNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("enum");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTTryCatchNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("try catch");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTThrowNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("throw");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTEllipsisNode>) {}
+
+void ScalarSubset::visit(std::shared_ptr<ASTElseIfNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("else if outside of an if");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTIfNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	astnode->condition->accept(this);
+	astnode->if_block->accept(this);
+	for (const auto& else_if : astnode->else_ifs) {
+		set_curr_pos(else_if->row, else_if->col);
+		else_if->condition->accept(this);
+		else_if->block->accept(this);
+	}
+	if (astnode->else_block) {
+		astnode->else_block->accept(this);
+	}
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTForNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	scopes.emplace_back();
+	for (const auto& statement : astnode->dci) {
+		if (statement) {
+			statement->accept(this);
+		}
+	}
+
+	++loop_depth;
+	astnode->block->accept(this);
+	--loop_depth;
+
+	scopes.pop_back();
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTForEachNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("foreach");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTWhileNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	astnode->condition->accept(this);
+	++loop_depth;
+	astnode->block->accept(this);
+	--loop_depth;
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTDoWhileNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	++loop_depth;
+	astnode->block->accept(this);
+	--loop_depth;
+	astnode->condition->accept(this);
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	// top level functions are checked after the main program
+	if (in_function || scopes.size() > 1) {
+		unsupported("nested function '" + astnode->identifier + "'");
+	}
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTStructDefinitionNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("struct");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTLiteralNode<flx_bool>>) {}
+
+void ScalarSubset::visit(std::shared_ptr<ASTLiteralNode<flx_int>>) {}
+
+void ScalarSubset::visit(std::shared_ptr<ASTLiteralNode<flx_float>>) {}
+
+void ScalarSubset::visit(std::shared_ptr<ASTLiteralNode<flx_char>> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("char value");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTLiteralNode<flx_string>> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("string value");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTLambdaFunction> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("lambda");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTArrayConstructorNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("array");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTStructConstructorNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("struct");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTBinaryExprNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	static const std::set<std::string> operators = {
+		"+", "-", "*", "/", "%", "/%", "**", "==", "!=", "<", "<=", ">", ">=", "<=>",
+		"and", "or", "&", "|", "^", "<<", ">>"
+	};
+	if (operators.find(astnode->op) == operators.end()) {
+		unsupported("operator '" + astnode->op + "'");
+	}
+
+	astnode->left->accept(this);
+	astnode->right->accept(this);
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	const auto& op = astnode->unary_op;
+	if (op != "-" && op != "not" && op != "~" && op != "++" && op != "--") {
+		unsupported("unary operator '" + op + "'");
+	}
+
+	// increments of plain variables are assignments
+	auto id = std::dynamic_pointer_cast<ASTIdentifierNode>(astnode->expr);
+	if ((op == "++" || op == "--") && id && id->name_space.empty() && id->identifier_vector.size() == 1
+		&& id->identifier_vector[0].access_vector.empty()) {
+		check_variable(id->identifier, "assignment to '" + id->identifier + "'");
+		return;
+	}
+	astnode->expr->accept(this);
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	check_plain(astnode->identifier, astnode->name_space, astnode->identifier_vector, "access to");
+	check_variable(astnode->identifier, "identifier '" + astnode->identifier + "'");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTTernaryNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	astnode->condition->accept(this);
+	astnode->value_if_true->accept(this);
+	astnode->value_if_false->accept(this);
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTInNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("in");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	check_plain(astnode->identifier, astnode->name_space, astnode->identifier_vector, "call to");
+
+	const auto& identifier = astnode->identifier;
+	auto it = functions.find(identifier);
+	const bool is_print = it == functions.end() && (identifier == "print" || identifier == "println");
+	if (it == functions.end() && !is_print) {
+		unsupported("call to '" + identifier + "'");
+	}
+	if (!is_print && astnode->parameters.size() != it->second) {
+		unsupported("default arguments of '" + identifier + "'");
+	}
+
+	for (const auto& param : astnode->parameters) {
+		// string literals only reach print calls
+		if (!is_print || !std::dynamic_pointer_cast<ASTLiteralNode<flx_string>>(param)) {
+			param->accept(this);
+		}
+	}
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTTypeCastNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	if (!is_bool(astnode->type) && !is_int(astnode->type) && !is_float(astnode->type)) {
+		unsupported("cast to " + type_str(astnode->type));
+	}
+	astnode->expr->accept(this);
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTNullNode>) {}
+
+void ScalarSubset::visit(std::shared_ptr<ASTThisNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("this");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTTypingNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported(astnode->image);
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTValueNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("value node");
+}
+
+void ScalarSubset::visit(std::shared_ptr<ASTBuiltinCallNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	unsupported("builtin '" + astnode->identifier + "'");
+}
+
+long long ScalarSubset::hash(std::shared_ptr<ASTExprNode>) { return 0; }
+long long ScalarSubset::hash(std::shared_ptr<ASTValueNode>) { return 0; }
+long long ScalarSubset::hash(std::shared_ptr<ASTLiteralNode<flx_bool>>) { return 0; }
+long long ScalarSubset::hash(std::shared_ptr<ASTLiteralNode<flx_int>>) { return 0; }
+long long ScalarSubset::hash(std::shared_ptr<ASTLiteralNode<flx_float>>) { return 0; }
+long long ScalarSubset::hash(std::shared_ptr<ASTLiteralNode<flx_char>>) { return 0; }
+long long ScalarSubset::hash(std::shared_ptr<ASTLiteralNode<flx_string>>) { return 0; }
+long long ScalarSubset::hash(std::shared_ptr<ASTIdentifierNode>) { return 0; }
+
+void ScalarSubset::set_curr_pos(unsigned int row, unsigned int col) {
+	curr_row = row;
+	curr_col = col;
+}
+
+std::string ScalarSubset::msg_header() {
+	return current_program.top()->name + '[' + std::to_string(curr_row) + ':' + std::to_string(curr_col) + "]: ";
+}
@@ -0,0 +1,124 @@
+#ifndef SCALAR_SUBSET_HPP
+#define SCALAR_SUBSET_HPP
+
+#include <memory>
+#include <map>
+#include <set>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+
+#include "ast.hpp"
+
+using namespace visitor;
+using namespace parser;
+
+namespace visitor {
+
+	// raised for constructs outside the scalar subset, the message holds the position and the construct
+	class ScalarUnsupportedError : public std::runtime_error {
+	public:
+		explicit ScalarUnsupportedError(const std::string& what) : std::runtime_error(what) {}
+	};
+
+	// checks that a program stays inside the scalar subset run by the register vm, the closure engine and the transpiler:
+	// bool, int and float values, control flow, top level functions and print calls. inside it every engine follows
+	// the interpreter: a declared variable is visible only after its initializer, compound assignments operate on
+	// the current value and check the result against the declared type, ints read through a variable declared
+	// without a type divide as floats and arithmetic results keep that variable. variables are resolved dynamically,
+	// so globals read by functions must not be hidden by a local of a caller
+	class ScalarSubset : public Visitor {
+	private:
+		std::vector<std::set<std::string>> scopes;
+		std::set<std::string> globals;
+		std::unordered_map<std::string, size_t> functions;
+		std::vector<std::shared_ptr<ASTFunctionDefinitionNode>> function_nodes;
+		bool in_function = false;
+		size_t loop_depth = 0;
+
+		std::set<std::string> local_names;
+		std::set<std::string> function_globals;
+
+	private:
+		void declare_functions();
+		void check_function(const std::shared_ptr<ASTFunctionDefinitionNode>& fun);
+		void declare(const std::string& identifier);
+		void check_variable(const std::string& identifier, const std::string& what);
+		void check_plain(const std::string& identifier, const std::string& name_space,
+			const std::vector<Identifier>& identifier_vector, const std::string& what);
+		[[noreturn]] void unsupported(const std::string& what);
+
+		void set_curr_pos(unsigned int row, unsigned int col) override;
+		std::string msg_header() override;
+
+	public:
+		ScalarSubset(std::shared_ptr<ASTProgramNode> main_program, std::map<std::string, std::shared_ptr<ASTProgramNode>> programs);
+		~ScalarSubset() = default;
+
+		// throws ScalarUnsupportedError at the first construct outside the subset
+		void check();
+
+		static bool is_scalar(Type type);
+		static bool is_supported_variable(const TypeDefinition& type);
+		// static type of a binary operation, any when it is only known at run time
+		static Type result_type(const std::string& op, Type ltype, Type rtype);
+		// whether the result still refers to the untyped variable of the left value
+		static bool keeps_untyped(const std::string& op);
+
+		void visit(std::shared_ptr<ASTProgramNode>) override;
+		void visit(std::shared_ptr<ASTUsingNode>) override;
+		void visit(std::shared_ptr<ASTNamespaceManagerNode>) override;
+		void visit(std::shared_ptr<ASTDeclarationNode>) override;
+		void visit(std::shared_ptr<ASTUnpackedDeclarationNode>) override;
+		void visit(std::shared_ptr<ASTAssignmentNode>) override;
+		void visit(std::shared_ptr<ASTReturnNode>) override;
+		void visit(std::shared_ptr<ASTExitNode>) override;
+		void visit(std::shared_ptr<ASTBlockNode>) override;
+		void visit(std::shared_ptr<ASTContinueNode>) override;
+		void visit(std::shared_ptr<ASTBreakNode>) override;
+		void visit(std::shared_ptr<ASTSwitchNode>) override;
+		void visit(std::shared_ptr<ASTEnumNode>) override;
+		void visit(std::shared_ptr<ASTTryCatchNode>) override;
+		void visit(std::shared_ptr<ASTThrowNode>) override;
+		void visit(std::shared_ptr<ASTEllipsisNode>) override;
+		void visit(std::shared_ptr<ASTElseIfNode>) override;
+		void visit(std::shared_ptr<ASTIfNode>) override;
+		void visit(std::shared_ptr<ASTForNode>) override;
+		void visit(std::shared_ptr<ASTForEachNode>) override;
+		void visit(std::shared_ptr<ASTWhileNode>) override;
+		void visit(std::shared_ptr<ASTDoWhileNode>) override;
+		void visit(std::shared_ptr<ASTFunctionDefinitionNode>) override;
+		void visit(std::shared_ptr<ASTStructDefinitionNode>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_bool>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_int>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_float>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_char>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_string>>) override;
+		void visit(std::shared_ptr<ASTLambdaFunction>) override;
+		void visit(std::shared_ptr<ASTArrayConstructorNode>) override;
+		void visit(std::shared_ptr<ASTStructConstructorNode>) override;
+		void visit(std::shared_ptr<ASTBinaryExprNode>) override;
+		void visit(std::shared_ptr<ASTUnaryExprNode>) override;
+		void visit(std::shared_ptr<ASTIdentifierNode>) override;
+		void visit(std::shared_ptr<ASTTernaryNode>) override;
+		void visit(std::shared_ptr<ASTInNode>) override;
+		void visit(std::shared_ptr<ASTFunctionCallNode>) override;
+		void visit(std::shared_ptr<ASTTypeCastNode>) override;
+		void visit(std::shared_ptr<ASTNullNode>) override;
+		void visit(std::shared_ptr<ASTThisNode>) override;
+		void visit(std::shared_ptr<ASTTypingNode>) override;
+		void visit(std::shared_ptr<ASTValueNode>) override;
+		void visit(std::shared_ptr<ASTBuiltinCallNode>) override;
+
+		long long hash(std::shared_ptr<ASTExprNode>) override;
+		long long hash(std::shared_ptr<ASTValueNode>) override;
+		long long hash(std::shared_ptr<ASTIdentifierNode>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_bool>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_int>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_float>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_char>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_string>>) override;
+	};
+}
+
+#endif // !SCALAR_SUBSET_HPP
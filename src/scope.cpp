@@ -11,9 +11,13 @@ Scope::Scope(std::shared_ptr<ASTProgramNode> owner, std::string name) : owner(ow
 
 Scope::Scope(std::shared_ptr<ASTProgramNode> owner) : owner(owner) {}
 
-Scope::~Scope() = default;
+Scope::~Scope() {
+	if (!function_symbol_table.empty()) {
+		CallSiteCache::invalidate();
+	}
+}
 
-StructureDefinition Scope::find_declared_structure_definition(const std::string& identifier) {
+const StructureDefinition& Scope::find_declared_structure_definition(const std::string& identifier) {
 	return structure_symbol_table.at(identifier);
 }
 
@@ -23,17 +27,45 @@ std::shared_ptr<Variable> Scope::find_declared_variable(const std::string& ident
 	return var;
 }
 
+std::shared_ptr<Variable> Scope::find_declared_variable(size_t slot) {
+	if (slot >= variable_slots.size()) {
+		return nullptr;
+	}
+	auto& var = variable_slots[slot].second;
+	var->reset_ref();
+	return var;
+}
+
+long long Scope::find_variable_slot(const std::string& identifier) {
+	for (size_t i = 0; i < variable_slots.size(); ++i) {
+		if (variable_slots[i].first == identifier) {
+			return i;
+		}
+	}
+	return -1;
+}
+
 FunctionDefinition& Scope::find_declared_function(const std::string& identifier, const std::vector<TypeDefinition*>* signature,
 	dim_eval_func_t evaluate_access_vector, bool strict) {
-	auto funcs = function_symbol_table.equal_range(identifier);
-
-	if (std::distance(funcs.first, funcs.second) == 0) {
+	if (!already_declared_function_name(identifier)) {
 		throw std::runtime_error("definition of '" + identifier + "' function signature not found");
 	}
 
+	auto function = find_function(identifier, signature, evaluate_access_vector, strict);
+	if (!function) {
+		throw std::runtime_error("something went wrong when determining the type of '" + identifier + "' function");
+	}
+
+	return *function;
+}
+
+FunctionDefinition* Scope::find_function(const std::string& identifier, const std::vector<TypeDefinition*>* signature,
+	dim_eval_func_t evaluate_access_vector, bool strict) {
+	auto funcs = function_symbol_table.equal_range(identifier);
+
 	for (auto& it = funcs.first; it != funcs.second; ++it) {
 		if (it->second.is_var || !signature) {
-			return it->second;
+			return &it->second;
 		}
 
 		auto& func_sig = it->second.parameters;
@@ -57,7 +89,7 @@ FunctionDefinition& Scope::find_declared_function(const std::string& identifier,
 			}
 
 			if (found) {
-				return it->second;
+				return &it->second;
 			}
 		}
 
@@ -91,7 +123,7 @@ FunctionDefinition& Scope::find_declared_function(const std::string& identifier,
 			}
 
 			if (found) {
-				return it->second;
+				return &it->second;
 			}
 		}
 
@@ -120,12 +152,12 @@ FunctionDefinition& Scope::find_declared_function(const std::string& identifier,
 
 			// if found and exactly signature size (not rest)
 			if (found) {
-				return it->second;
+				return &it->second;
 			}
 		}
 	}
 
-	throw std::runtime_error("something went wrong when determining the type of '" + identifier + "' function");
+	return nullptr;
 }
 
 std::pair<std::unordered_multimap<std::string, FunctionDefinition>::iterator,
@@ -148,23 +180,11 @@ bool Scope::already_declared_variable(const std::string& identifier) {
 
 bool Scope::already_declared_function(const std::string& identifier, const std::vector<TypeDefinition*>* signature,
 	dim_eval_func_t evaluate_access_vector, bool strict) {
-	try {
-		find_declared_function(identifier, signature, evaluate_access_vector, strict);
-		return true;
-	}
-	catch (...) {
-		return false;
-	}
+	return find_function(identifier, signature, evaluate_access_vector, strict) != nullptr;
 }
 
 bool Scope::already_declared_function_name(const std::string& identifier) {
-	try {
-		find_declared_functions(identifier);
-		return true;
-	}
-	catch (...) {
-		return false;
-	}
+	return function_symbol_table.find(identifier) != function_symbol_table.end();
 }
 
 
@@ -172,14 +192,31 @@ size_t Scope::total_declared_variables() {
 	return variable_symbol_table.size();
 }
 
+std::vector<std::string> Scope::declared_variable_identifiers() {
+	std::vector<std::string> identifiers;
+	for (const auto& slot : variable_slots) {
+		identifiers.push_back(slot.first);
+	}
+	return identifiers;
+}
+
 void Scope::declare_structure_definition(StructureDefinition structure) {
 	structure_symbol_table[structure.identifier] = structure;
 }
 
 void Scope::declare_variable(const std::string& identifier, const std::shared_ptr<Variable>& variable) {
-	variable_symbol_table[identifier] = variable;
+	auto it = variable_symbol_table.find(identifier);
+	if (it != variable_symbol_table.end()) {
+		// redeclaration keeps its slot
+		it->second = variable;
+		variable_slots[find_variable_slot(identifier)].second = variable;
+		return;
+	}
+	variable_symbol_table.emplace(identifier, variable);
+	variable_slots.emplace_back(identifier, variable);
 }
 
 void Scope::declare_function(const std::string& identifier, FunctionDefinition function) {
 	function_symbol_table.insert(std::make_pair(identifier, function));
+	CallSiteCache::invalidate();
 }
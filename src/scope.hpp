@@ -19,10 +19,14 @@ namespace visitor {
 		std::unordered_map<std::string, StructureDefinition> structure_symbol_table;
 		std::unordered_multimap<std::string, FunctionDefinition> function_symbol_table;
 		std::unordered_map<std::string, std::shared_ptr<Variable>> variable_symbol_table;
+		// variables in declaration order, addressed by slot
+		std::vector<std::pair<std::string, std::shared_ptr<Variable>>> variable_slots;
 
 	public:
 		std::string name;
 		std::shared_ptr<ASTProgramNode> owner;
+		// slots depend on the path taken at run time, lexical addresses never reach them
+		bool dynamic_slots = false;
 
 		Scope(std::shared_ptr<ASTProgramNode> owner, std::string name);
 		Scope(std::shared_ptr<ASTProgramNode> owner);
@@ -35,17 +39,24 @@ namespace visitor {
 		bool already_declared_function_name(const std::string& identifier);
 
 		size_t total_declared_variables();
+		std::vector<std::string> declared_variable_identifiers();
 
 		void declare_structure_definition(StructureDefinition structure);
 		void declare_function(const std::string& identifier, FunctionDefinition function);
 		void declare_variable(const std::string& identifier, const std::shared_ptr<Variable>& variable);
 
-		StructureDefinition find_declared_structure_definition(const std::string& identifier);
+		const StructureDefinition& find_declared_structure_definition(const std::string& identifier);
 		FunctionDefinition& find_declared_function(const std::string& identifier, const std::vector<TypeDefinition*>* signature,
 			dim_eval_func_t evaluate_access_vector, bool strict = true);
+		// returns nullptr when no overload matches the signature
+		FunctionDefinition* find_function(const std::string& identifier, const std::vector<TypeDefinition*>* signature,
+			dim_eval_func_t evaluate_access_vector, bool strict = true);
 		std::pair<std::unordered_multimap<std::string, FunctionDefinition>::iterator,
 			std::unordered_multimap<std::string, FunctionDefinition>::iterator> find_declared_functions(const std::string& identifier);
 		std::shared_ptr<Variable> find_declared_variable(const std::string& identifier);
+		// the semantic analysis checked the slot layout, returns nullptr past the declared slots
+		std::shared_ptr<Variable> find_declared_variable(size_t slot);
+		long long find_variable_slot(const std::string& identifier);
 
 	};
 }
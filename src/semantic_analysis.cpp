@@ -1,5 +1,6 @@
 #include <iostream>
 #include <utility>
+#include <algorithm>
 
 #include "semantic_analysis.hpp"
 #include "exception_handler.hpp"
@@ -25,9 +26,12 @@ SemanticAnalyser::SemanticAnalyser(std::shared_ptr<Scope> global_scope, std::sha
 
 void SemanticAnalyser::start() {
 	visit(current_program.top());
+	mark_tail_calls();
 }
 
 void SemanticAnalyser::visit(std::shared_ptr<ASTProgramNode> astnode) {
+	frame_scopes.push(&scopes[get_namespace()]);
+
 	for (const auto& statement : astnode->statements) {
 		try {
 			statement->accept(this);
@@ -43,6 +47,8 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTProgramNode> astnode) {
 			throw std::runtime_error(msg_header() + ex.what());
 		}
 	}
+
+	frame_scopes.pop();
 }
 
 void SemanticAnalyser::visit(std::shared_ptr<ASTUsingNode> astnode) {
@@ -84,7 +90,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTUsingNode> astnode) {
 			program_nmspaces[program->name].push_back(default_namespace);
 		}
 
-		start();
+		visit(program);
 
 		current_program.pop();
 		pop_namespace(pop);
@@ -236,6 +242,7 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTAssignmentNode> astnode) {
 	}
 
 	std::shared_ptr<Scope> curr_scope = get_inner_most_variable_scope(prg, name_space, identifier);
+	resolve_lexical_address(astnode->address, astnode->name_space.empty() ? name_space : "", curr_scope, identifier);
 	if (!curr_scope) {
 		bool isfunc = false;
 		curr_scope = get_inner_most_function_scope(prg, name_space, identifier, nullptr, evaluate_access_vector_ptr);
@@ -303,11 +310,20 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTReturnNode> astnode) {
 		if (!TypeDefinition::is_any_or_match_type(currfun, return_expr, evaluate_access_vector_ptr)) {
 			ExceptionHandler::throw_return_type_err(currfun.identifier, currfun, return_expr, evaluate_access_vector_ptr);
 		}
+
+		// a call whose value is returned without access can run in the frame of the function
+		if (const auto call = std::dynamic_pointer_cast<ASTFunctionCallNode>(astnode->expr)) {
+			// decided once every function is analysed, the callee may be defined later
+			if (try_depth == 0 && call->identifier_vector.size() == 1 && call->identifier_vector[0].access_vector.empty()) {
+				tail_call_candidates.push_back({ call, { called_function_scope, call->identifier, function_variable_names(get_namespace()) } });
+			}
+		}
 	}
 }
 
 void SemanticAnalyser::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
 	set_curr_pos(astnode->row, astnode->col);
+	auto caller_name_space = get_namespace();
 	auto pop = push_namespace(astnode->name_space);
 	const auto& prg = current_program.top();
 	const auto& prg_name = current_program.top()->name;
@@ -334,6 +350,11 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
 	}
 
 	auto& curr_function = curr_scope->find_declared_function(astnode->identifier, &signature, evaluate_access_vector_ptr, strict);
+	called_function_scope = curr_scope;
+
+	if (!current_function.empty()) {
+		function_reads[current_function.top().block.get()].calls.push_back({ curr_scope, astnode->identifier, function_variable_names(caller_name_space) });
+	}
 
 	if (is_void(curr_function.type)) {
 		current_expression = SemanticValue(Type::T_UNDEFINED, 0, 0);
@@ -373,12 +394,11 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode)
 		auto array_type = (is_void(astnode->array_type) || is_undefined(astnode->array_type)) && has_return ? Type::T_ANY : astnode->array_type;
 
 		if (astnode->identifier != "") {
-			try {
-				std::shared_ptr<Scope> func_scope = scopes[name_space].back();
-				auto& declfun = func_scope->find_declared_function(astnode->identifier, &astnode->parameters, evaluate_access_vector_ptr, true);
-				declfun.block = astnode->block;
+			std::shared_ptr<Scope> func_scope = scopes[name_space].back();
+			if (auto declfun = func_scope->find_function(astnode->identifier, &astnode->parameters, evaluate_access_vector_ptr, true)) {
+				declfun->block = astnode->block;
 			}
-			catch (...) {
+			else {
 				auto f = FunctionDefinition(astnode->identifier, type, astnode->type_name, astnode->type_name_space,
 					array_type, astnode->dim, astnode->parameters, astnode->block, astnode->row, astnode->row);
 				scopes[name_space].back()->declare_function(astnode->identifier, f);
@@ -389,8 +409,14 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTFunctionDefinitionNode> astnode)
 			current_function.push(curr_function);
 		}
 
+		auto outer_try_depth = try_depth;
+		try_depth = 0;
+
+		is_function_block = true;
 		astnode->block->accept(this);
 
+		try_depth = outer_try_depth;
+
 		if (!is_void(type)) {
 			if (!has_return) {
 				throw std::runtime_error("defined function '" + astnode->identifier + "' is not guaranteed to return a value");
@@ -441,14 +467,25 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTBlockNode> astnode) {
 
 	auto& curr_scope = scopes[name_space].back();
 
-	if (!current_function.empty()) {
-		for (auto param : current_function.top().parameters) {
-			if (const auto decl = dynamic_cast<VariableDefinition*>(param)) {
-				declare_function_parameter(curr_scope, *decl);
-			}
-			else if (const auto decls = dynamic_cast<UnpackedVariableDefinition*>(param)) {
-				for (auto& decl : decls->variables) {
-					declare_function_parameter(curr_scope, decl);
+	// parameters are declared only in the function own block, as the interpreter does
+	auto function_block = is_function_block;
+	is_function_block = false;
+
+	if (function_block) {
+		function_scope_base.push(scopes[name_space].size() - 1);
+		frame_scopes.push(&scopes[name_space]);
+
+		if (!current_function.empty()) {
+			for (auto param : current_function.top().parameters) {
+				if (const auto decl = dynamic_cast<VariableDefinition*>(param)) {
+					// rest values and function parameters are declared depending on the arguments
+					curr_scope->dynamic_slots = curr_scope->dynamic_slots || decl->is_rest || is_function(decl->type);
+					declare_function_parameter(curr_scope, *decl);
+				}
+				else if (const auto decls = dynamic_cast<UnpackedVariableDefinition*>(param)) {
+					for (auto& decl : decls->variables) {
+						declare_function_parameter(curr_scope, decl);
+					}
 				}
 			}
 		}
@@ -458,6 +495,11 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTBlockNode> astnode) {
 		stmt->accept(this);
 	}
 
+	if (function_block) {
+		function_scope_base.pop();
+		frame_scopes.pop();
+	}
+
 	scopes[name_space].pop_back();
 }
 
@@ -499,6 +541,8 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTSwitchNode> astnode) {
 	const auto& prg = current_program.top();
 
 	scopes[name_space].push_back(std::make_shared<Scope>(prg));
+	// execution starts at the matching case, so the declarations before it are skipped
+	scopes[name_space].back()->dynamic_slots = true;
 
 	astnode->parsed_case_blocks = std::map<unsigned int, unsigned int>();
 
@@ -638,12 +682,13 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTForEachNode> astnode) {
 	const auto& name_space = get_namespace();
 	const auto& prg = current_program.top();
 
-	scopes[name_space].push_back(std::make_shared<Scope>(prg));
-	std::shared_ptr<Scope> back_scope = scopes[name_space].back();
-
+	// collection is evaluated before the meta scope, as the interpreter does
 	astnode->collection->accept(this);
 	col_value = current_expression;
 
+	scopes[name_space].push_back(std::make_shared<Scope>(prg));
+	std::shared_ptr<Scope> back_scope = scopes[name_space].back();
+
 	if (const auto idnode = std::dynamic_pointer_cast<ASTUnpackedDeclarationNode>(astnode->itdecl)) {
 		if (!is_struct(col_value.type) && !is_any(col_value.type)) {
 			throw std::runtime_error("[key, value] can only be used with struct");
@@ -728,7 +773,9 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTTryCatchNode> astnode) {
 	const auto& name_space = get_namespace();
 	const auto& prg = current_program.top();
 
+	++try_depth;
 	astnode->try_block->accept(this);
+	--try_depth;
 
 	scopes[name_space].push_back(std::make_shared<Scope>(prg));
 
@@ -997,6 +1044,8 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
 
 	std::shared_ptr<Scope> curr_scope = get_inner_most_variable_scope(prg, name_space, astnode->identifier);
 
+	resolve_lexical_address(astnode->address, astnode->name_space.empty() ? name_space : "", curr_scope, astnode->identifier);
+
 	if (!curr_scope) {
 		current_expression = SemanticValue();
 		if (astnode->identifier == "bool") {
@@ -1084,6 +1133,18 @@ void SemanticAnalyser::visit(std::shared_ptr<ASTBinaryExprNode> astnode) {
 
 	current_expression = SemanticValue(do_operation(astnode->op, lexpr, lexpr, nullptr, rexpr, true), 0, false, 0, 0);
 	current_expression.is_const = lexpr.is_const && rexpr.is_const;
+
+	// lets the compiler emit type specialized operations
+	auto operand_type = proven_numeric_type(astnode->left);
+	if (operand_type != proven_numeric_type(astnode->right)) {
+		operand_type = Type::T_ANY;
+	}
+	if (is_undefined(astnode->operand_type)) {
+		astnode->operand_type = operand_type;
+	}
+	else if (astnode->operand_type != operand_type) {
+		astnode->operand_type = Type::T_ANY;
+	}
 }
 
 void SemanticAnalyser::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
@@ -1280,6 +1341,113 @@ void SemanticAnalyser::declare_function_parameter(std::shared_ptr<Scope> scope,
 	}
 }
 
+void SemanticAnalyser::resolve_lexical_address(LexicalAddress& address, const std::string& name_space, std::shared_ptr<Scope> scope, const std::string& identifier) {
+	long long depth = -1;
+	long long slot = -1;
+	bool local = false;
+
+	// the interpreter looks addresses up in the scopes of the running frame
+	if (scope && !name_space.empty() && &scopes[name_space] == frame_scopes.top()) {
+		const auto& name_space_scopes = scopes[name_space];
+		long long base = function_scope_base.empty() ? 0 : function_scope_base.top();
+
+		for (long long i = name_space_scopes.size() - 1; i >= base; --i) {
+			if (name_space_scopes[i] == scope) {
+				local = true;
+				if (!scope->dynamic_slots) {
+					depth = name_space_scopes.size() - 1 - i;
+					slot = scope->find_variable_slot(identifier);
+				}
+				break;
+			}
+		}
+	}
+
+	if (scope && !local && !current_function.empty()) {
+		function_reads[current_function.top().block.get()].free_names.insert(identifier);
+	}
+
+	address.resolve(depth, slot);
+}
+
+std::set<std::string> SemanticAnalyser::function_variable_names(const std::string& name_space) {
+	std::set<std::string> names;
+	const auto& function_scopes = scopes[name_space];
+	for (size_t i = function_scope_base.top(); i < function_scopes.size(); ++i) {
+		for (const auto& variable : function_scopes[i]->declared_variable_identifiers()) {
+			names.insert(variable);
+		}
+	}
+	return names;
+}
+
+void SemanticAnalyser::called_function_reads(const CalledFunction& call, FunctionReads& reads) {
+	auto functions = call.scope->find_declared_functions(call.identifier);
+	for (auto it = functions.first; it != functions.second; ++it) {
+		// function variables and declarations defined in another scope run an unknown block
+		if (it->second.is_var || !it->second.block) {
+			reads.reads_any = true;
+			continue;
+		}
+
+		// builtin blocks are never analysed and read only their arguments
+		auto callee = function_reads.find(it->second.block.get());
+		if (callee == function_reads.end()) {
+			continue;
+		}
+		reads.reads_any = reads.reads_any || callee->second.reads_any;
+		for (const auto& name : callee->second.free_names) {
+			if (call.visible_names.find(name) == call.visible_names.end()) {
+				reads.free_names.insert(name);
+			}
+		}
+	}
+}
+
+void SemanticAnalyser::mark_tail_calls() {
+	// names read through calls, a variable of the caller visible at the call hides the name from the callee
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (auto& function : function_reads) {
+			auto& reads = function.second;
+			auto read_count = reads.free_names.size();
+			auto reads_any = reads.reads_any;
+			for (const auto& call : reads.calls) {
+				called_function_reads(call, reads);
+			}
+			changed = changed || reads.free_names.size() != read_count || reads.reads_any != reads_any;
+		}
+	}
+
+	// variables are resolved dynamically, a callee running in the frame of the caller must not read its variables
+	for (const auto& candidate : tail_call_candidates) {
+		const auto& call = candidate.second;
+		bool safe = true;
+
+		auto functions = call.scope->find_declared_functions(call.identifier);
+		for (auto it = functions.first; it != functions.second && safe; ++it) {
+			for (const auto param : it->second.parameters) {
+				if (const auto decl = dynamic_cast<VariableDefinition*>(param)) {
+					safe = safe && !decl->default_value;
+				}
+			}
+		}
+
+		FunctionReads reads;
+		called_function_reads({ call.scope, call.identifier, {} }, reads);
+		safe = safe && !reads.reads_any;
+		for (const auto& name : call.visible_names) {
+			safe = safe && reads.free_names.find(name) == reads.free_names.end();
+		}
+
+		candidate.first->is_tail_call = safe;
+	}
+
+	tail_call_candidates.clear();
+	function_reads.clear();
+}
+
 bool SemanticAnalyser::namespace_exists(const std::string& name_space) {
 	return scopes.find(name_space) != scopes.end();
 }
@@ -1510,6 +1678,47 @@ std::vector<unsigned int> SemanticAnalyser::evaluate_access_vector(const std::ve
 	return access_vector;
 }
 
+Type SemanticAnalyser::proven_numeric_type(std::shared_ptr<ASTExprNode> astnode) {
+	if (std::dynamic_pointer_cast<ASTLiteralNode<flx_int>>(astnode)) {
+		return Type::T_INT;
+	}
+
+	if (std::dynamic_pointer_cast<ASTLiteralNode<flx_float>>(astnode)) {
+		return Type::T_FLOAT;
+	}
+
+	if (const auto& idnode = std::dynamic_pointer_cast<ASTIdentifierNode>(astnode)) {
+		if (idnode->identifier_vector.size() != 1 || idnode->identifier_vector[0].access_vector.size() > 0) {
+			return Type::T_ANY;
+		}
+
+		auto pop = push_namespace(idnode->name_space);
+		auto scope = get_inner_most_variable_scope(current_program.top(), get_namespace(), idnode->identifier);
+		pop_namespace(pop);
+
+		if (!scope) {
+			return Type::T_ANY;
+		}
+
+		// only the declared type is kept at runtime, the value type of an untyped variable may change
+		auto variable = std::dynamic_pointer_cast<SemanticVariable>(scope->find_declared_variable(idnode->identifier));
+		if (is_int(variable->type) || is_float(variable->type)) {
+			return variable->type;
+		}
+
+		return Type::T_ANY;
+	}
+
+	if (const auto& binnode = std::dynamic_pointer_cast<ASTBinaryExprNode>(astnode)) {
+		if ((is_int(binnode->operand_type) || is_float(binnode->operand_type))
+			&& (binnode->op == "+" || binnode->op == "-" || binnode->op == "*")) {
+			return binnode->operand_type;
+		}
+	}
+
+	return Type::T_ANY;
+}
+
 bool SemanticAnalyser::returns(std::shared_ptr<ASTNode> astnode) {
 	if (std::dynamic_pointer_cast<ASTReturnNode>(astnode)
 		|| std::dynamic_pointer_cast<ASTThrowNode>(astnode)) {
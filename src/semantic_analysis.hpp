@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <map>
+#include <set>
 #include <vector>
 #include <stack>
 #include <xutility>
@@ -26,9 +27,35 @@ namespace visitor {
 		std::vector<std::string> nmspaces;
 		SemanticValue current_expression;
 		std::stack<FunctionDefinition> current_function;
+		// index of each function block scope, lexical addresses never reach below it
+		std::stack<size_t> function_scope_base;
+		// scope stack of each running program or function, lexical addresses are taken only in it
+		std::stack<const std::vector<std::shared_ptr<Scope>>*> frame_scopes;
+		bool is_function_block = false;
 		bool exception = false;
 		bool is_switch = false;
 		bool is_loop = false;
+		// try blocks of the current function, their calls cannot leave the frame before returning
+		size_t try_depth = 0;
+		// scope of the function resolved by the last visited call
+		std::shared_ptr<Scope> called_function_scope;
+
+		// overloads a call may run, kept alive until the tail calls are decided
+		struct CalledFunction {
+			std::shared_ptr<Scope> scope;
+			std::string identifier;
+			// variables of the calling function visible at the call
+			std::set<std::string> visible_names;
+		};
+		// names a function reads without declaring them, directly or through its calls
+		struct FunctionReads {
+			std::set<std::string> free_names;
+			// calls to unknown blocks may read anything
+			bool reads_any = false;
+			std::vector<CalledFunction> calls;
+		};
+		std::map<ASTBlockNode*, FunctionReads> function_reads;
+		std::vector<std::pair<std::shared_ptr<ASTFunctionCallNode>, CalledFunction>> tail_call_candidates;
 
 		std::vector<std::shared_ptr<ASTExprNode>> current_expression_array_dim;
 		int current_expression_array_dim_max;
@@ -37,8 +64,13 @@ namespace visitor {
 
 	private:
 		bool returns(std::shared_ptr<ASTNode> astnode);
+		Type proven_numeric_type(std::shared_ptr<ASTExprNode> astnode);
 
 		void declare_function_parameter(std::shared_ptr<Scope> scope, const VariableDefinition& param);
+		std::set<std::string> function_variable_names(const std::string& name_space);
+		void called_function_reads(const CalledFunction& call, FunctionReads& reads);
+		void mark_tail_calls();
+		void resolve_lexical_address(LexicalAddress& address, const std::string& name_space, std::shared_ptr<Scope> scope, const std::string& identifier);
 
 		void equals_value(const SemanticValue& lval, const SemanticValue& rval);
 
@@ -0,0 +1,771 @@
+#include <sstream>
+#include <iomanip>
+
+#include "transpiler.hpp"
+#include "scalar_subset.hpp"
+#include "token.hpp"
+
+using namespace visitor;
+using namespace parser;
+using namespace lexer;
+
+Transpiler::Transpiler(std::shared_ptr<ASTProgramNode> main_program, std::map<std::string, std::shared_ptr<ASTProgramNode>> programs)
+	: Visitor(programs, main_program, default_namespace) {}
+
+void Transpiler::start() {
+	const auto& name = current_program.top()->name;
+
+	try {
+		ScalarSubset(main_program, programs).check();
+	}
+	catch (const ScalarUnsupportedError& ex) {
+		throw std::runtime_error("(TRSP) " + std::string(ex.what()) + " is not supported by the transpiler");
+	}
+
+	declare_functions();
+
+	std::string main_code;
+	out = &main_code;
+	indent = 1;
+	scopes.emplace_back();
+	visit(current_program.top());
+
+	// the top level scope of the main program holds the globals seen by the functions
+	global_variables = scopes.front();
+	scopes.clear();
+
+	std::string prototypes;
+	for (const auto& fun : function_nodes) {
+		transpile_function(fun);
+	}
+	for (const auto& fun : function_nodes) {
+		const auto& function = function_signatures[fun->identifier];
+		prototypes += "static " + native_type(function.type) + " " + function.name + "(";
+		for (size_t i = 0; i < function.parameters.size(); ++i) {
+			prototypes += (i > 0 ? ", " : "") + native_type(function.parameters[i]);
+		}
+		prototypes += ");\n";
+	}
+
+	source = "// translated from '" + name + "', build it together with the interpreter sources except main.cpp\n\n";
+	source += "#include \"aot_runtime.hpp\"\n\n";
+	if (!globals.empty()) {
+		source += globals + "\n";
+	}
+	if (!prototypes.empty()) {
+		source += prototypes + "\n";
+	}
+	source += functions;
+	source += "static void program_main() {\n" + main_code + "}\n\n";
+	source += "int main() {\n\treturn aot::run(" + string_literal(name) + ", program_main);\n}\n";
+}
+
+void Transpiler::declare_functions() {
+	for (const auto& statement : current_program.top()->statements) {
+		auto fun = std::dynamic_pointer_cast<ASTFunctionDefinitionNode>(statement);
+		if (!fun) {
+			continue;
+		}
+		TranspilerFunction function;
+		function.name = "f_" + fun->identifier;
+		function.type = is_native(fun->type) ? fun->type : Type::T_ANY;
+		for (const auto param : fun->parameters) {
+			function.parameters.push_back(dynamic_cast<VariableDefinition*>(param)->type);
+		}
+
+		function_signatures[fun->identifier] = function;
+		function_nodes.push_back(fun);
+	}
+}
+
+void Transpiler::transpile_function(const std::shared_ptr<ASTFunctionDefinitionNode>& fun) {
+	set_curr_pos(fun->row, fun->col);
+
+	current_function = &function_signatures[fun->identifier];
+	std::string code;
+	out = &code;
+	indent = 1;
+	next_temporary = 0;
+	scopes.clear();
+	scopes.emplace_back();
+
+	std::string parameters;
+	for (size_t i = 0; i < fun->parameters.size(); ++i) {
+		auto var = dynamic_cast<VariableDefinition*>(fun->parameters[i]);
+		// arguments arrive already checked against the parameter types
+		auto name = declare_variable(var->identifier, var->type, false);
+		parameters += (i > 0 ? ", " : "") + native_type(var->type) + " " + name;
+	}
+
+	for (const auto& statement : fun->block->statements) {
+		transpile_statement(statement);
+	}
+	line("return " + native_type(current_function->type) + "();");
+
+	functions += "static " + native_type(current_function->type) + " " + current_function->name + "(" + parameters + ") {\n" + code + "}\n\n";
+
+	scopes.clear();
+	current_function = nullptr;
+}
+
+void Transpiler::transpile_statement(std::shared_ptr<ASTNode> statement) {
+	// calls used as statements do not need their result
+	discard_result = std::dynamic_pointer_cast<ASTFunctionCallNode>(statement) != nullptr;
+	statement->accept(this);
+	discard_result = false;
+}
+
+void Transpiler::transpile_block(std::shared_ptr<ASTBlockNode> block) {
+	scopes.emplace_back();
+	for (const auto& statement : block->statements) {
+		transpile_statement(statement);
+	}
+	scopes.pop_back();
+}
+
+void Transpiler::transpile_loop_body(std::shared_ptr<ASTBlockNode> block) {
+	// continue jumps past the body, which keeps its declarations in their own scope
+	continue_labels.emplace_back("continue_" + std::to_string(next_loop++), false);
+	open_block("");
+	transpile_block(block);
+	close_block();
+	if (continue_labels.back().second) {
+		line(continue_labels.back().first + ":;");
+	}
+	continue_labels.pop_back();
+}
+
+void Transpiler::transpile_assignment(const std::string& identifier, const std::string& op, std::shared_ptr<ASTExprNode> expr) {
+	const auto variable = *find_variable(identifier);
+	const TranspilerOperand target{ variable.name, variable.type, variable.untyped };
+
+	auto operand = transpile_expression(expr);
+	if (op != "=") {
+		operand = binary_operation(op.substr(0, op.size() - 1), target, operand);
+	}
+	line(variable.name + " = " + convert(operand, variable.type) + ";");
+	current_operand = target;
+}
+
+void Transpiler::line(const std::string& code) {
+	out->append(indent, '\t');
+	out->append(code);
+	out->push_back('\n');
+}
+
+void Transpiler::open_block(const std::string& code) {
+	line(code.empty() ? "{" : code + " {");
+	++indent;
+}
+
+void Transpiler::close_block() {
+	--indent;
+	line("}");
+}
+
+void Transpiler::position() {
+	const auto code = "aot::at(" + std::to_string(curr_row) + ", " + std::to_string(curr_col) + ");";
+	// conditions report the position of the operation that computed them
+	if (!out->ends_with(code + '\n')) {
+		line(code);
+	}
+}
+
+TranspilerOperand Transpiler::transpile_expression(std::shared_ptr<ASTExprNode> expr) {
+	current_operand = TranspilerOperand{ "", Type::T_ANY, false };
+	expr->accept(this);
+	return current_operand;
+}
+
+std::string Transpiler::transpile_condition(std::shared_ptr<ASTExprNode> condition) {
+	auto operand = transpile_expression(condition);
+	if (is_bool(operand.type)) {
+		return operand.code;
+	}
+	position();
+	return "aot::condition(" + dynamic(operand) + ")";
+}
+
+TranspilerOperand Transpiler::temporary(Type type, const std::string& code, bool untyped) {
+	auto name = "t" + std::to_string(next_temporary++);
+	line("const " + native_type(type) + " " + name + " = " + code + ";");
+	return TranspilerOperand{ name, is_native(type) ? type : Type::T_ANY, untyped };
+}
+
+TranspilerOperand Transpiler::binary_operation(const std::string& op, const TranspilerOperand& lval, const TranspilerOperand& rval) {
+	const bool untyped = lval.untyped && ScalarSubset::keeps_untyped(op);
+
+	Type type = Type::T_ANY;
+	auto code = native_operation(op, lval, rval, type);
+	if (!code.empty()) {
+		return temporary(type, code, untyped);
+	}
+
+	position();
+	const auto function = lval.untyped && (op == "/" || op == "/%") ? "aot::untyped_division" : "aot::operation";
+	return temporary(Type::T_ANY, std::string(function) + "(" + string_literal(op) + ", " + dynamic(lval) + ", " + dynamic(rval) + ")", untyped);
+}
+
+std::string Transpiler::native_operation(const std::string& op, const TranspilerOperand& lval, const TranspilerOperand& rval, Type& type) {
+	if (!is_native(lval.type) || !is_native(rval.type)) {
+		return "";
+	}
+
+	if (is_bool(lval.type) || is_bool(rval.type)) {
+		if (!is_bool(lval.type) || !is_bool(rval.type)) {
+			return "";
+		}
+		type = Type::T_BOOL;
+		if (Token::is_equality_op(op)) {
+			return lval.code + " " + op + " " + rval.code;
+		}
+		if (op == "or") {
+			return lval.code + " || " + rval.code;
+		}
+		return "";
+	}
+
+	// mixed int and float operands compute in float
+	const bool is_int_operation = is_int(lval.type) && is_int(rval.type);
+	const auto l = is_int_operation || is_float(lval.type) ? lval.code : "flx_float(" + lval.code + ")";
+	const auto r = is_int_operation || is_float(rval.type) ? rval.code : "flx_float(" + rval.code + ")";
+	type = is_int_operation ? Type::T_INT : Type::T_FLOAT;
+
+	if (op == "+" || op == "-" || op == "*") {
+		return l + " " + op + " " + r;
+	}
+
+	static const std::unordered_map<std::string, std::string> checked = {
+		{ "/", "aot::divide" }, { "%", "aot::remainder" }, { "/%", "aot::floor_divide" }, { "**", "aot::power" }
+	};
+	auto it = checked.find(op);
+	if (it != checked.end()) {
+		position();
+		return it->second + "(" + l + ", " + r + ")";
+	}
+
+	if (op == "<=>") {
+		type = Type::T_INT;
+		return "aot::compare(" + lval.code + ", " + rval.code + ")";
+	}
+
+	if (Token::is_equality_op(op) || Token::is_relational_op(op)) {
+		type = Type::T_BOOL;
+		return lval.code + " " + op + " " + rval.code;
+	}
+
+	if (is_int_operation && (op == "&" || op == "|" || op == "^" || op == "<<" || op == ">>")) {
+		return l + " " + op + " " + r;
+	}
+
+	return "";
+}
+
+std::string Transpiler::convert(const TranspilerOperand& operand, Type type) {
+	if (!is_native(type)) {
+		return dynamic(operand);
+	}
+	if (operand.type == type) {
+		return operand.code;
+	}
+	if (is_float(type) && is_int(operand.type)) {
+		return "flx_float(" + operand.code + ")";
+	}
+
+	position();
+	const std::string function = is_bool(type) ? "aot::to_bool" : is_int(type) ? "aot::to_int" : "aot::to_float";
+	return function + "(" + dynamic(operand) + ")";
+}
+
+std::string Transpiler::dynamic(const TranspilerOperand& operand) {
+	return is_native(operand.type) ? "aot::DynamicValue(" + operand.code + ")" : operand.code;
+}
+
+std::string Transpiler::declare_variable(const std::string& identifier, Type type, bool untyped) {
+	auto name = "v_" + identifier + "_" + std::to_string(next_variable++);
+	scopes.back()[identifier] = TranspilerVariable{ name, type, untyped };
+	return name;
+}
+
+const TranspilerVariable* Transpiler::find_variable(const std::string& identifier) const {
+	for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+		auto var = it->find(identifier);
+		if (var != it->end()) {
+			return &var->second;
+		}
+	}
+	if (current_function) {
+		auto var = global_variables.find(identifier);
+		if (var != global_variables.end()) {
+			return &var->second;
+		}
+	}
+	return nullptr;
+}
+
+bool Transpiler::is_native(Type type) {
+	return is_bool(type) || is_int(type) || is_float(type);
+}
+
+std::string Transpiler::native_type(Type type) {
+	switch (type) {
+	case Type::T_BOOL:
+		return "flx_bool";
+	case Type::T_INT:
+		return "flx_int";
+	case Type::T_FLOAT:
+		return "flx_float";
+	default:
+		return "aot::DynamicValue";
+	}
+}
+
+std::string Transpiler::type_constant(Type type) {
+	switch (type) {
+	case Type::T_BOOL:
+		return "Type::T_BOOL";
+	case Type::T_INT:
+		return "Type::T_INT";
+	default:
+		return "Type::T_FLOAT";
+	}
+}
+
+std::string Transpiler::string_literal(const std::string& value) {
+	std::ostringstream s;
+	s << '"';
+	for (const unsigned char c : value) {
+		switch (c) {
+		case '"':
+			s << "\\\"";
+			break;
+		case '\\':
+			s << "\\\\";
+			break;
+		case '\n':
+			s << "\\n";
+			break;
+		case '\t':
+			s << "\\t";
+			break;
+		default:
+			// octal escapes keep multibyte characters intact
+			if (c < 0x20 || c >= 0x7F) {
+				s << '\\' << std::oct << std::setw(3) << std::setfill('0') << int(c) << std::dec;
+			}
+			else {
+				s << c;
+			}
+			break;
+		}
+	}
+	s << '"';
+	return s.str();
+}
+
+std::string Transpiler::float_literal(flx_float value) {
+	// hexadecimal literals keep every bit of the value
+	std::ostringstream s;
+	s << std::hexfloat << value;
+	return "flx_float(" + s.str() + "L)";
+}
+
+void Transpiler::visit(std::shared_ptr<ASTProgramNode> astnode) {
+	for (const auto& statement : astnode->statements) {
+		transpile_statement(statement);
+	}
+}
+
+void Transpiler::visit(std::shared_ptr<ASTUsingNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTNamespaceManagerNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTDeclarationNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	std::string value = native_type(astnode->type) + "()";
+	if (astnode->expr) {
+		auto operand = transpile_expression(astnode->expr);
+		value = convert(operand, astnode->type);
+	}
+
+	const bool is_global = !current_function && scopes.size() == 1;
+	auto name = declare_variable(astnode->identifier, astnode->type, is_any(astnode->type));
+	if (is_global) {
+		globals += "static " + native_type(astnode->type) + " " + name + ";\n";
+		line(name + " = " + value + ";");
+	}
+	else {
+		line(native_type(astnode->type) + " " + name + " = " + value + ";");
+	}
+}
+
+void Transpiler::visit(std::shared_ptr<ASTUnpackedDeclarationNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTAssignmentNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	transpile_assignment(astnode->identifier, astnode->op, astnode->expr);
+}
+
+void Transpiler::visit(std::shared_ptr<ASTReturnNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	if (astnode->expr) {
+		auto operand = transpile_expression(astnode->expr);
+		line("return " + convert(operand, current_function->type) + ";");
+	}
+	else {
+		line("return " + native_type(current_function->type) + "();");
+	}
+}
+
+void Transpiler::visit(std::shared_ptr<ASTExitNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto operand = transpile_expression(astnode->exit_code);
+	position();
+	line("aot::exit(" + (is_int(operand.type) ? operand.code : dynamic(operand)) + ");");
+}
+
+void Transpiler::visit(std::shared_ptr<ASTBlockNode> astnode) {
+	open_block("");
+	transpile_block(astnode);
+	close_block();
+}
+
+void Transpiler::visit(std::shared_ptr<ASTContinueNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	continue_labels.back().second = true;
+	line("goto " + continue_labels.back().first + ";");
+}
+
+void Transpiler::visit(std::shared_ptr<ASTBreakNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+	line("break;");
+}
+
+void Transpiler::visit(std::shared_ptr<ASTSwitchNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTEnumNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTTryCatchNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTThrowNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTEllipsisNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTElseIfNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTIfNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	open_block("if (" + transpile_condition(astnode->condition) + ")");
+	transpile_block(astnode->if_block);
+
+	// else if conditions are only evaluated once the previous ones failed
+	size_t nested = 0;
+	for (const auto& else_if : astnode->else_ifs) {
+		set_curr_pos(else_if->row, else_if->col);
+		close_block();
+		open_block("else");
+		++nested;
+		open_block("if (" + transpile_condition(else_if->condition) + ")");
+		transpile_block(else_if->block);
+	}
+
+	if (astnode->else_block) {
+		close_block();
+		open_block("else");
+		transpile_block(astnode->else_block);
+	}
+	close_block();
+
+	for (size_t i = 0; i < nested; ++i) {
+		close_block();
+	}
+}
+
+void Transpiler::visit(std::shared_ptr<ASTForNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	open_block("");
+	scopes.emplace_back();
+
+	if (astnode->dci[0]) {
+		transpile_statement(astnode->dci[0]);
+	}
+
+	open_block("while (true)");
+	if (auto condition = std::dynamic_pointer_cast<ASTExprNode>(astnode->dci[1])) {
+		line("if (!(" + transpile_condition(condition) + ")) break;");
+	}
+	transpile_loop_body(astnode->block);
+	if (astnode->dci[2]) {
+		transpile_statement(astnode->dci[2]);
+	}
+	close_block();
+
+	scopes.pop_back();
+	close_block();
+}
+
+void Transpiler::visit(std::shared_ptr<ASTForEachNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTWhileNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	open_block("while (true)");
+	line("if (!(" + transpile_condition(astnode->condition) + ")) break;");
+	transpile_loop_body(astnode->block);
+	close_block();
+}
+
+void Transpiler::visit(std::shared_ptr<ASTDoWhileNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	open_block("while (true)");
+	transpile_loop_body(astnode->block);
+	line("if (!(" + transpile_condition(astnode->condition) + ")) break;");
+	close_block();
+}
+
+void Transpiler::visit(std::shared_ptr<ASTFunctionDefinitionNode>) {
+	// top level functions are translated after the main program
+}
+
+void Transpiler::visit(std::shared_ptr<ASTStructDefinitionNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTLiteralNode<flx_bool>> astnode) {
+	current_operand = TranspilerOperand{ astnode->val ? "true" : "false", Type::T_BOOL, false };
+}
+
+void Transpiler::visit(std::shared_ptr<ASTLiteralNode<flx_int>> astnode) {
+	current_operand = TranspilerOperand{ "flx_int(" + std::to_string(astnode->val) + ")", Type::T_INT, false };
+}
+
+void Transpiler::visit(std::shared_ptr<ASTLiteralNode<flx_float>> astnode) {
+	current_operand = TranspilerOperand{ float_literal(astnode->val), Type::T_FLOAT, false };
+}
+
+void Transpiler::visit(std::shared_ptr<ASTLiteralNode<flx_char>>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTLiteralNode<flx_string>>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTLambdaFunction>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTArrayConstructorNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTStructConstructorNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTBinaryExprNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	if (astnode->op == "and") {
+		// the right side only runs when the left one is not false
+		auto left = transpile_expression(astnode->left);
+		auto name = "t" + std::to_string(next_temporary++);
+		const bool is_native_and = is_bool(left.type);
+
+		if (is_native_and) {
+			line("flx_bool " + name + " = " + left.code + ";");
+			open_block("if (" + name + ")");
+		}
+		else {
+			line("aot::DynamicValue " + name + " = " + dynamic(left) + ";");
+			open_block("if (!aot::is_false(" + name + "))");
+		}
+
+		auto right = transpile_expression(astnode->right);
+		if (is_native_and && is_bool(right.type)) {
+			line(name + " = " + right.code + ";");
+		}
+		else {
+			position();
+			const auto lval = is_native_and ? "aot::DynamicValue(true)" : name;
+			line(name + " = aot::operation(\"and\", " + lval + ", " + dynamic(right) + ")" + (is_native_and ? ".b;" : ";"));
+		}
+		close_block();
+
+		current_operand = TranspilerOperand{ name, is_native_and ? Type::T_BOOL : Type::T_ANY, false };
+		return;
+	}
+
+	auto left = transpile_expression(astnode->left);
+	auto right = transpile_expression(astnode->right);
+	current_operand = binary_operation(astnode->op, left, right);
+}
+
+void Transpiler::visit(std::shared_ptr<ASTUnaryExprNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	const auto& op = astnode->unary_op;
+
+	if (op == "++" || op == "--") {
+		auto one = std::make_shared<ASTLiteralNode<flx_int>>(1, astnode->row, astnode->col);
+		auto id = std::dynamic_pointer_cast<ASTIdentifierNode>(astnode->expr);
+		if (id && id->name_space.empty() && id->identifier_vector.size() == 1 && id->identifier_vector[0].access_vector.empty()) {
+			transpile_assignment(id->identifier, std::string{ op[0] } + "=", one);
+		}
+		else {
+			auto operand = transpile_expression(astnode->expr);
+			current_operand = binary_operation(std::string{ op[0] }, operand, TranspilerOperand{ "flx_int(1)", Type::T_INT, false });
+		}
+		return;
+	}
+
+	auto operand = transpile_expression(astnode->expr);
+
+	if ((op == "-" && (is_int(operand.type) || is_float(operand.type)))
+		|| (op == "~" && is_int(operand.type))) {
+		current_operand = temporary(operand.type, op + operand.code, operand.untyped);
+	}
+	else if (op == "not" && is_bool(operand.type)) {
+		current_operand = temporary(Type::T_BOOL, "!" + operand.code, operand.untyped);
+	}
+	else {
+		position();
+		current_operand = temporary(Type::T_ANY, "aot::unary(" + string_literal(op) + ", " + dynamic(operand) + ")", operand.untyped);
+	}
+}
+
+void Transpiler::visit(std::shared_ptr<ASTIdentifierNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto variable = find_variable(astnode->identifier);
+	current_operand = TranspilerOperand{ variable->name, variable->type, variable->untyped };
+}
+
+void Transpiler::visit(std::shared_ptr<ASTTernaryNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	auto condition = transpile_condition(astnode->condition);
+
+	// each branch is translated on its own to learn the type of the result first
+	auto* code = out;
+	std::string true_code;
+	std::string false_code;
+	++indent;
+	out = &true_code;
+	auto true_value = transpile_expression(astnode->value_if_true);
+	out = &false_code;
+	auto false_value = transpile_expression(astnode->value_if_false);
+	--indent;
+	out = code;
+
+	const auto type = true_value.type == false_value.type && is_native(true_value.type) ? true_value.type : Type::T_ANY;
+	auto name = "t" + std::to_string(next_temporary++);
+	line(native_type(type) + " " + name + ";");
+
+	open_block("if (" + condition + ")");
+	out->append(true_code);
+	line(name + " = " + convert(true_value, type) + ";");
+	close_block();
+	open_block("else");
+	out->append(false_code);
+	line(name + " = " + convert(false_value, type) + ";");
+	close_block();
+
+	current_operand = TranspilerOperand{ name, type, false };
+}
+
+void Transpiler::visit(std::shared_ptr<ASTInNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTFunctionCallNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	const bool discard = discard_result;
+	discard_result = false;
+
+	const auto& identifier = astnode->identifier;
+	auto it = function_signatures.find(identifier);
+	const bool is_print = it == function_signatures.end();
+
+	// every argument is evaluated before the call, from left to right
+	std::vector<std::string> arguments;
+	for (const auto& param : astnode->parameters) {
+		auto literal = std::dynamic_pointer_cast<ASTLiteralNode<flx_string>>(param);
+		if (is_print && literal) {
+			arguments.push_back(string_literal(literal->val));
+		}
+		else {
+			auto operand = transpile_expression(param);
+			arguments.push_back(is_print ? dynamic(operand) : convert(operand, it->second.parameters[arguments.size()]));
+		}
+	}
+
+	if (is_print) {
+		for (const auto& argument : arguments) {
+			line("aot::print(" + argument + ");");
+		}
+		if (identifier == "println") {
+			line("aot::print_line();");
+		}
+		current_operand = TranspilerOperand{ "aot::DynamicValue()", Type::T_ANY, false };
+		return;
+	}
+
+	std::string call = it->second.name + "(";
+	for (size_t i = 0; i < arguments.size(); ++i) {
+		call += (i > 0 ? ", " : "") + arguments[i];
+	}
+	call += ")";
+
+	if (discard) {
+		line(call + ";");
+		current_operand = TranspilerOperand{ "aot::DynamicValue()", Type::T_ANY, false };
+	}
+	else {
+		current_operand = temporary(it->second.type, call);
+	}
+}
+
+void Transpiler::visit(std::shared_ptr<ASTTypeCastNode> astnode) {
+	set_curr_pos(astnode->row, astnode->col);
+
+	const auto type = astnode->type;
+	auto operand = transpile_expression(astnode->expr);
+
+	if (!is_native(operand.type)) {
+		// undefined values stay undefined, so the result is only known at run time
+		current_operand = temporary(Type::T_ANY, "aot::cast(" + operand.code + ", " + type_constant(type) + ")");
+	}
+	else if (operand.type == type) {
+		current_operand = TranspilerOperand{ operand.code, type, false };
+	}
+	else if (is_bool(type)) {
+		current_operand = temporary(type, operand.code + " != 0");
+	}
+	else {
+		current_operand = temporary(type, native_type(type) + "(" + operand.code + ")");
+	}
+}
+
+void Transpiler::visit(std::shared_ptr<ASTNullNode>) {
+	current_operand = TranspilerOperand{ "aot::DynamicValue::null()", Type::T_VOID, false };
+}
+
+void Transpiler::visit(std::shared_ptr<ASTThisNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTTypingNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTValueNode>) {}
+
+void Transpiler::visit(std::shared_ptr<ASTBuiltinCallNode>) {}
+
+long long Transpiler::hash(std::shared_ptr<ASTExprNode>) { return 0; }
+long long Transpiler::hash(std::shared_ptr<ASTValueNode>) { return 0; }
+long long Transpiler::hash(std::shared_ptr<ASTLiteralNode<flx_bool>>) { return 0; }
+long long Transpiler::hash(std::shared_ptr<ASTLiteralNode<flx_int>>) { return 0; }
+long long Transpiler::hash(std::shared_ptr<ASTLiteralNode<flx_float>>) { return 0; }
+long long Transpiler::hash(std::shared_ptr<ASTLiteralNode<flx_char>>) { return 0; }
+long long Transpiler::hash(std::shared_ptr<ASTLiteralNode<flx_string>>) { return 0; }
+long long Transpiler::hash(std::shared_ptr<ASTIdentifierNode>) { return 0; }
+
+void Transpiler::set_curr_pos(unsigned int row, unsigned int col) {
+	curr_row = row;
+	curr_col = col;
+}
+
+std::string Transpiler::msg_header() {
+	return "(TRSP) " + current_program.top()->name + '[' + std::to_string(curr_row) + ':' + std::to_string(curr_col) + "]: ";
+}
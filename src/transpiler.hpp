@@ -0,0 +1,162 @@
+#ifndef TRANSPILER_HPP
+#define TRANSPILER_HPP
+
+#include <memory>
+#include <map>
+#include <vector>
+#include <unordered_map>
+
+#include "ast.hpp"
+
+using namespace visitor;
+using namespace parser;
+
+namespace visitor {
+
+	class TranspilerVariable {
+	public:
+		std::string name;
+		Type type;
+		bool untyped;
+	};
+
+	class TranspilerFunction {
+	public:
+		std::string name;
+		Type type;
+		std::vector<Type> parameters;
+	};
+
+	// c++ expression of an already evaluated value, a variable, a literal or a temporary
+	class TranspilerOperand {
+	public:
+		std::string code;
+		Type type;
+		bool untyped;
+	};
+
+	// translates programs inside the scalar subset to c++ linked against the runtime, typed variables become
+	// native c++ variables and untyped ones hold aot::DynamicValue
+	class Transpiler : public Visitor {
+	public:
+		std::string source;
+
+	private:
+		std::string globals;
+		std::string functions;
+		// code of the function being translated and its indentation
+		std::string* out = nullptr;
+		size_t indent = 0;
+
+		std::vector<std::unordered_map<std::string, TranspilerVariable>> scopes;
+		std::unordered_map<std::string, TranspilerVariable> global_variables;
+		std::unordered_map<std::string, TranspilerFunction> function_signatures;
+		std::vector<std::shared_ptr<ASTFunctionDefinitionNode>> function_nodes;
+		const TranspilerFunction* current_function = nullptr;
+
+		size_t next_variable = 0;
+		size_t next_temporary = 0;
+		size_t next_loop = 0;
+		// loop labels of continue statements and whether one of them was used
+		std::vector<std::pair<std::string, bool>> continue_labels;
+
+		TranspilerOperand current_operand;
+		// set while translating a call whose result is not used
+		bool discard_result = false;
+
+	private:
+		void declare_functions();
+		void transpile_function(const std::shared_ptr<ASTFunctionDefinitionNode>& fun);
+		void transpile_statement(std::shared_ptr<ASTNode> statement);
+		void transpile_block(std::shared_ptr<ASTBlockNode> block);
+		void transpile_loop_body(std::shared_ptr<ASTBlockNode> block);
+		void transpile_assignment(const std::string& identifier, const std::string& op, std::shared_ptr<ASTExprNode> expr);
+
+		void line(const std::string& code);
+		void open_block(const std::string& code);
+		void close_block();
+		void position();
+
+		TranspilerOperand transpile_expression(std::shared_ptr<ASTExprNode> expr);
+		std::string transpile_condition(std::shared_ptr<ASTExprNode> condition);
+		TranspilerOperand temporary(Type type, const std::string& code, bool untyped = false);
+		TranspilerOperand binary_operation(const std::string& op, const TranspilerOperand& lval, const TranspilerOperand& rval);
+		std::string native_operation(const std::string& op, const TranspilerOperand& lval, const TranspilerOperand& rval, Type& type);
+		std::string convert(const TranspilerOperand& operand, Type type);
+		static std::string dynamic(const TranspilerOperand& operand);
+
+		std::string declare_variable(const std::string& identifier, Type type, bool untyped);
+		const TranspilerVariable* find_variable(const std::string& identifier) const;
+
+		static bool is_native(Type type);
+		static std::string native_type(Type type);
+		static std::string type_constant(Type type);
+		static std::string string_literal(const std::string& value);
+		static std::string float_literal(flx_float value);
+
+		void set_curr_pos(unsigned int row, unsigned int col) override;
+		std::string msg_header() override;
+
+	public:
+		Transpiler(std::shared_ptr<ASTProgramNode> main_program, std::map<std::string, std::shared_ptr<ASTProgramNode>> programs);
+		~Transpiler() = default;
+
+		void start();
+
+		void visit(std::shared_ptr<ASTProgramNode>) override;
+		void visit(std::shared_ptr<ASTUsingNode>) override;
+		void visit(std::shared_ptr<ASTNamespaceManagerNode>) override;
+		void visit(std::shared_ptr<ASTDeclarationNode>) override;
+		void visit(std::shared_ptr<ASTUnpackedDeclarationNode>) override;
+		void visit(std::shared_ptr<ASTAssignmentNode>) override;
+		void visit(std::shared_ptr<ASTReturnNode>) override;
+		void visit(std::shared_ptr<ASTExitNode>) override;
+		void visit(std::shared_ptr<ASTBlockNode>) override;
+		void visit(std::shared_ptr<ASTContinueNode>) override;
+		void visit(std::shared_ptr<ASTBreakNode>) override;
+		void visit(std::shared_ptr<ASTSwitchNode>) override;
+		void visit(std::shared_ptr<ASTEnumNode>) override;
+		void visit(std::shared_ptr<ASTTryCatchNode>) override;
+		void visit(std::shared_ptr<ASTThrowNode>) override;
+		void visit(std::shared_ptr<ASTEllipsisNode>) override;
+		void visit(std::shared_ptr<ASTElseIfNode>) override;
+		void visit(std::shared_ptr<ASTIfNode>) override;
+		void visit(std::shared_ptr<ASTForNode>) override;
+		void visit(std::shared_ptr<ASTForEachNode>) override;
+		void visit(std::shared_ptr<ASTWhileNode>) override;
+		void visit(std::shared_ptr<ASTDoWhileNode>) override;
+		void visit(std::shared_ptr<ASTFunctionDefinitionNode>) override;
+		void visit(std::shared_ptr<ASTStructDefinitionNode>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_bool>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_int>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_float>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_char>>) override;
+		void visit(std::shared_ptr<ASTLiteralNode<flx_string>>) override;
+		void visit(std::shared_ptr<ASTLambdaFunction>) override;
+		void visit(std::shared_ptr<ASTArrayConstructorNode>) override;
+		void visit(std::shared_ptr<ASTStructConstructorNode>) override;
+		void visit(std::shared_ptr<ASTBinaryExprNode>) override;
+		void visit(std::shared_ptr<ASTUnaryExprNode>) override;
+		void visit(std::shared_ptr<ASTIdentifierNode>) override;
+		void visit(std::shared_ptr<ASTTernaryNode>) override;
+		void visit(std::shared_ptr<ASTInNode>) override;
+		void visit(std::shared_ptr<ASTFunctionCallNode>) override;
+		void visit(std::shared_ptr<ASTTypeCastNode>) override;
+		void visit(std::shared_ptr<ASTNullNode>) override;
+		void visit(std::shared_ptr<ASTThisNode>) override;
+		void visit(std::shared_ptr<ASTTypingNode>) override;
+		void visit(std::shared_ptr<ASTValueNode>) override;
+		void visit(std::shared_ptr<ASTBuiltinCallNode>) override;
+
+		long long hash(std::shared_ptr<ASTExprNode>) override;
+		long long hash(std::shared_ptr<ASTValueNode>) override;
+		long long hash(std::shared_ptr<ASTIdentifierNode>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_bool>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_int>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_float>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_char>>) override;
+		long long hash(std::shared_ptr<ASTLiteralNode<flx_string>>) override;
+	};
+}
+
+#endif // !TRANSPILER_HPP
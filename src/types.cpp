@@ -10,9 +10,12 @@
 #include "md_console.hpp"
 
 #include "visitor.hpp"
+#include "gc.hpp"
 #include "token.hpp"
 
 #include <sstream> 
+#include <cstring>
+#include <algorithm>
 
 using namespace visitor;
 using namespace lexer;
@@ -324,6 +327,68 @@ void FunctionDefinition::check_signature() const {
 	}
 }
 
+size_t CallSiteCache::declaration_epoch = 1;
+
+const CallSiteCache::Entry* CallSiteCache::find(const std::vector<TypeDefinition*>& signature) {
+	if (epoch != declaration_epoch) {
+		entries.clear();
+		epoch = declaration_epoch;
+		return nullptr;
+	}
+
+	for (const auto& entry : entries) {
+		if (entry.arguments.size() != signature.size()) {
+			continue;
+		}
+
+		bool found = true;
+		for (size_t i = 0; i < signature.size(); ++i) {
+			const auto& arg = entry.arguments[i];
+			const auto sig = signature[i];
+			if (arg.type != sig->type || arg.use_ref != sig->use_ref || arg.type_name != sig->type_name) {
+				found = false;
+				break;
+			}
+		}
+
+		if (found) {
+			return &entry;
+		}
+	}
+
+	return nullptr;
+}
+
+void CallSiteCache::insert(const std::vector<TypeDefinition*>& signature, std::shared_ptr<Scope> scope, FunctionDefinition& function) {
+	if (epoch != declaration_epoch) {
+		entries.clear();
+		epoch = declaration_epoch;
+	}
+
+	// megamorphic sites keep resolving every call
+	if (entries.size() >= max_entries) {
+		return;
+	}
+
+	Entry entry;
+	entry.scope = scope;
+	entry.function = &function;
+
+	for (const auto sig : signature) {
+		// array matching depends on dimensions evaluated on each call
+		if (is_array(sig->type)) {
+			return;
+		}
+		entry.arguments.push_back(Argument{ sig->type, sig->type_name, sig->use_ref });
+	}
+
+	entries.push_back(std::move(entry));
+}
+
+void CallSiteCache::invalidate() {
+	++declaration_epoch;
+}
+
 StructureDefinition::StructureDefinition(const std::string& identifier, const std::map<std::string, VariableDefinition>& variables,
 	unsigned int row, unsigned int col)
 	: CodePosition(row, col), identifier(identifier), variables(variables) {
@@ -455,6 +520,183 @@ void SemanticVariable::reset_ref() {
 	use_ref = value && (use_ref || is_struct(value->type));
 }
 
+const StructShape* StructShape::empty() {
+	static const StructShape shape;
+	return &shape;
+}
+
+size_t StructShape::find(const std::string& field) const {
+	auto it = indexes.find(field);
+	return it == indexes.end() ? npos : it->second;
+}
+
+const StructShape* StructShape::with_field(const std::string& field) const {
+	auto& next = transitions[field];
+	if (!next) {
+		next = std::make_unique<StructShape>();
+		next->fields = fields;
+		next->fields.push_back(field);
+		next->indexes = indexes;
+		next->indexes[field] = fields.size();
+	}
+	return next.get();
+}
+
+StructSlots::StructSlots(std::initializer_list<std::pair<std::string, RuntimeValue*>> fields) {
+	for (const auto& field : fields) {
+		(*this)[field.first] = field.second;
+	}
+}
+
+size_t StructSlots::find(const std::string& field, FieldCache& cache) const {
+	if (cache.shape != shape) {
+		cache.slot = shape->find(field);
+		cache.shape = shape;
+	}
+	return cache.slot;
+}
+
+RuntimeValue* StructSlots::at(const std::string& field) const {
+	auto slot = shape->find(field);
+	if (slot == StructShape::npos) {
+		throw std::runtime_error("struct has no field '" + field + "'");
+	}
+	return slots[slot];
+}
+
+RuntimeValue* StructSlots::at(const std::string& field, FieldCache& cache) const {
+	auto slot = find(field, cache);
+	if (slot == StructShape::npos) {
+		throw std::runtime_error("struct has no field '" + field + "'");
+	}
+	return slots[slot];
+}
+
+RuntimeValue*& StructSlots::operator[](const std::string& field) {
+	auto slot = shape->find(field);
+	if (slot == StructShape::npos) {
+		shape = shape->with_field(field);
+		slots.push_back(nullptr);
+		return slots.back();
+	}
+	return slots[slot];
+}
+
+PackedArray::PackedArray(Type element_type)
+	: element_type(element_type) {
+}
+
+bool PackedArray::can_pack(Type type) {
+	return type == Type::T_BOOL || type == Type::T_INT || type == Type::T_FLOAT || type == Type::T_CHAR;
+}
+
+size_t PackedArray::element_size(Type type) {
+	switch (type) {
+	case Type::T_BOOL:
+		return sizeof(flx_bool);
+	case Type::T_INT:
+		return sizeof(flx_int);
+	case Type::T_FLOAT:
+		return sizeof(flx_float);
+	case Type::T_CHAR:
+		return sizeof(flx_char);
+	default:
+		return 1;
+	}
+}
+
+size_t PackedArray::size() const {
+	return data.size() / element_size(element_type);
+}
+
+void PackedArray::read(size_t index, RuntimeValue* value) const {
+	const uint8_t* element = data.data() + index * element_size(element_type);
+	switch (element_type) {
+	case Type::T_BOOL: {
+		flx_bool b;
+		std::memcpy(&b, element, sizeof(b));
+		value->set(b);
+		break;
+	}
+	case Type::T_INT: {
+		flx_int i;
+		std::memcpy(&i, element, sizeof(i));
+		value->set(i);
+		break;
+	}
+	case Type::T_FLOAT: {
+		flx_float f;
+		std::memcpy(&f, element, sizeof(f));
+		value->set(f);
+		break;
+	}
+	case Type::T_CHAR: {
+		flx_char c;
+		std::memcpy(&c, element, sizeof(c));
+		value->set(c);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+bool PackedArray::write(size_t index, const RuntimeValue* value) {
+	if (value->type != element_type || !value->is_packable()) {
+		return false;
+	}
+	uint8_t* element = data.data() + index * element_size(element_type);
+	switch (element_type) {
+	case Type::T_BOOL: {
+		flx_bool b = value->get_b();
+		std::memcpy(element, &b, sizeof(b));
+		break;
+	}
+	case Type::T_INT: {
+		flx_int i = value->get_i();
+		std::memcpy(element, &i, sizeof(i));
+		break;
+	}
+	case Type::T_FLOAT: {
+		flx_float f = value->get_f();
+		std::memcpy(element, &f, sizeof(f));
+		break;
+	}
+	case Type::T_CHAR: {
+		flx_char c = value->get_c();
+		std::memcpy(element, &c, sizeof(c));
+		break;
+	}
+	default:
+		return false;
+	}
+	return true;
+}
+
+bool PackedArray::push_back(const RuntimeValue* value) {
+	if (value->type != element_type || !value->is_packable()) {
+		return false;
+	}
+	data.resize(data.size() + element_size(element_type));
+	return write(size() - 1, value);
+}
+
+long double PackedArray::number(size_t index) const {
+	RuntimeValue value;
+	read(index, &value);
+	switch (element_type) {
+	case Type::T_BOOL:
+		return (long double)value.get_b();
+	case Type::T_INT:
+		return (long double)value.get_i();
+	case Type::T_FLOAT:
+		return (long double)value.get_f();
+	case Type::T_CHAR:
+		return (long double)value.get_c();
+	default:
+		return 0;
+	}
+}
 
 RuntimeValue::RuntimeValue(Type type, Type array_type, std::vector<std::shared_ptr<ASTExprNode>> dim,
 	const std::string& type_name, const std::string& type_name_space,
@@ -501,6 +743,11 @@ RuntimeValue::RuntimeValue(flx_array rawv, Type array_type, std::vector<std::sha
 	set(rawv, array_type, dim, type_name, type_name_space);
 }
 
+RuntimeValue::RuntimeValue(PackedArray rawv, Type array_type, std::vector<std::shared_ptr<ASTExprNode>> dim, std::string type_name, std::string type_name_space)
+	: Value(Type::T_ARRAY, array_type, dim, type_name, type_name_space) {
+	set(std::move(rawv), array_type, dim, type_name, type_name_space);
+}
+
 RuntimeValue::RuntimeValue(flx_struct rawv, std::string type_name, std::string type_name_space)
 	: Value(Type::T_STRUCT, Type::T_UNDEFINED, std::vector<std::shared_ptr<ASTExprNode>>(), type_name, type_name_space) {
 	set(rawv, type_name, type_name_space);
@@ -532,10 +779,11 @@ RuntimeValue::RuntimeValue(TypeDefinition v)
 }
 
 RuntimeValue::~RuntimeValue() {
-	if (str) {
-		for (auto& var : *str) {
+	// the native instance belongs to the struct, not to each value sharing it
+	if (payload_type == Type::T_STRUCT && str->owners == 1) {
+		for (const auto& var : str->data) {
 			if (var.first == modules::Module::INSTANCE_ID_NAME) {
-				delete reinterpret_cast<void*>(*var.second->i);
+				delete reinterpret_cast<void*>(var.second->get_i());
 			}
 		}
 	}
@@ -544,166 +792,257 @@ RuntimeValue::~RuntimeValue() {
 
 void RuntimeValue::set(flx_bool b) {
 	unset();
-	this->b = new flx_bool(b);
+	this->b = b;
+	payload_type = Type::T_BOOL;
 	type = Type::T_BOOL;
 	array_type = Type::T_UNDEFINED;
 }
 
 void RuntimeValue::set(flx_int i) {
 	unset();
-	this->i = new flx_int(i);
+	this->i = i;
+	payload_type = Type::T_INT;
 	type = Type::T_INT;
 	array_type = Type::T_UNDEFINED;
 }
 
 void RuntimeValue::set(flx_float f) {
 	unset();
-	this->f = new flx_float(f);
+	this->f = f;
+	payload_type = Type::T_FLOAT;
 	type = Type::T_FLOAT;
 	array_type = Type::T_UNDEFINED;
 }
 
 void RuntimeValue::set(flx_char c) {
 	unset();
-	this->c = new flx_char(c);
+	this->c = c;
+	payload_type = Type::T_CHAR;
 	type = Type::T_CHAR;
 	array_type = Type::T_UNDEFINED;
 }
 
 void RuntimeValue::set(flx_string s) {
-	unset();
-	this->s = new flx_string(s);
+	if (payload_type == Type::T_STRING) {
+		*this->s = std::move(s);
+	}
+	else {
+		unset();
+		this->s = new flx_string(std::move(s));
+		payload_type = Type::T_STRING;
+	}
 	type = Type::T_STRING;
 	array_type = Type::T_UNDEFINED;
 }
 
 void RuntimeValue::set(flx_array arr) {
-	unset();
-	this->arr = new flx_array(arr);
+	if (payload_type == Type::T_ARRAY && !packed_payload && this->arr->owners == 1) {
+		this->arr->data = std::move(arr);
+	}
+	else {
+		unset();
+		this->arr = new SharedPayload<flx_array>(std::move(arr));
+		payload_type = Type::T_ARRAY;
+	}
 	type = Type::T_ARRAY;
+	write_barrier();
 }
 
 void RuntimeValue::set(flx_array arr, Type array_type, std::vector<std::shared_ptr<ASTExprNode>> dim, std::string type_name, std::string type_name_space) {
-	unset();
-	this->arr = new flx_array(arr);
+	set(std::move(arr));
+	this->array_type = array_type;
+	this->type_name = type_name;
+	this->type_name_space = type_name_space;
+}
+
+void RuntimeValue::set(PackedArray arr) {
+	if (payload_type == Type::T_ARRAY && packed_payload && packed->owners.size() == 1) {
+		packed->data = std::move(arr);
+	}
+	else {
+		unset();
+		packed = new SharedPackedArray(std::move(arr), this);
+		payload_type = Type::T_ARRAY;
+		packed_payload = true;
+	}
 	type = Type::T_ARRAY;
+}
+
+void RuntimeValue::set(PackedArray arr, Type array_type, std::vector<std::shared_ptr<ASTExprNode>> dim, std::string type_name, std::string type_name_space) {
+	set(std::move(arr));
 	this->array_type = array_type;
 	this->type_name = type_name;
 	this->type_name_space = type_name_space;
 }
 
 void RuntimeValue::set(flx_struct str, std::string type_name, std::string type_name_space) {
-	unset();
-	this->str = new flx_struct(str);
+	if (payload_type == Type::T_STRUCT && this->str->owners == 1) {
+		this->str->data = std::move(str);
+	}
+	else {
+		unset();
+		this->str = new SharedPayload<flx_struct>(std::move(str));
+		payload_type = Type::T_STRUCT;
+	}
 	type = Type::T_STRUCT;
+	write_barrier();
 	array_type = Type::T_UNDEFINED;
 	this->type_name = type_name;
 	this->type_name_space = type_name_space;
 }
 
 void RuntimeValue::set(flx_function fun) {
-	unset();
-	this->fun = new flx_function(fun);
+	if (payload_type == Type::T_FUNCTION) {
+		*this->fun = std::move(fun);
+	}
+	else {
+		unset();
+		this->fun = new flx_function(std::move(fun));
+		payload_type = Type::T_FUNCTION;
+	}
 	type = Type::T_FUNCTION;
 	array_type = Type::T_UNDEFINED;
 }
 
-void RuntimeValue::set_sub(std::string identifier, RuntimeValue* sub_value) {
-	if (!str) return;
+void RuntimeValue::set_sub(const std::string& identifier, RuntimeValue* sub_value) {
+	if (payload_type != Type::T_STRUCT) return;
+	detach();
 	sub_value->value_ref = this;
-	(*str)[identifier] = sub_value;
+	str->data[identifier] = sub_value;
+	write_barrier();
+}
+
+void RuntimeValue::set_sub(const std::string& identifier, RuntimeValue* sub_value, FieldCache& cache) {
+	if (payload_type != Type::T_STRUCT) return;
+	auto slot = str->data.find(identifier, cache);
+	if (slot == StructShape::npos) {
+		set_sub(identifier, sub_value);
+		return;
+	}
+	detach();
+	sub_value->value_ref = this;
+	str->data.set_slot(slot, sub_value);
+	write_barrier();
 }
 
 void RuntimeValue::set_sub(size_t index, RuntimeValue* sub_value) {
-	if (!arr) return;
+	if (payload_type != Type::T_ARRAY) return;
+	unpack();
+	detach();
 	sub_value->value_ref = this;
-	(*arr)[index] = sub_value;
+	arr->data[index] = sub_value;
+	write_barrier();
 }
 
 flx_bool RuntimeValue::get_b() const {
-	if (!b) return flx_bool();
-	return *b;
+	if (payload_type != Type::T_BOOL) return flx_bool();
+	return b;
 }
 
 flx_int RuntimeValue::get_i() const {
-	if (!i) return flx_int();
-	return *i;
+	if (payload_type != Type::T_INT) return flx_int();
+	return i;
 }
 
 flx_float RuntimeValue::get_f() const {
-	if (!f) return flx_float();
-	return *f;
+	if (payload_type != Type::T_FLOAT) return flx_float();
+	return f;
 }
 
 flx_char RuntimeValue::get_c() const {
-	if (!c) return flx_char();
-	return *c;
+	if (payload_type != Type::T_CHAR) return flx_char();
+	return c;
 }
 
 flx_string RuntimeValue::get_s() const {
-	if (!s) return flx_string();
+	if (payload_type != Type::T_STRING) return flx_string();
 	return *s;
 }
 
-flx_array RuntimeValue::get_arr() const {
-	if (!arr) return flx_array();
-	return *arr;
+const flx_array& RuntimeValue::get_arr() const {
+	static const flx_array empty;
+	if (payload_type != Type::T_ARRAY) return empty;
+	if (packed_payload) {
+		const_cast<RuntimeValue*>(this)->unpack();
+	}
+	return arr->data;
 }
 
-flx_struct RuntimeValue::get_str() const {
-	if (!str) return flx_struct();
-	return *str;
+const flx_struct& RuntimeValue::get_str() const {
+	static const flx_struct empty;
+	if (payload_type != Type::T_STRUCT) return empty;
+	return str->data;
 }
 
 flx_function RuntimeValue::get_fun() const {
-	if (!fun) return flx_function();
+	if (payload_type != Type::T_FUNCTION) return flx_function();
 	return *fun;
 }
 
-RuntimeValue* RuntimeValue::get_sub(std::string identifier) {
-	if (!str) return nullptr;
-	auto sub_value = (*str)[identifier];
+RuntimeValue* RuntimeValue::get_sub(const std::string& identifier) {
+	if (payload_type != Type::T_STRUCT) return nullptr;
+	auto slot = str->data.find(identifier);
+	if (slot == StructShape::npos) return nullptr;
+	auto sub_value = str->data.get_slot(slot);
+	sub_value->value_ref = this;
+	return sub_value;
+}
+
+RuntimeValue* RuntimeValue::get_sub(const std::string& identifier, FieldCache& cache) {
+	if (payload_type != Type::T_STRUCT) return nullptr;
+	auto slot = str->data.find(identifier, cache);
+	if (slot == StructShape::npos) return nullptr;
+	auto sub_value = str->data.get_slot(slot);
 	sub_value->value_ref = this;
 	return sub_value;
 }
 
 RuntimeValue* RuntimeValue::get_sub(size_t index) {
-	if (!arr) return nullptr;
-	auto sub_value = (*arr)[index];
+	if (payload_type != Type::T_ARRAY) return nullptr;
+	unpack();
+	auto sub_value = arr->data[index];
 	sub_value->value_ref = this;
 	return sub_value;
 }
 
 flx_bool* RuntimeValue::get_raw_b() {
-	return b;
+	return payload_type == Type::T_BOOL ? &b : nullptr;
 }
 
 flx_int* RuntimeValue::get_raw_i() {
-	return i;
+	return payload_type == Type::T_INT ? &i : nullptr;
 }
 
 flx_float* RuntimeValue::get_raw_f() {
-	return f;
+	return payload_type == Type::T_FLOAT ? &f : nullptr;
 }
 
 flx_char* RuntimeValue::get_raw_c() {
-	return c;
+	return payload_type == Type::T_CHAR ? &c : nullptr;
 }
 
 flx_string* RuntimeValue::get_raw_s() {
-	return s;
+	return payload_type == Type::T_STRING ? s : nullptr;
 }
 
 flx_array* RuntimeValue::get_raw_arr() {
-	return arr;
+	if (payload_type != Type::T_ARRAY) return nullptr;
+	unpack();
+	// the caller may store new elements through the raw pointer
+	detach();
+	write_barrier();
+	return &arr->data;
 }
 
 flx_struct* RuntimeValue::get_raw_str() {
-	return str;
+	if (payload_type != Type::T_STRUCT) return nullptr;
+	detach();
+	write_barrier();
+	return &str->data;
 }
 
 flx_function* RuntimeValue::get_raw_fun() {
-	return fun;
+	return payload_type == Type::T_FUNCTION ? fun : nullptr;
 }
 
 void RuntimeValue::set_type(Type type) {
@@ -715,40 +1054,160 @@ void RuntimeValue::set_arr_type(Type arr_type) {
 }
 
 void RuntimeValue::unset() {
-	if (this->b) {
-		delete this->b;
-		this->b = nullptr;
+	switch (payload_type) {
+	case Type::T_STRING:
+		delete s;
+		break;
+	case Type::T_ARRAY:
+		if (packed_payload) {
+			auto& owners = packed->owners;
+			owners.erase(std::find(owners.rbegin(), owners.rend(), this).base() - 1);
+			if (owners.empty()) {
+				delete packed;
+			}
+		}
+		else if (--arr->owners == 0) {
+			delete arr;
+		}
+		break;
+	case Type::T_STRUCT:
+		if (--str->owners == 0) {
+			delete str;
+		}
+		break;
+	case Type::T_FUNCTION:
+		delete fun;
+		break;
+	default:
+		break;
+	}
+	i = 0;
+	payload_type = Type::T_UNDEFINED;
+	packed_payload = false;
+}
+
+void RuntimeValue::detach() {
+	if (payload_type == Type::T_ARRAY && packed_payload) {
+		if (packed->owners.size() > 1) {
+			auto& owners = packed->owners;
+			owners.erase(std::find(owners.rbegin(), owners.rend(), this).base() - 1);
+			packed = new SharedPackedArray(packed->data, this);
+		}
 	}
-	if (this->i) {
-		delete this->i;
-		this->i = nullptr;
+	else if (payload_type == Type::T_ARRAY && arr->owners > 1) {
+		--arr->owners;
+		arr = new SharedPayload<flx_array>(arr->data);
 	}
-	if (this->f) {
-		delete this->f;
-		this->f = nullptr;
+	else if (payload_type == Type::T_STRUCT && str->owners > 1) {
+		--str->owners;
+		str = new SharedPayload<flx_struct>(str->data);
 	}
-	if (this->c) {
-		delete this->c;
-		this->c = nullptr;
+}
+
+
+void RuntimeValue::share_payload(RuntimeValue* value) {
+	if (payload_type == value->payload_type && packed_payload == value->packed_payload
+		&& (payload_type == Type::T_ARRAY ? arr == value->arr : str == value->str)) {
+		return;
 	}
-	if (this->s) {
-		delete this->s;
-		this->s = nullptr;
+	unset();
+	payload_type = value->payload_type;
+	packed_payload = value->packed_payload;
+	if (packed_payload) {
+		packed = value->packed;
+		packed->owners.push_back(this);
 	}
-	if (this->arr) {
-		delete this->arr;
-		this->arr = nullptr;
+	else if (payload_type == Type::T_ARRAY) {
+		arr = value->arr;
+		++arr->owners;
 	}
-	if (this->str) {
-		delete this->str;
-		this->str = nullptr;
+	else {
+		str = value->str;
+		++str->owners;
 	}
-	if (this->fun) {
-		delete this->fun;
-		this->fun = nullptr;
+}
+
+bool RuntimeValue::is_packable() const {
+	return !use_ref && payload_type == type && PackedArray::can_pack(type);
+}
+
+bool RuntimeValue::is_packed() const {
+	return payload_type == Type::T_ARRAY && packed_payload;
+}
+
+bool RuntimeValue::shares_elements() const {
+	if (payload_type != Type::T_ARRAY) return false;
+	return packed_payload ? packed->owners.size() > 1 : arr->owners > 1;
+}
+
+const PackedArray* RuntimeValue::get_packed() const {
+	return is_packed() ? &packed->data : nullptr;
+}
+
+size_t RuntimeValue::get_arr_size() const {
+	if (payload_type != Type::T_ARRAY) return 0;
+	return packed_payload ? packed->data.size() : arr->data.size();
+}
+
+const RuntimeValue* RuntimeValue::get_element(size_t index, RuntimeValue& scratch) const {
+	if (payload_type != Type::T_ARRAY) return nullptr;
+	if (packed_payload) {
+		packed->data.read(index, &scratch);
+		return &scratch;
 	}
+	return arr->data[index];
 }
 
+bool RuntimeValue::set_packed_element(size_t index, const RuntimeValue* value) {
+	// a copy sharing the elements keeps the ones not stored into, which takes boxed elements
+	if (!is_packed() || packed->owners.size() > 1 || index >= packed->data.size()
+		|| value->type != packed->data.element_type || !value->is_packable()) {
+		return false;
+	}
+	return packed->data.write(index, value);
+}
+
+void RuntimeValue::update_packed_element(size_t index, RuntimeValue* value) {
+	if (payload_type != Type::T_ARRAY || index >= get_arr_size()) return;
+	if (packed_payload && packed->data.write(index, value)) {
+		return;
+	}
+	unpack();
+	arr->data[index]->copy_from(value);
+}
+
+void RuntimeValue::unpack() {
+	if (!is_packed()) return;
+	auto shared = packed;
+	const PackedArray& elements = shared->data;
+	auto gc = gc::GarbageCollector::get_active();
+	flx_array boxed(elements.size());
+	for (size_t i = 0; i < elements.size(); ++i) {
+		auto element = new RuntimeValue();
+		elements.read(i, element);
+		if (gc) {
+			gc->allocate(element);
+		}
+		element->value_ref = this;
+		boxed[i] = element;
+	}
+	// every value sharing the packed elements shares the boxed ones
+	auto boxed_payload = new SharedPayload<flx_array>(std::move(boxed));
+	boxed_payload->owners = shared->owners.size();
+	for (auto owner : shared->owners) {
+		owner->arr = boxed_payload;
+		owner->packed_payload = false;
+		owner->write_barrier();
+	}
+	delete shared;
+}
+
+void RuntimeValue::share_elements(RuntimeValue* value) {
+	if (value->payload_type != Type::T_ARRAY) return;
+	share_payload(value);
+	type = Type::T_ARRAY;
+	write_barrier();
+}
 
 void RuntimeValue::set_null() {
 	auto v = RuntimeValue(Type::T_VOID);
@@ -785,6 +1244,12 @@ long double RuntimeValue::value_hash() const {
 		throw std::runtime_error("value is any");
 	case Type::T_ARRAY: {
 		long double h = 0;
+		if (auto elements = get_packed()) {
+			for (size_t i = 0; i < elements->size(); ++i) {
+				h = h * 31 + elements->number(i);
+			}
+			return h;
+		}
 		for (const auto& v : get_arr()) {
 			h = h * 31 + v->value_hash();
 		}
@@ -803,60 +1268,108 @@ long double RuntimeValue::value_hash() const {
 }
 
 void RuntimeValue::copy_from(RuntimeValue* value) {
-	type = value->type;
-	type_name = value->type_name;
-	type_name_space = value->type_name_space;
-	array_type = value->array_type;
-	dim = value->dim;
-	unset();
-	switch (type)
+	if (value == this) {
+		return;
+	}
+	switch (value->type)
 	{
 	case parser::Type::T_BOOL:
-		b = new flx_bool(value->get_b());
+		unset();
+		b = value->get_b();
+		payload_type = value->type;
 		break;
 	case parser::Type::T_INT:
-		i = new flx_int(value->get_i());
+		unset();
+		i = value->get_i();
+		payload_type = value->type;
 		break;
 	case parser::Type::T_FLOAT:
-		f = new flx_float(value->get_f());
+		unset();
+		f = value->get_f();
+		payload_type = value->type;
 		break;
 	case parser::Type::T_CHAR:
-		c = new flx_char(value->get_c());
+		unset();
+		c = value->get_c();
+		payload_type = value->type;
 		break;
 	case parser::Type::T_STRING:
-		s = new flx_string(value->get_s());
+		set(value->get_s());
 		break;
 	case parser::Type::T_ARRAY:
-		arr = new flx_array(value->get_arr());
+		if (value->payload_type == Type::T_ARRAY) {
+			share_payload(value);
+			write_barrier();
+		}
+		else {
+			set(flx_array());
+		}
 		break;
 	case parser::Type::T_STRUCT:
-		str = new flx_struct(value->get_str());
+		if (value->payload_type == Type::T_STRUCT) {
+			share_payload(value);
+			write_barrier();
+		}
+		else {
+			set(flx_struct(), value->type_name, value->type_name_space);
+		}
 		break;
 	case parser::Type::T_FUNCTION:
-		fun = new flx_function(value->get_fun());
+		set(value->get_fun());
 		break;
 	default:
+		unset();
 		break;
 	}
+	type = value->type;
+	type_name = value->type_name;
+	type_name_space = value->type_name_space;
+	array_type = value->array_type;
+	dim = value->dim;
 	ref = value->ref;
 	use_ref = value->use_ref;
 }
 
-std::vector<GCObject*> RuntimeValue::get_references() {
-	std::vector<GCObject*> references;
-
-	if (is_array(type)) {
-		for (const auto& val : get_arr()) {
-			references.push_back(val);
+void RuntimeValue::for_each_reference(const std::function<void(GCObject*)>& visit) {
+	// packed elements are not objects, so a packed array has no references
+	if (payload_type == Type::T_ARRAY && !packed_payload) {
+		for (const auto& val : arr->data) {
+			visit(val);
 		}
 	}
-	if (is_struct(type)) {
-		for (const auto& sub : get_str()) {
-			references.push_back(sub.second);
+	else if (payload_type == Type::T_STRUCT) {
+		for (const auto& sub : str->data) {
+			visit(sub.second);
 		}
 	}
+}
+
+size_t RuntimeValue::get_size() const {
+	size_t size = sizeof(RuntimeValue);
+
+	switch (payload_type) {
+	case Type::T_STRING:
+		size += sizeof(flx_string) + s->capacity();
+		break;
+	case Type::T_ARRAY:
+		if (packed_payload) {
+			size += sizeof(PackedArray) + packed->data.data.capacity();
+			break;
+		}
+		size += sizeof(flx_array) + arr->data.capacity() * sizeof(RuntimeValue*);
+		break;
+	case Type::T_STRUCT:
+		// field names live in the shared layout
+		size += sizeof(flx_struct) + str->data.size() * sizeof(RuntimeValue*);
+		break;
+	case Type::T_FUNCTION:
+		size += sizeof(flx_function) + fun->first.capacity() + fun->second.capacity();
+		break;
+	default:
+		break;
+	}
 
-	return references;
+	return size;
 }
 
 RuntimeVariable::RuntimeVariable(const std::string& identifier, parser::Type type, parser::Type array_type, std::vector<std::shared_ptr<ASTExprNode>> dim,
@@ -882,6 +1395,7 @@ RuntimeVariable::~RuntimeVariable() = default;
 void RuntimeVariable::set_value(RuntimeValue* val) {
 	value = val;
 	value->ref = shared_from_this();
+	write_barrier();
 }
 
 RuntimeValue* RuntimeVariable::get_value() {
@@ -902,12 +1416,12 @@ void RuntimeVariable::reset_ref() {
 	use_ref = value && (use_ref || is_struct(value->type));
 }
 
-std::vector<GCObject*> RuntimeVariable::get_references() {
-	std::vector<GCObject*> references;
-
-	references.push_back(value);
+void RuntimeVariable::for_each_reference(const std::function<void(GCObject*)>& visit) {
+	visit(value);
+}
 
-	return references;
+size_t RuntimeVariable::get_size() const {
+	return sizeof(RuntimeVariable) + identifier.capacity();
 }
 
 flx_bool RuntimeOperations::equals_value(const RuntimeValue* lval, const RuntimeValue* rval, std::vector<uintptr_t> compared) {
@@ -950,7 +1464,7 @@ flx_bool RuntimeOperations::equals_value(const RuntimeValue* lval, const Runtime
 	//case Type::T_STRUCT:
 	//	return lval == rval;
 	case Type::T_ARRAY:
-		return RuntimeOperations::equals_array(lval->get_arr(), rval->get_arr(), compared);
+		return RuntimeOperations::equals_array(lval, rval, compared);
 	case Type::T_STRUCT:
 		return RuntimeOperations::equals_struct(lval->get_str(), rval->get_str(), compared);
 	}
@@ -963,11 +1477,16 @@ flx_bool RuntimeOperations::equals_struct(const flx_struct& lstr, const flx_stru
 		return false;
 	}
 
-	for (auto& lval : lstr) {
-		if (rstr.find(lval.first) == rstr.end()) {
+	// values built the same way share a layout and compare slot by slot
+	bool same_shape = lstr.get_shape() == rstr.get_shape();
+	size_t slot = 0;
+	for (const auto& lval : lstr) {
+		auto rslot = same_shape ? slot : rstr.find(lval.first);
+		++slot;
+		if (rslot == StructShape::npos) {
 			return false;
 		}
-		if (!equals_value(lval.second, rstr.at(lval.first), compared)) {
+		if (!equals_value(lval.second, rstr.get_slot(rslot), compared)) {
 			return false;
 		}
 	}
@@ -975,13 +1494,16 @@ flx_bool RuntimeOperations::equals_struct(const flx_struct& lstr, const flx_stru
 	return true;
 }
 
-flx_bool RuntimeOperations::equals_array(const flx_array& larr, const flx_array& rarr, std::vector<uintptr_t> compared) {
-	if (larr.size() != rarr.size()) {
+flx_bool RuntimeOperations::equals_array(const RuntimeValue* larr, const RuntimeValue* rarr, std::vector<uintptr_t> compared) {
+	if (larr->get_arr_size() != rarr->get_arr_size()) {
 		return false;
 	}
 
-	for (size_t i = 0; i < larr.size(); ++i) {
-		if (!equals_value(larr[i], rarr[i], compared)) {
+	// packed elements are compared without boxing them
+	RuntimeValue lscratch;
+	RuntimeValue rscratch;
+	for (size_t i = 0; i < larr->get_arr_size(); ++i) {
+		if (!equals_value(larr->get_element(i, lscratch), rarr->get_element(i, rscratch), compared)) {
 			return false;
 		}
 	}
@@ -1031,7 +1553,7 @@ std::string RuntimeOperations::parse_value_to_string(const RuntimeValue* value,
 		}
 		else {
 			printed.push_back(reinterpret_cast<uintptr_t>(value));
-			str = RuntimeOperations::parse_array_to_string(value->get_arr(), printed);
+			str = RuntimeOperations::parse_array_to_string(value, printed);
 		}
 		break;
 	}
@@ -1047,22 +1569,25 @@ std::string RuntimeOperations::parse_value_to_string(const RuntimeValue* value,
 	return str;
 }
 
-std::string RuntimeOperations::parse_array_to_string(const flx_array& arr_value, std::vector<uintptr_t> printed) {
+std::string RuntimeOperations::parse_array_to_string(const RuntimeValue* value, std::vector<uintptr_t> printed) {
 	std::stringstream s = std::stringstream();
+	RuntimeValue scratch;
+	size_t size = value->get_arr_size();
 	s << "[";
-	for (auto i = 0; i < arr_value.size(); ++i) {
-		bool isc = is_char(arr_value[i]->type);
-		bool iss = is_string(arr_value[i]->type);
+	for (size_t i = 0; i < size; ++i) {
+		auto element = value->get_element(i, scratch);
+		bool isc = is_char(element->type);
+		bool iss = is_string(element->type);
 
 		if (isc) s << "'";
 		else if (iss) s << '"';
 
-		s << parse_value_to_string(arr_value[i], printed);
+		s << parse_value_to_string(element, printed);
 
 		if (isc) s << "'";
 		else if (iss) s << '"';
 
-		if (i < arr_value.size() - 1) {
+		if (i < size - 1) {
 			s << ",";
 		}
 	}
@@ -1071,7 +1596,7 @@ std::string RuntimeOperations::parse_array_to_string(const flx_array& arr_value,
 }
 
 std::string RuntimeOperations::parse_struct_to_string(const RuntimeValue* value, std::vector<uintptr_t> printed) {
-	auto str_value = value->get_str();
+	const auto& str_value = value->get_str();
 	std::stringstream s = std::stringstream();
 	if (!value->type_name_space.empty() && value->type_name_space != default_namespace) {
 		s << value->type_name_space << "::";
@@ -1336,6 +1861,10 @@ RuntimeValue* RuntimeOperations::do_operation(const std::string& op, RuntimeValu
 	}
 	case Type::T_ARRAY: {
 		if (is_any(l_var_type) && op == "=") {
+			if (rval->is_packed()) {
+				lval->share_elements(rval);
+				break;
+			}
 			lval->set(rval->get_arr(), lval->array_type, lval->dim, lval->type_name, lval->type_name_space);
 			break;
 		}
@@ -1359,6 +1888,24 @@ RuntimeValue* RuntimeOperations::do_operation(const std::string& op, RuntimeValu
 			ExceptionHandler::throw_operation_err(op, *lval, *rval, evaluate_access_vector_ptr);
 		}
 
+		if (op == "=" && rval->is_packed()) {
+			lval->share_elements(rval);
+			lval->set_arr_type(match_arr_t ? lval->array_type : Type::T_ANY);
+			break;
+		}
+
+		// packed operands stay packed as long as the result has a single element type, the result of a boxed
+		// concatenation shares the elements of both operands, so shared ones are concatenated boxed
+		auto lpacked = lval->get_packed();
+		auto rpacked = rval->get_packed();
+		if (lpacked && rpacked && lpacked->element_type == rpacked->element_type && (op == "+=" || op == "+")
+			&& !lval->shares_elements() && !rval->shares_elements()) {
+			lval->set(do_operation(*lpacked, *rpacked, op),
+				match_arr_t ? lval->array_type : Type::T_ANY, lval->dim,
+				lval->type_name, lval->type_name_space);
+			break;
+		}
+
 		lval->set(do_operation(lval->get_arr(), rval->get_arr(), op),
 			match_arr_t ? lval->array_type : Type::T_ANY, lval->dim,
 			lval->type_name, lval->type_name_space);
@@ -1549,14 +2096,30 @@ flx_string RuntimeOperations::do_operation(flx_string lval, flx_string rval, con
 	throw std::runtime_error("invalid '" + op + "' operator for types 'string' and 'string'");
 }
 
-flx_array RuntimeOperations::do_operation(flx_array lval, flx_array rval, const std::string& op) {
+flx_array RuntimeOperations::do_operation(const flx_array& lval, const flx_array& rval, const std::string& op) {
 	if (op == "=") {
 		return rval;
 	}
 	else if (op == "+=" || op == "+") {
-		lval.insert(lval.end(), rval.begin(), rval.end());
+		flx_array arr;
+		arr.reserve(lval.size() + rval.size());
+		arr.insert(arr.end(), lval.begin(), lval.end());
+		arr.insert(arr.end(), rval.begin(), rval.end());
 
-		return lval;
+		return arr;
+	}
+
+	throw std::runtime_error("invalid '" + op + "' operator for types 'array' and 'array'");
+}
+
+PackedArray RuntimeOperations::do_operation(const PackedArray& lval, const PackedArray& rval, const std::string& op) {
+	if (op == "+=" || op == "+") {
+		PackedArray arr(lval.element_type);
+		arr.data.reserve(lval.data.size() + rval.data.size());
+		arr.data.insert(arr.data.end(), lval.data.begin(), lval.data.end());
+		arr.data.insert(arr.data.end(), rval.data.begin(), rval.data.end());
+
+		return arr;
 	}
 
 	throw std::runtime_error("invalid '" + op + "' operator for types 'array' and 'array'");
@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <stdexcept>
 #include <functional>
 
@@ -44,11 +45,14 @@ using namespace parser;
 
 namespace visitor {
 	typedef std::function<std::vector<unsigned int>(const std::vector<std::shared_ptr<ASTExprNode>>&)> dim_eval_func_t;
+
+	class Scope;
 };
 
 using namespace visitor;
 
 class RuntimeValue;
+class StructSlots;
 
 typedef bool flx_bool;
 typedef int64_t flx_int;
@@ -56,7 +60,7 @@ typedef long double flx_float;
 typedef char flx_char;
 typedef std::string flx_string;
 typedef std::vector<RuntimeValue*> flx_array;
-typedef std::unordered_map<std::string, RuntimeValue*> flx_struct;
+typedef StructSlots flx_struct;
 typedef std::pair<std::string, std::string> flx_function;
 
 extern std::string language_namespace;
@@ -152,6 +156,8 @@ public:
 	std::string identifier;
 	std::vector<TypeDefinition*> parameters;
 	size_t pointer = 0;
+	// operand stack slots the vm reserves for a call
+	size_t max_stack_depth = 0;
 	std::shared_ptr<ASTBlockNode> block;
 	bool is_var = false;
 
@@ -173,6 +179,38 @@ public:
 	void check_signature() const;
 };
 
+// polymorphic inline cache of a call site, maps argument types to the resolved overload
+class CallSiteCache {
+public:
+	struct Argument {
+		Type type;
+		std::string type_name;
+		bool use_ref;
+	};
+
+	struct Entry {
+		std::vector<Argument> arguments;
+		// weak so popped scopes are released, their destruction invalidates the caches
+		std::weak_ptr<Scope> scope;
+		FunctionDefinition* function;
+	};
+
+	static const size_t max_entries = 4;
+
+	const Entry* find(const std::vector<TypeDefinition*>& signature);
+	void insert(const std::vector<TypeDefinition*>& signature, std::shared_ptr<Scope> scope, FunctionDefinition& function);
+
+	// drops every cached resolution, called whenever the set of declared functions changes
+	static void invalidate();
+
+private:
+	static size_t declaration_epoch;
+
+	std::vector<Entry> entries;
+	size_t epoch = 0;
+
+};
+
 class StructureDefinition : public CodePosition {
 public:
 	std::string identifier;
@@ -259,16 +297,143 @@ public:
 	void reset_ref() override;
 };
 
+// field layout shared by every struct value built with the same fields in the same order
+// layouts are never freed, each one links to the layouts that extend it by one field
+class StructShape {
+public:
+	static constexpr size_t npos = size_t(-1);
+
+	std::vector<std::string> fields;
+
+private:
+	std::unordered_map<std::string, size_t> indexes;
+	mutable std::unordered_map<std::string, std::unique_ptr<StructShape>> transitions;
+
+public:
+	// layout without fields every struct value starts from
+	static const StructShape* empty();
+
+	size_t find(const std::string& field) const;
+	// layout with the field appended, created on first use and then reused
+	const StructShape* with_field(const std::string& field) const;
+};
+
+// remembers the slot of a field for the last layout seen at one access site
+class FieldCache {
+public:
+	const StructShape* shape = nullptr;
+	size_t slot = 0;
+};
+
+// struct fields stored as a layout plus one slot per field, in the order they were added
+class StructSlots {
+public:
+	class const_iterator {
+	private:
+		const StructSlots* owner;
+		size_t index;
+
+	public:
+		const_iterator(const StructSlots* owner, size_t index) : owner(owner), index(index) {}
+
+		std::pair<const std::string&, RuntimeValue*> operator*() const {
+			return { owner->shape->fields[index], owner->slots[index] };
+		}
+		const_iterator& operator++() { ++index; return *this; }
+		bool operator==(const const_iterator& other) const { return index == other.index; }
+		bool operator!=(const const_iterator& other) const { return index != other.index; }
+	};
+
+private:
+	const StructShape* shape = StructShape::empty();
+	std::vector<RuntimeValue*> slots;
+
+public:
+	StructSlots() = default;
+	StructSlots(std::initializer_list<std::pair<std::string, RuntimeValue*>> fields);
+
+	const StructShape* get_shape() const { return shape; }
+	size_t size() const { return slots.size(); }
+	bool empty() const { return slots.empty(); }
+	bool contains(const std::string& field) const { return shape->find(field) != StructShape::npos; }
+
+	// slot of the field, StructShape::npos when it is missing
+	size_t find(const std::string& field) const { return shape->find(field); }
+	size_t find(const std::string& field, FieldCache& cache) const;
+
+	RuntimeValue* get_slot(size_t slot) const { return slots[slot]; }
+	void set_slot(size_t slot, RuntimeValue* value) { slots[slot] = value; }
+
+	// throws when the field is missing
+	RuntimeValue* at(const std::string& field) const;
+	RuntimeValue* at(const std::string& field, FieldCache& cache) const;
+	// adds the field as null when it is missing
+	RuntimeValue*& operator[](const std::string& field);
+
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, slots.size()); }
+};
+
+// elements of a bool, int, float or char array stored unboxed in one buffer
+class PackedArray {
+public:
+	Type element_type;
+	std::vector<uint8_t> data;
+
+	PackedArray(Type element_type);
+
+	static bool can_pack(Type type);
+	static size_t element_size(Type type);
+
+	size_t size() const;
+	// sets value to a copy of the element
+	void read(size_t index, RuntimeValue* value) const;
+	// false when the value is not a packable value of the element type
+	bool write(size_t index, const RuntimeValue* value);
+	bool push_back(const RuntimeValue* value);
+	// element as a number, matching the hash of the boxed value
+	long double number(size_t index) const;
+};
+
+// collection payload shared by value copies until one of them writes to it
+template <typename T>
+class SharedPayload {
+public:
+	T data;
+	size_t owners = 1;
+
+	SharedPayload(T data) : data(std::move(data)) {}
+};
+
+// packed elements shared by value copies, which share them like the element objects of a boxed array:
+// updates in place reach every owner, and boxing the elements boxes them for all owners at once
+class SharedPackedArray {
+public:
+	PackedArray data;
+	std::vector<RuntimeValue*> owners;
+
+	SharedPackedArray(PackedArray data, RuntimeValue* owner) : data(std::move(data)), owners{ owner } {}
+};
+
 class RuntimeValue : public Value, public GCObject {
 private:
-	flx_bool* b = nullptr;
-	flx_int* i = nullptr;
-	flx_float* f = nullptr;
-	flx_char* c = nullptr;
-	flx_string* s = nullptr;
-	flx_array* arr = nullptr;
-	flx_struct* str = nullptr;
-	flx_function* fun = nullptr;
+	// kind of the payload currently held, independent of the declared type
+	Type payload_type = Type::T_UNDEFINED;
+	// arrays of scalars may hold their elements packed instead of one value per element
+	bool packed_payload = false;
+	// scalars are stored inline, collections and functions are owned through a single pointer
+	// arrays and structs are shared with the values copied from them and copied on the first write
+	union {
+		flx_int i = 0;
+		flx_bool b;
+		flx_float f;
+		flx_char c;
+		flx_string* s;
+		SharedPayload<flx_array>* arr;
+		SharedPayload<flx_struct>* str;
+		SharedPackedArray* packed;
+		flx_function* fun;
+	};
 
 public:
 	RuntimeValue* value_ref = nullptr;
@@ -283,6 +448,7 @@ public:
 	RuntimeValue(flx_string);
 	RuntimeValue(flx_array);
 	RuntimeValue(flx_array, Type array_type, std::vector<std::shared_ptr<ASTExprNode>> dim, std::string type_name = "", std::string type_name_space = "");
+	RuntimeValue(PackedArray, Type array_type, std::vector<std::shared_ptr<ASTExprNode>> dim, std::string type_name = "", std::string type_name_space = "");
 	RuntimeValue(flx_struct, std::string type_name, std::string type_name_space);
 	RuntimeValue(flx_function);
 	RuntimeValue(Type type);
@@ -300,9 +466,12 @@ public:
 	void set(flx_string);
 	void set(flx_array);
 	void set(flx_array, Type array_type, std::vector<std::shared_ptr<ASTExprNode>> dim, std::string type_name = "", std::string type_name_space = "");
+	void set(PackedArray);
+	void set(PackedArray, Type array_type, std::vector<std::shared_ptr<ASTExprNode>> dim, std::string type_name = "", std::string type_name_space = "");
 	void set(flx_struct, std::string type_name, std::string type_name_space);
 	void set(flx_function);
-	void set_sub(std::string identifier, RuntimeValue* sub_value);
+	void set_sub(const std::string& identifier, RuntimeValue* sub_value);
+	void set_sub(const std::string& identifier, RuntimeValue* sub_value, FieldCache& cache);
 	void set_sub(size_t index, RuntimeValue* sub_value);
 
 	flx_bool get_b() const;
@@ -310,10 +479,11 @@ public:
 	flx_float get_f() const;
 	flx_char get_c() const;
 	flx_string get_s() const;
-	flx_array get_arr() const;
-	flx_struct get_str() const;
+	const flx_array& get_arr() const;
+	const flx_struct& get_str() const;
 	flx_function get_fun() const;
-	RuntimeValue* get_sub(std::string identifier);
+	RuntimeValue* get_sub(const std::string& identifier);
+	RuntimeValue* get_sub(const std::string& identifier, FieldCache& cache);
 	RuntimeValue* get_sub(size_t index);
 
 	flx_bool* get_raw_b();
@@ -333,15 +503,40 @@ public:
 
 	bool has_value();
 
+	// a scalar that can be stored in a packed array
+	bool is_packable() const;
+	bool is_packed() const;
+	// null unless the array is packed
+	const PackedArray* get_packed() const;
+	// whether other values share the elements of this array
+	bool shares_elements() const;
+	size_t get_arr_size() const;
+	// element of either kind of array without boxing it, packed elements are copied into scratch
+	const RuntimeValue* get_element(size_t index, RuntimeValue& scratch) const;
+	// stores into a packed array, false when the array is not packed, shared or the value does not fit
+	bool set_packed_element(size_t index, const RuntimeValue* value);
+	// updates an element of a packed array in place, so the values sharing the array see it
+	// as they see a boxed element updated in place, the element is boxed when the value does not fit
+	void update_packed_element(size_t index, RuntimeValue* value);
+	// boxes the elements of a packed array, for callers that need them as values
+	void unpack();
+	// makes this array share the elements of value, as copies of the value do
+	void share_elements(RuntimeValue* value);
+
 	long double value_hash() const;
 
 	void copy_array(flx_array arr);
 	void copy_from(RuntimeValue* value);
 
-	virtual std::vector<GCObject*> get_references() override;
+	virtual void for_each_reference(const std::function<void(GCObject*)>& visit) override;
+	virtual size_t get_size() const override;
 
 private:
 	void unset();
+	// gives this value its own copy of a shared collection before it is written
+	void detach();
+	// makes this value share the array or struct payload of value
+	void share_payload(RuntimeValue* value);
 };
 
 class RuntimeVariable : public Variable, public GCObject, public std::enable_shared_from_this<RuntimeVariable> {
@@ -362,17 +557,18 @@ public:
 
 	void reset_ref() override;
 
-	virtual std::vector<GCObject*> get_references() override;
+	virtual void for_each_reference(const std::function<void(GCObject*)>& visit) override;
+	virtual size_t get_size() const override;
 };
 
 class RuntimeOperations {
 public:
 	static flx_bool equals_value(const RuntimeValue* lval, const RuntimeValue* rval, std::vector<uintptr_t> compared = std::vector<uintptr_t>());
 	static flx_bool equals_struct(const flx_struct& lstr, const flx_struct& rstr, std::vector<uintptr_t> compared);
-	static flx_bool equals_array(const flx_array& larr, const flx_array& rarr, std::vector<uintptr_t> compared);
+	static flx_bool equals_array(const RuntimeValue* larr, const RuntimeValue* rarr, std::vector<uintptr_t> compared);
 
 	static std::string parse_value_to_string(const RuntimeValue* value, std::vector<uintptr_t> printed = std::vector<uintptr_t>());
-	static std::string parse_array_to_string(const flx_array& arr_value, std::vector<uintptr_t> printed);
+	static std::string parse_array_to_string(const RuntimeValue* value, std::vector<uintptr_t> printed);
 	static std::string parse_struct_to_string(const RuntimeValue* value, std::vector<uintptr_t> printed);
 
 	static RuntimeValue* do_operation(const std::string& op, RuntimeValue* lval, RuntimeValue* rval, dim_eval_func_t evaluate_access_vector_ptr, bool is_expr = false, flx_int str_pos = -1);
@@ -381,7 +577,8 @@ public:
 	static flx_int do_operation(flx_int lval, flx_int rval, const std::string& op);
 	static flx_float do_operation(flx_float lval, flx_float rval, const std::string& op);
 	static flx_string do_operation(flx_string lval, flx_string rval, const std::string& op);
-	static flx_array do_operation(flx_array lval, flx_array rval, const std::string& op);
+	static flx_array do_operation(const flx_array& lval, const flx_array& rval, const std::string& op);
+	static PackedArray do_operation(const PackedArray& lval, const PackedArray& rval, const std::string& op);
 
 	static void normalize_type(TypeDefinition* owner, RuntimeValue* value);
 	
@@ -12,8 +12,10 @@
 
 using namespace vm;
 
-VirtualMachine::VirtualMachine(std::shared_ptr<Scope> global_scope, std::vector<BytecodeInstruction> instructions)
-	: instructions(instructions), gc(GarbageCollector()), set_default_value(nullptr) {
+VirtualMachine::VirtualMachine(std::shared_ptr<Scope> global_scope, const std::vector<BytecodeInstruction>& instructions, const ConstantPool& constant_pool,
+	const std::vector<ExceptionTableEntry>& exception_table)
+	: value_stack(std::make_shared<std::vector<RuntimeValue*>>()), gc(GarbageCollector()), exception_table(exception_table), call_caches(instructions.size()), field_caches(instructions.size()), set_default_value(nullptr) {
+	decode_instructions(instructions, constant_pool);
 	cleanup_type_set();
 	gc.add_root_container(value_stack);
 
@@ -23,20 +25,66 @@ VirtualMachine::VirtualMachine(std::shared_ptr<Scope> global_scope, std::vector<
 	built_in_libs["builtin"]->register_functions(this);
 }
 
-void VirtualMachine::run() {
+void VirtualMachine::decode_instructions(const std::vector<BytecodeInstruction>& instructions, const ConstantPool& constant_pool) {
+	strings = constant_pool.strings;
+	type_descriptors = constant_pool.type_descriptors;
+	code.resize(instructions.size());
+
+	for (size_t i = 0; i < instructions.size(); ++i) {
+		const auto& instruction = instructions[i];
+		auto& decoded = code[i];
+
+		decoded.opcode = instruction.opcode;
 
-	while (get_next()) {
-		if (try_deep < 0) {
+		switch (BytecodeInstruction::get_operand_type(instruction.opcode)) {
+		case OperandType::OT_UINT8:
+			decoded.u8 = uint8_t(instruction.operand);
+			break;
+		case OperandType::OT_SIZE:
+			decoded.size = instruction.operand;
+			break;
+		case OperandType::OT_BOOL:
+			decoded.b = instruction.operand != 0;
+			break;
+		case OperandType::OT_INT:
+			decoded.i = constant_pool.ints[instruction.operand];
+			break;
+		case OperandType::OT_FLOAT:
+			decoded.f = constant_pool.floats[instruction.operand];
+			break;
+		case OperandType::OT_CHAR:
+			decoded.c = flx_char(instruction.operand);
+			break;
+		case OperandType::OT_STRING:
+		case OperandType::OT_TYPE_DESCRIPTOR:
+			decoded.index = instruction.operand;
+			break;
+		default:
 			break;
 		}
+	}
+}
+
+const std::string& VirtualMachine::get_string_operand() const {
+	return strings[current_instruction->index];
+}
+
+void VirtualMachine::run() {
+	reserve_frame(compute_max_stack_depth(pc));
+
+	// exceptions are handled once for the whole loop, not per instruction
+	while (pc < code.size()) {
 		try {
-			decode_operation();
+			while (pc < code.size()) {
+				current_instruction = &code[pc++];
+				decode_operation();
+			}
 		}
-		catch (std::exception ex) {
-			if (try_deep) {
-				--try_deep;
+		catch (const std::exception& ex) {
+			// runtime errors of the operations are caught like thrown values
+			if (!unwind(ex.what())) {
+				throw std::runtime_error(ex.what());
 			}
-			throw std::runtime_error(ex.what());
 		}
 	}
 
@@ -48,6 +96,69 @@ void VirtualMachine::run() {
 
 }
 
+size_t VirtualMachine::compute_max_stack_depth(size_t entry) const {
+	// follows every path of the unit like a bytecode verifier, catch code starts with the thrown message
+	std::unordered_map<size_t, size_t> depths;
+	std::vector<std::pair<size_t, size_t>> pending = { { entry, 0 } };
+	size_t max_depth = 0;
+
+	while (!pending.empty()) {
+		auto [pos, depth] = pending.back();
+		pending.pop_back();
+
+		while (pos < code.size() && depths.emplace(pos, depth).second) {
+			const auto& instruction = code[pos];
+
+			for (const auto& handler : exception_table) {
+				if (handler.start == pos && handler.target != ExceptionTableEntry::no_handler) {
+					pending.emplace_back(handler.target, handler.stack_depth + 1);
+				}
+			}
+
+			const int effect = BytecodeInstruction::get_stack_effect(instruction.opcode);
+			if (effect >= 0) {
+				depth += size_t(effect);
+			}
+			else {
+				// underflows are reported by the instructions themselves
+				depth -= std::min(depth, size_t(-effect));
+			}
+			max_depth = std::max(max_depth, depth);
+
+			switch (instruction.opcode) {
+			case OP_RETURN:
+			case OP_HALT:
+			case OP_THROW:
+				pos = code.size();
+				break;
+			case OP_JUMP:
+				pos = instruction.size;
+				break;
+			case OP_JUMP_IF_FALSE:
+			case OP_JUMP_IF_FALSE_OR_NEXT:
+			case OP_JUMP_IF_TRUE:
+			case OP_JUMP_IF_TRUE_OR_NEXT:
+				pending.emplace_back(instruction.size, depth);
+				++pos;
+				break;
+			default:
+				++pos;
+				break;
+			}
+		}
+	}
+
+	return max_depth;
+}
+
+void VirtualMachine::reserve_frame(size_t depth) {
+	const size_t size = value_stack->size() + depth;
+	if (value_stack->capacity() < size) {
+		// keeps the geometric growth of push_back, but only once per call
+		value_stack->reserve(std::max(size, value_stack->capacity() * 2));
+	}
+}
+
 void VirtualMachine::push_empty(Type type) {
 	auto val = gc.allocate(new RuntimeValue(type));
 	value_stack->push_back(dynamic_cast<RuntimeValue*>(val));
@@ -78,6 +189,35 @@ void VirtualMachine::binary_operation(const std::string& op) {
 	}
 }
 
+template <typename T, typename Operation>
+void VirtualMachine::typed_binary_operation(const char* op, Operation operation) {
+	RuntimeValue* rval = value_stack->back();
+	RuntimeValue* lval = value_stack->at(value_stack->size() - 2);
+
+	T l;
+	T r;
+	if constexpr (std::is_same_v<T, flx_int>) {
+		if (!is_int(lval->type) || !is_int(rval->type)) {
+			// typed variables can still hold null, leave them to the generic operation
+			binary_operation(op);
+			return;
+		}
+		l = lval->get_i();
+		r = rval->get_i();
+	}
+	else {
+		if (!is_float(lval->type) || !is_float(rval->type)) {
+			binary_operation(op);
+			return;
+		}
+		l = lval->get_f();
+		r = rval->get_f();
+	}
+
+	value_stack->resize(value_stack->size() - 2);
+	push_constant(new RuntimeValue(operation(l, r)));
+}
+
 void VirtualMachine::unary_operation(const std::string& op) {
 	RuntimeValue* value = value_stack->back();
 
@@ -119,11 +259,9 @@ void VirtualMachine::unary_operation(const std::string& op) {
 	}
 }
 
-void VirtualMachine::handle_call() {
-	return_stack.push(pc + 1);
-
+void VirtualMachine::handle_call(bool tail_call) {
 	std::string name_space = get_namespace();
-	std::string identifier = current_instruction.get_string_operand();
+	std::string identifier = get_string_operand();
 	bool strict = true;
 	std::vector<TypeDefinition*> signature;
 	std::vector<RuntimeValue*> function_arguments;
@@ -147,69 +285,128 @@ void VirtualMachine::handle_call() {
 		signature.insert(signature.begin(), pvalue);
 	}
 
-	std::shared_ptr<Scope> func_scope;
-	try {
+	// pc already points past the call instruction
+	auto& call_cache = call_caches[pc - 1];
+	if (const auto cached = call_cache.find(signature)) {
+		if (cached->scope.lock()) {
+			call_function(*cached->function, identifier, tail_call);
+			return;
+		}
+	}
+
+	std::shared_ptr<Scope> func_scope = get_inner_most_function_scope(nullptr, name_space, identifier, &signature, evaluate_access_vector_ptr, strict);
+	if (!func_scope) {
+		strict = false;
 		func_scope = get_inner_most_function_scope(nullptr, name_space, identifier, &signature, evaluate_access_vector_ptr, strict);
 	}
-	catch (...) {
-		try {
-			strict = false;
+	if (!func_scope) {
+		auto var_scope = get_inner_most_variable_scope(nullptr, name_space, identifier);
+		if (var_scope) {
+			auto var = std::dynamic_pointer_cast<RuntimeVariable>(var_scope->find_declared_variable(identifier));
+			name_space = var->value->get_fun().first;
+			identifier = var->value->get_fun().second;
 			func_scope = get_inner_most_function_scope(nullptr, name_space, identifier, &signature, evaluate_access_vector_ptr, strict);
 		}
-		catch (...) {
-			try {
-				auto var_scope = get_inner_most_variable_scope(nullptr, name_space, identifier);
-				auto var = std::dynamic_pointer_cast<RuntimeVariable>(var_scope->find_declared_variable(identifier));
-				name_space = var->value->get_fun().first;
-				identifier = var->value->get_fun().second;
-				auto identifier_vector = std::vector<Identifier>{ Identifier(identifier) };
-				func_scope = get_inner_most_function_scope(nullptr, name_space, identifier, &signature, evaluate_access_vector_ptr, strict);
-			}
-			catch (...) {
-				std::string func_name = ExceptionHandler::buid_signature(identifier, signature, evaluate_access_vector_ptr);
-				throw std::runtime_error("function '" + func_name + "' was never declared");
-			}
-		}
+	}
+	if (!func_scope) {
+		std::string func_name = ExceptionHandler::buid_signature(identifier, signature, evaluate_access_vector_ptr);
+		throw std::runtime_error("function '" + func_name + "' was never declared");
 	}
 
 	auto& declfun = func_scope->find_declared_function(identifier, &signature, evaluate_access_vector_ptr, strict);
 
-	if (declfun.pointer) {
+	// only declared functions are cached, function values may change between calls
+	if (identifier == get_string_operand()) {
+		call_cache.insert(signature, func_scope, declfun);
+	}
+
+	call_function(declfun, identifier, tail_call);
+
+	//gc.remove_root_container(&function_arguments);
+}
+
+void VirtualMachine::call_function(const FunctionDefinition& declfun, const std::string& identifier, bool tail_call) {
+	if (declfun.pointer && tail_call && !return_stack.empty()) {
+		// the frame of the returning function is reused, its arguments and values are replaced by the new arguments
+		auto& frame = return_stack.top();
+		const size_t arguments_base = frame.stack_base - frame.arguments;
+		std::move(value_stack->end() - param_count, value_stack->end(), value_stack->begin() + arguments_base);
+		value_stack->resize(arguments_base + param_count);
+		frame.stack_base = value_stack->size();
+		frame.arguments = param_count;
+		reserve_frame(declfun.max_stack_depth);
+		pc = declfun.pointer;
+	}
+	else if (declfun.pointer) {
+		return_stack.push(ReturnFrame{ pc + 1, value_stack->size(), param_count });
+		reserve_frame(declfun.max_stack_depth);
 		pc = declfun.pointer;
 	}
 	else {
-		return_stack.pop();
 		builtin_functions[identifier]();
 	}
-
-	//gc.remove_root_container(&function_arguments);
 }
 
 void VirtualMachine::handle_throw() {
 	auto value = get_stack_top();
+	std::string error;
 
 	if (is_struct(value->type)
 		&& value->type_name == "Exception") {
-		try {
-			get_inner_most_struct_definition_scope(nullptr, language_namespace, "Exception");
-		}
-		catch (...) {
+		if (!get_inner_most_struct_definition_scope(nullptr, language_namespace, "Exception")) {
 			throw std::runtime_error("struct 'flx::Exception' not found");
 		}
 
-		throw std::exception(value->get_str()["error"]->get_s().c_str());
+		error = value->get_str().at("error")->get_s();
 	}
 	else if (is_string(value->type)) {
-		throw std::runtime_error(value->get_s());
+		error = value->get_s();
 	}
 	else {
 		throw std::runtime_error("expected flx::Exception struct or string in throw");
 	}
 
+	// only uncaught throws leave the loop as c++ exceptions
+	if (!unwind(error)) {
+		throw std::runtime_error(error);
+	}
+}
+
+bool VirtualMachine::unwind(const std::string& error) {
+	// the failing instruction, then the call instruction of each frame below it
+	size_t pos = pc - 1;
+
+	while (true) {
+		const size_t stack_base = return_stack.empty() ? 0 : return_stack.top().stack_base;
+
+		for (const auto& entry : exception_table) {
+			if (pos < entry.start || pos >= entry.end) {
+				continue;
+			}
+			if (entry.target == ExceptionTableEntry::no_handler) {
+				break;
+			}
+
+			if (value_stack->size() > stack_base + entry.stack_depth) {
+				value_stack->resize(stack_base + entry.stack_depth);
+			}
+			push_constant(new RuntimeValue(flx_string(error)));
+			pc = entry.target;
+			return true;
+		}
+
+		if (return_stack.empty()) {
+			return false;
+		}
+
+		// calls return past the instruction that follows them
+		pos = return_stack.top().return_pc - 2;
+		return_stack.pop();
+	}
 }
 
 void VirtualMachine::handle_type_parse() {
-	Type type = Type(current_instruction.get_uint8_operand());
+	Type type = Type(current_instruction->u8);
 	auto value = get_stack_top();
 	RuntimeValue* new_value = new RuntimeValue();
 
@@ -319,11 +516,9 @@ void VirtualMachine::handle_type_parse() {
 	push_constant(new_value);
 }
 
-void VirtualMachine::handle_store_var() {
+void VirtualMachine::handle_store_var(const std::string& identifier) {
 	const auto& name_space = get_namespace();
 
-	auto identifier = current_instruction.get_string_operand();
-
 	RuntimeValue* new_value = get_stack_top();
 	if (!new_value->use_ref) {
 		new_value = alocate_value(new RuntimeValue(new_value));
@@ -348,16 +543,19 @@ void VirtualMachine::handle_store_var() {
 	cleanup_type_set();
 }
 
+void VirtualMachine::handle_store_typed_var() {
+	const auto& descriptor = type_descriptors[current_instruction->index];
+	set_type_descriptor(descriptor);
+	handle_store_var(strings[descriptor.identifier]);
+}
+
 void VirtualMachine::handle_load_var() {
 	auto name_space = get_namespace();
 
-	auto identifier = current_instruction.get_string_operand();
+	const auto& identifier = get_string_operand();
 
-	std::shared_ptr<Scope> id_scope;
-	try {
-		id_scope = get_inner_most_variable_scope(nullptr, name_space, identifier);
-	}
-	catch (...) {
+	std::shared_ptr<Scope> id_scope = get_inner_most_variable_scope(nullptr, name_space, identifier);
+	if (!id_scope) {
 		//const auto& dim = astnode->identifier_vector[0].access_vector;
 		//auto type = Type::T_UNDEFINED;
 		//auto expression_value = alocate_value(new RuntimeValue(Type::T_UNDEFINED));
@@ -417,18 +615,43 @@ void VirtualMachine::handle_load_var() {
 		//}
 
 		//return;
+
+		throw std::runtime_error("identifier '" + identifier + "' was not declared");
 	}
 
 	auto variable = std::dynamic_pointer_cast<RuntimeVariable>(id_scope->find_declared_variable(identifier));
 	value_stack->push_back(variable->get_value());
 }
 
+void VirtualMachine::handle_inc_var(flx_int step) {
+	const auto& identifier = get_string_operand();
+
+	std::shared_ptr<Scope> id_scope = get_inner_most_variable_scope(nullptr, get_namespace(), identifier);
+	if (!id_scope) {
+		throw std::runtime_error("identifier '" + identifier + "' was not declared");
+	}
+
+	auto value = std::dynamic_pointer_cast<RuntimeVariable>(id_scope->find_declared_variable(identifier))->get_value();
+
+	if (is_int(value->type)) {
+		value->set(flx_int(value->get_i() + step));
+		return;
+	}
+
+	// other types keep the semantics of the unfused arithmetic
+	auto one = alocate_value(new RuntimeValue(flx_int(1)));
+	auto res = RuntimeOperations::do_operation(step > 0 ? "+" : "-", value, one, evaluate_access_vector_ptr, true);
+	if (res != value) {
+		value->copy_from(res);
+	}
+}
+
 void VirtualMachine::handle_include_namespace() {
-	program_nmspaces[get_namespace()].push_back(current_instruction.get_string_operand());
+	program_nmspaces[get_namespace()].push_back(get_string_operand());
 }
 
 void VirtualMachine::handle_exclude_namespace() {
-	const auto& op_nmspace = current_instruction.get_string_operand();
+	const auto& op_nmspace = get_string_operand();
 	const auto& name_space = get_namespace();
 	size_t pos = std::distance(program_nmspaces[name_space].begin(),
 		std::find(program_nmspaces[name_space].begin(),
@@ -437,13 +660,13 @@ void VirtualMachine::handle_exclude_namespace() {
 }
 
 void VirtualMachine::handle_init_array() {
-	auto size = current_instruction.get_size_operand();
+	auto size = current_instruction->size;
 	value_build_stack.push(new RuntimeValue(flx_array(size)));
 }
 
 void VirtualMachine::handle_set_element() {
 	RuntimeValue* value = get_stack_top();
-	value_build_stack.top()->set_sub(current_instruction.get_size_operand(), value);
+	value_build_stack.top()->set_sub(current_instruction->size, value);
 }
 
 void VirtualMachine::handle_push_array() {
@@ -453,13 +676,13 @@ void VirtualMachine::handle_push_array() {
 
 void VirtualMachine::handle_init_struct() {
 	auto type_name_space = get_namespace();
-	auto identifier = current_instruction.get_string_operand();
+	const auto& identifier = get_string_operand();
 	value_build_stack.push(new RuntimeValue(flx_struct(), identifier, type_name_space));
 }
 
 void VirtualMachine::handle_set_field() {
 	RuntimeValue* value = get_stack_top();
-	value_build_stack.top()->set_sub(current_instruction.get_string_operand(), value);
+	value_build_stack.top()->set_sub(get_string_operand(), value);
 }
 
 void VirtualMachine::handle_push_struct() {
@@ -468,11 +691,11 @@ void VirtualMachine::handle_push_struct() {
 }
 
 void VirtualMachine::handle_struct_start() {
-	struct_def_build_stack.push(StructureDefinition(current_instruction.get_string_operand()));
+	struct_def_build_stack.push(StructureDefinition(get_string_operand()));
 }
 
 void VirtualMachine::handle_struct_set_var() {
-	auto var_id = current_instruction.get_string_operand();
+	const auto& var_id = get_string_operand();
 
 	auto var = VariableDefinition(var_id,
 		set_type, set_type_name, set_type_name_space, set_array_type,
@@ -490,12 +713,12 @@ void VirtualMachine::handle_struct_end() {
 }
 
 void VirtualMachine::handle_load_sub_id() {
-	auto id = current_instruction.get_string_operand();
+	const auto& id = get_string_operand();
 	auto val = get_stack_top();
 	if (!is_struct(val->type)) {
 		throw std::runtime_error("Invalid " + type_str(val->type) + " access, this operation can only be performed on struct values");
 	}
-	value_stack->push_back(val->get_sub(id));
+	value_stack->push_back(val->get_sub(id, field_caches[current_instruction - code.data()]));
 }
 
 void VirtualMachine::handle_load_sub_ix() {
@@ -524,10 +747,10 @@ void VirtualMachine::handle_assign_var() {
 }
 
 void VirtualMachine::handle_assign_sub_id() {
-	auto id = current_instruction.get_string_operand();
+	const auto& id = get_string_operand();
 	auto val = get_stack_top();
 	auto new_val = get_stack_top();
-	val->set_sub(id, new_val);
+	val->set_sub(id, new_val, field_caches[current_instruction - code.data()]);
 }
 
 void VirtualMachine::handle_assign_sub_ix() {
@@ -538,13 +761,13 @@ void VirtualMachine::handle_assign_sub_ix() {
 }
 
 void VirtualMachine::handle_fun_start() {
-	func_def_build_stack.push(FunctionDefinition(current_instruction.get_string_operand(), set_type, set_type_name,
+	func_def_build_stack.push(FunctionDefinition(get_string_operand(), set_type, set_type_name,
 		set_type_name_space, set_array_type, set_array_dim));
 	cleanup_type_set();
 }
 
 void VirtualMachine::handle_fun_set_param() {
-	auto var_id = current_instruction.get_string_operand();
+	const auto& var_id = get_string_operand();
 
 	auto var = new VariableDefinition(var_id,
 		set_type, set_type_name, set_type_name_space, set_array_type,
@@ -556,14 +779,15 @@ void VirtualMachine::handle_fun_set_param() {
 }
 
 void VirtualMachine::handle_fun_end() {
-	auto& fun = func_def_build_stack.top();
+	auto fun = std::move(func_def_build_stack.top());
 	func_def_build_stack.pop();
 	fun.pointer = pc + 2;
+	fun.max_stack_depth = compute_max_stack_depth(fun.pointer);
 	scopes[get_namespace()].back()->declare_function(fun.identifier, fun);
 }
 
 void VirtualMachine::handle_is_type() {
-	Type type = static_cast<Type>(current_instruction.get_uint8_operand());
+	Type type = static_cast<Type>(current_instruction->u8);
 	auto value = get_stack_top();
 	RuntimeValue* res_value = new RuntimeValue(Type::T_BOOL);
 	if (is_any(type)) {
@@ -583,7 +807,7 @@ void VirtualMachine::handle_is_type() {
 }
 
 void VirtualMachine::decode_operation() {
-	switch (current_instruction.opcode) {
+	switch (current_instruction->opcode) {
 	case OP_RES:
 		throw std::runtime_error("Reserved operation");
 		break;
@@ -593,7 +817,7 @@ void VirtualMachine::decode_operation() {
 		current_namespace.pop();
 		break;
 	case OP_PUSH_NAMESPACE:
-		current_namespace.push(current_instruction.get_string_operand());
+		current_namespace.push(get_string_operand());
 		break;
 	case OP_PUSH_NAMESPACE_STACK:
 		push_constant(new RuntimeValue(current_namespace.top()));
@@ -617,22 +841,22 @@ void VirtualMachine::decode_operation() {
 		push_empty(Type::T_VOID);
 		break;
 	case OP_PUSH_BOOL:
-		push_constant(new RuntimeValue(current_instruction.get_bool_operand()));
+		push_constant(new RuntimeValue(current_instruction->b));
 		break;
 	case OP_PUSH_INT:
-		push_constant(new RuntimeValue(current_instruction.get_int_operand()));
+		push_constant(new RuntimeValue(current_instruction->i));
 		break;
 	case OP_PUSH_FLOAT:
-		push_constant(new RuntimeValue(current_instruction.get_float_operand()));
+		push_constant(new RuntimeValue(current_instruction->f));
 		break;
 	case OP_PUSH_CHAR:
-		push_constant(new RuntimeValue(current_instruction.get_char_operand()));
+		push_constant(new RuntimeValue(current_instruction->c));
 		break;
 	case OP_PUSH_STRING:
-		push_constant(new RuntimeValue(current_instruction.get_string_operand()));
+		push_constant(new RuntimeValue(get_string_operand()));
 		break;
 	case OP_PUSH_FUNCTION:
-		push_function_constant(current_instruction.get_string_operand());
+		push_function_constant(get_string_operand());
 		break;
 	case OP_INIT_ARRAY:
 		handle_init_array();
@@ -666,16 +890,16 @@ void VirtualMachine::decode_operation() {
 
 		// typing operations
 	case OP_SET_TYPE:
-		set_type = (Type)current_instruction.get_uint8_operand();
+		set_type = (Type)current_instruction->u8;
 		break;
 	case OP_SET_ARRAY_TYPE:
-		set_array_type = (Type)current_instruction.get_uint8_operand();
+		set_array_type = (Type)current_instruction->u8;
 		break;
 	case OP_SET_TYPE_NAME:
-		set_type_name = current_instruction.get_string_operand();
+		set_type_name = get_string_operand();
 		break;
 	case OP_SET_TYPE_NAME_SPACE:
-		set_type_name_space = current_instruction.get_string_operand();
+		set_type_name_space = get_string_operand();
 		break;
 	case OP_SET_ARRAY_SIZE:
 		// todo: generating bug
@@ -685,7 +909,10 @@ void VirtualMachine::decode_operation() {
 		set_default_value = std::make_shared<ASTValueNode>(get_stack_top(), 0, 0);
 		break;
 	case OP_SET_IS_REST:
-		set_is_rest = current_instruction.get_bool_operand();
+		set_is_rest = current_instruction->b;
+		break;
+	case OP_SET_TYPE_DESCRIPTOR:
+		set_type_descriptor(type_descriptors[current_instruction->index]);
 		break;
 
 		// variable operations
@@ -693,7 +920,7 @@ void VirtualMachine::decode_operation() {
 		handle_load_var();
 		break;
 	case OP_STORE_VAR:
-		handle_store_var();
+		handle_store_var(get_string_operand());
 		break;
 	case OP_LOAD_SUB_ID:
 		handle_load_sub_id();
@@ -711,6 +938,17 @@ void VirtualMachine::decode_operation() {
 		handle_assign_sub_ix();
 		break;
 
+		// fused variable operations
+	case OP_STORE_TYPED_VAR:
+		handle_store_typed_var();
+		break;
+	case OP_INC_VAR:
+		handle_inc_var(1);
+		break;
+	case OP_DEC_VAR:
+		handle_inc_var(-1);
+		break;
+
 		// function operations
 	case OP_FUN_START:
 		handle_fun_start();
@@ -720,16 +958,19 @@ void VirtualMachine::decode_operation() {
 		handle_fun_set_param();
 		break;
 	case OP_CALL_PARAM_COUNT:
-		param_count = current_instruction.get_size_operand();
+		param_count = current_instruction->size;
 		break;
 	case OP_FUN_END:
 		handle_fun_end();
 		break;
 	case OP_CALL:
-		handle_call();
+		handle_call(false);
+		break;
+	case OP_TAIL_CALL:
+		handle_call(true);
 		break;
 	case OP_RETURN:
-		pc = return_stack.top();
+		pc = return_stack.top().return_pc;
 		return_stack.pop();
 		break;
 
@@ -740,12 +981,6 @@ void VirtualMachine::decode_operation() {
 	case OP_BREAK:
 		// todo OP_BREAK
 		break;
-	case OP_TRY_START:
-		try_deep++;
-		break;
-	case OP_TRY_END:
-		try_deep--;
-		break;
 	case OP_THROW:
 		handle_throw();
 		break;
@@ -756,7 +991,7 @@ void VirtualMachine::decode_operation() {
 		// todo OP_NEXT_ELEMENT
 		break;
 	case OP_JUMP:
-		// todo OP_JUMP
+		pc = current_instruction->size;
 		break;
 	case OP_JUMP_IF_FALSE:
 		// todo OP_JUMP_IF_FALSE
@@ -874,6 +1109,62 @@ void VirtualMachine::decode_operation() {
 	case OP_EXP:
 		binary_operation("**");
 		break;
+
+		// type specialized expression operations
+	case OP_EQL_INT:
+		typed_binary_operation<flx_int>("==", std::equal_to<flx_int>());
+		break;
+	case OP_DIF_INT:
+		typed_binary_operation<flx_int>("!=", std::not_equal_to<flx_int>());
+		break;
+	case OP_LT_INT:
+		typed_binary_operation<flx_int>("<", std::less<flx_int>());
+		break;
+	case OP_LTE_INT:
+		typed_binary_operation<flx_int>("<=", std::less_equal<flx_int>());
+		break;
+	case OP_GT_INT:
+		typed_binary_operation<flx_int>(">", std::greater<flx_int>());
+		break;
+	case OP_GTE_INT:
+		typed_binary_operation<flx_int>(">=", std::greater_equal<flx_int>());
+		break;
+	case OP_ADD_INT:
+		typed_binary_operation<flx_int>("+", std::plus<flx_int>());
+		break;
+	case OP_SUB_INT:
+		typed_binary_operation<flx_int>("-", std::minus<flx_int>());
+		break;
+	case OP_MUL_INT:
+		typed_binary_operation<flx_int>("*", std::multiplies<flx_int>());
+		break;
+	case OP_EQL_FLOAT:
+		typed_binary_operation<flx_float>("==", std::equal_to<flx_float>());
+		break;
+	case OP_DIF_FLOAT:
+		typed_binary_operation<flx_float>("!=", std::not_equal_to<flx_float>());
+		break;
+	case OP_LT_FLOAT:
+		typed_binary_operation<flx_float>("<", std::less<flx_float>());
+		break;
+	case OP_LTE_FLOAT:
+		typed_binary_operation<flx_float>("<=", std::less_equal<flx_float>());
+		break;
+	case OP_GT_FLOAT:
+		typed_binary_operation<flx_float>(">", std::greater<flx_float>());
+		break;
+	case OP_GTE_FLOAT:
+		typed_binary_operation<flx_float>(">=", std::greater_equal<flx_float>());
+		break;
+	case OP_ADD_FLOAT:
+		typed_binary_operation<flx_float>("+", std::plus<flx_float>());
+		break;
+	case OP_SUB_FLOAT:
+		typed_binary_operation<flx_float>("-", std::minus<flx_float>());
+		break;
+	case OP_MUL_FLOAT:
+		typed_binary_operation<flx_float>("*", std::multiplies<flx_float>());
+		break;
 	case OP_REF:
 		unary_operation("ref");
 		break;
@@ -883,7 +1174,7 @@ void VirtualMachine::decode_operation() {
 	case OP_TRAP:
 		break;
 	case OP_HALT:
-		pc = instructions.size();
+		pc = code.size();
 		break;
 	case OP_ERROR:
 		std::cerr << "Operation error" << std::endl;
@@ -901,14 +1192,6 @@ RuntimeValue* VirtualMachine::get_stack_top() {
 	return value;
 }
 
-bool VirtualMachine::get_next() {
-	if (pc >= instructions.size()) {
-		return false;
-	}
-	current_instruction = instructions[pc++];
-	return true;
-}
-
 void VirtualMachine::cleanup_type_set() {
 	set_type = Type::T_UNDEFINED;
 	set_type_name = "";
@@ -919,6 +1202,13 @@ void VirtualMachine::cleanup_type_set() {
 	set_is_rest = false;
 }
 
+void VirtualMachine::set_type_descriptor(const TypeDescriptor& descriptor) {
+	set_type = descriptor.type;
+	set_array_type = descriptor.array_type;
+	set_type_name = strings[descriptor.type_name];
+	set_type_name_space = strings[descriptor.type_name_space];
+}
+
 std::vector<unsigned int> VirtualMachine::evaluate_access_vector(const std::vector<std::shared_ptr<ASTExprNode>>& expr_access_vector) {
 	auto access_vector = std::vector<unsigned int>();
 	for (const auto& expr : expr_access_vector) {
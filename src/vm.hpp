@@ -2,6 +2,7 @@
 #define VIRTUAL_MACHINE_HPP
 
 #include <memory>
+#include <vector>
 #include <map>
 #include <unordered_map>
 #include <stack>
@@ -22,24 +23,42 @@ namespace vm {
 	using namespace visitor;
 	using namespace parser;
 
+	// return address of a call and the size of the value stack when it was made, throws unwind through it
+	class ReturnFrame {
+	public:
+		size_t return_pc;
+		size_t stack_base;
+		// arguments below the stack base, a tail call replaces them with its own
+		size_t arguments;
+	};
+
 	class VirtualMachine : public MetaVisitor {
 	public:
 		std::shared_ptr<std::vector<RuntimeValue*>> value_stack;
 		size_t param_count = 0;
 		std::map<std::string, std::function<void()>> builtin_functions;
+		GarbageCollector gc;
 
 		void push_constant(RuntimeValue* value);
 		RuntimeValue* get_stack_top();
 
 	private:
 		size_t pc = 0;
-		std::vector<BytecodeInstruction> instructions;
-		BytecodeInstruction current_instruction;
-		GarbageCollector gc;
-		std::stack<StructureDefinition> struct_def_build_stack;
-		std::stack<FunctionDefinition> func_def_build_stack;
-		std::stack<RuntimeValue*> value_build_stack;
-		std::stack<size_t> return_stack;
+		// pre-decoded instruction stream and the constant pool strings and type descriptors
+		std::vector<DecodedInstruction> code;
+		std::vector<std::string> strings;
+		std::vector<TypeDescriptor> type_descriptors;
+		std::vector<ExceptionTableEntry> exception_table;
+		// inline caches of call instructions, indexed by instruction position
+		std::vector<CallSiteCache> call_caches;
+		// struct field slots of the sub id instructions, indexed by instruction position
+		std::vector<FieldCache> field_caches;
+		const DecodedInstruction* current_instruction = nullptr;
+		// vector backed so the stacks stay contiguous
+		std::stack<StructureDefinition, std::vector<StructureDefinition>> struct_def_build_stack;
+		std::stack<FunctionDefinition, std::vector<FunctionDefinition>> func_def_build_stack;
+		std::stack<RuntimeValue*, std::vector<RuntimeValue*>> value_build_stack;
+		std::stack<ReturnFrame, std::vector<ReturnFrame>> return_stack;
 
 		Type set_type;
 		std::string set_type_name;
@@ -54,19 +73,26 @@ namespace vm {
 		size_t print_level = 0;
 		std::vector<uintptr_t> printed;
 
-		long long try_deep = 0;
-
 	private:
+		void decode_instructions(const std::vector<BytecodeInstruction>& instructions, const ConstantPool& constant_pool);
 		void decode_operation();
-		bool get_next();
+		const std::string& get_string_operand() const;
+
+		// largest operand stack depth reachable from the entry of a code unit, computed once per unit
+		size_t compute_max_stack_depth(size_t entry) const;
+		// makes room for the operands of a new frame so pushes inside it never reallocate
+		void reserve_frame(size_t depth);
 
 		void cleanup_type_set();
+		void set_type_descriptor(const TypeDescriptor& descriptor);
 
 		RuntimeValue* alocate_value(RuntimeValue* value);
 
 		void push_empty(Type type);
 		void push_function_constant(const std::string& identifier);
 		void binary_operation(const std::string& op);
+		template <typename T, typename Operation>
+		void typed_binary_operation(const char* op, Operation operation);
 		void unary_operation(const std::string& op);
 
 		void handle_include_namespace();
@@ -89,16 +115,22 @@ namespace vm {
 		void handle_fun_set_param();
 		void handle_fun_end();
 		void handle_is_type();
-		void handle_call();
+		void handle_call(bool tail_call);
+		void call_function(const FunctionDefinition& declfun, const std::string& identifier, bool tail_call);
 		void handle_throw();
+		// continues at the handler of the innermost try block around the failing instruction, false when there is none
+		bool unwind(const std::string& error);
 		void handle_type_parse();
-		void handle_store_var();
+		void handle_store_var(const std::string& identifier);
+		void handle_store_typed_var();
 		void handle_load_var();
+		void handle_inc_var(flx_int step);
 
 		std::vector<unsigned int> evaluate_access_vector(const std::vector<std::shared_ptr<ASTExprNode>>& expr_access_vector);
 
 	public:
-		VirtualMachine(std::shared_ptr<Scope> global_scope, std::vector<BytecodeInstruction> instructions);
+		VirtualMachine(std::shared_ptr<Scope> global_scope, const std::vector<BytecodeInstruction>& instructions, const ConstantPool& constant_pool,
+			const std::vector<ExceptionTableEntry>& exception_table);
 		VirtualMachine() = default;
 		~VirtualMachine() = default;
 
@@ -43,6 +43,7 @@ namespace vm {
 		OP_SET_ARRAY_SIZE,
 		OP_SET_DEFAULT_VALUE,
 		OP_SET_IS_REST,
+		OP_SET_TYPE_DESCRIPTOR,
 		// variable ops
 		OP_LOAD_VAR,
 		OP_STORE_VAR,
@@ -51,20 +52,23 @@ namespace vm {
 		OP_LOAD_SUB_IX,
 		OP_ASSIGN_SUB_ID,
 		OP_ASSIGN_SUB_IX,
+		// fused variable ops
+		OP_STORE_TYPED_VAR,
+		OP_INC_VAR,
+		OP_DEC_VAR,
 		// function ops
 		OP_FUN_START,
 		OP_FUN_SET_PARAM,
 		OP_CALL_PARAM_COUNT,
 		OP_FUN_END,
 		OP_CALL,
+		OP_TAIL_CALL,
 		OP_RETURN,
 		// coditional
 		OP_STORE_COMP,
 		OP_RELEASE_COMP,
 		OP_CONTINUE,
 		OP_BREAK,
-		OP_TRY_START,
-		OP_TRY_END,
 		OP_THROW,
 		OP_GET_ITERATOR,
 		OP_NEXT_ELEMENT,
@@ -104,6 +108,25 @@ namespace vm {
 		OP_NOT,
 		OP_BIT_NOT,
 		OP_EXP,
+		// type specialized expression ops
+		OP_EQL_INT,
+		OP_DIF_INT,
+		OP_LT_INT,
+		OP_LTE_INT,
+		OP_GT_INT,
+		OP_GTE_INT,
+		OP_ADD_INT,
+		OP_SUB_INT,
+		OP_MUL_INT,
+		OP_EQL_FLOAT,
+		OP_DIF_FLOAT,
+		OP_LT_FLOAT,
+		OP_LTE_FLOAT,
+		OP_GT_FLOAT,
+		OP_GTE_FLOAT,
+		OP_ADD_FLOAT,
+		OP_SUB_FLOAT,
+		OP_MUL_FLOAT,
 		OP_REF,
 		OP_UNREF,
 		OP_TRAP,
@@ -148,6 +171,7 @@ namespace vm {
 		{OP_SET_ARRAY_SIZE, "SET_ARRAY_SIZE"},
 		{OP_SET_DEFAULT_VALUE, "SET_DEFAULT_VALUE"},
 		{OP_SET_IS_REST, "SET_IS_REST"},
+		{OP_SET_TYPE_DESCRIPTOR, "SET_TYPE_DESCRIPTOR"},
 		// variable ops
 		{OP_LOAD_VAR, "LOAD_VAR"},
 		{OP_STORE_VAR, "STORE_VAR"},
@@ -156,20 +180,23 @@ namespace vm {
 		{OP_LOAD_SUB_IX, "LOAD_SUB_IX"},
 		{OP_ASSIGN_SUB_ID, "ASSIGN_SUB_ID"},
 		{OP_ASSIGN_SUB_IX, "ASSIGN_SUB_IX"},
+		// fused variable ops
+		{OP_STORE_TYPED_VAR, "STORE_TYPED_VAR"},
+		{OP_INC_VAR, "INC_VAR"},
+		{OP_DEC_VAR, "DEC_VAR"},
 		// function ops
 		{OP_FUN_START, "FUN_START"},
 		{OP_FUN_SET_PARAM, "FUN_PARAM_END"},
 		{OP_CALL_PARAM_COUNT, "CALL_PARAM_COUNT"},
 		{OP_FUN_END, "FUN_END"},
 		{OP_CALL, "CALL"},
+		{OP_TAIL_CALL, "TAIL_CALL"},
 		{OP_RETURN, "RETURN"},
 		// coditional
 		{OP_STORE_COMP, "STORE_COMP"},
 		{OP_RELEASE_COMP, "RELEASE_COMP"},
 		{OP_CONTINUE, "CONTINUE"},
 		{OP_BREAK, "BREAK"},
-		{OP_TRY_START, "TRY_START"},
-		{OP_TRY_END, "TRY_END"},
 		{OP_THROW, "THROW"},
 		{OP_GET_ITERATOR, "GET_ITERATOR"},
 		{OP_NEXT_ELEMENT, "NEXT_ELEMENT"},
@@ -209,6 +236,25 @@ namespace vm {
 		{OP_NOT, "NOT"},
 		{OP_BIT_NOT, "BIT_NOT"},
 		{OP_EXP, "EXP"},
+		// type specialized expression ops
+		{OP_EQL_INT, "EQL_INT"},
+		{OP_DIF_INT, "DIF_INT"},
+		{OP_LT_INT, "LT_INT"},
+		{OP_LTE_INT, "LTE_INT"},
+		{OP_GT_INT, "GT_INT"},
+		{OP_GTE_INT, "GTE_INT"},
+		{OP_ADD_INT, "ADD_INT"},
+		{OP_SUB_INT, "SUB_INT"},
+		{OP_MUL_INT, "MUL_INT"},
+		{OP_EQL_FLOAT, "EQL_FLOAT"},
+		{OP_DIF_FLOAT, "DIF_FLOAT"},
+		{OP_LT_FLOAT, "LT_FLOAT"},
+		{OP_LTE_FLOAT, "LTE_FLOAT"},
+		{OP_GT_FLOAT, "GT_FLOAT"},
+		{OP_GTE_FLOAT, "GTE_FLOAT"},
+		{OP_ADD_FLOAT, "ADD_FLOAT"},
+		{OP_SUB_FLOAT, "SUB_FLOAT"},
+		{OP_MUL_FLOAT, "MUL_FLOAT"},
 		{OP_REF, "REF"},
 		{OP_UNREF, "UNREF"},
 		{OP_TRAP, "TRAP"},